@@ -10,6 +10,14 @@
 static void mainTdcISR(void);
 
 uint8_t TeensyPOV::pixelsPerWord;
+uint8_t TeensyPOV::numPaletteBands = 1;
+uint8_t TeensyPOV::paletteBandStart[maxPaletteBands];
+uint8_t TeensyPOV::ledPaletteBase[maxNumLeds];
+volatile uint8_t TeensyPOV::numRotationBands = 1;
+uint8_t TeensyPOV::rotationBandStart[maxRotationBands];
+volatile int32_t TeensyPOV::bandVelocity[maxRotationBands];
+volatile uint32_t TeensyPOV::bandPosition[maxRotationBands];
+volatile uint16_t TeensyPOV::bandOffset[maxRotationBands];
 uint32_t TeensyPOV::numLeds;
 CRGB * TeensyPOV::leds;
 
@@ -18,23 +26,64 @@ KINETISK_PIT_CHANNEL_t * TeensyPOV::segmentTimer;
 #ifdef SIMULATE_RPM
 KINETISK_PIT_CHANNEL_t * TeensyPOV::tdcSimulator;
 #endif  // SIMULATE_RPM
+#if defined(HALL_INPUT_CAPTURE) && !defined(SIMULATE_RPM)
+static volatile uint32_t *captureChannel;
+static volatile uint32_t captureLatency;
+#endif  // HALL_INPUT_CAPTURE
 
 void (*TeensyPOV::funct_table[4])() = {TeensyPOV::dummy_funct, TeensyPOV::dummy_funct, TeensyPOV::dummy_funct, TeensyPOV::dummy_funct};
 void (*TeensyPOV::tdcInteruptVector)() = TeensyPOV::dummy_funct;
 
 volatile uint8_t TeensyPOV::currentLogNumSegments = 1;
-volatile uint32_t TeensyPOV::segmentArray[maxNumSegments][maxColumns];
-volatile uint32_t TeensyPOV::colorArray[1 << maxNumColorBits];
+volatile uint32_t TeensyPOV::segmentArray[numSegmentBuffers][maxNumSegments][maxColumns];
+TeensyPOV::SegmentRow * volatile TeensyPOV::displayArray = segmentArray[0];
+TeensyPOV::SegmentRow * volatile TeensyPOV::drawArray = segmentArray[numSegmentBuffers - 1];
+volatile bool TeensyPOV::bufferSwapPending = false;
+volatile uint32_t TeensyPOV::colorArray[2][paletteWords];
+volatile uint32_t * volatile TeensyPOV::currentColors = colorArray[0];
+volatile uint32_t * volatile TeensyPOV::stagedColors = colorArray[1];
+volatile bool TeensyPOV::paletteSwapPending = false;
+void (* volatile TeensyPOV::updateVector)(void) = TeensyPOV::updateLeds;
+const void * volatile TeensyPOV::truecolorFrame = nullptr;
+const void * volatile TeensyPOV::stagedTruecolorFrame = nullptr;
+#ifdef POV_APA102_HDR
+uint32_t TeensyPOV::apa102SpiRate = 0;
+volatile uint8_t TeensyPOV::dimLevel = 255;
+volatile uint32_t TeensyPOV::apa102Brightness = 31;
+#endif  // POV_APA102_HDR
+#ifdef POV_TEMPORAL_DITHER
+volatile uint32_t TeensyPOV::ditherArray[maxDitherPhases][paletteWords];
+volatile uint32_t * volatile TeensyPOV::activeColors = colorArray[0];
+volatile uint8_t TeensyPOV::numDitherPhases = 1;
+#endif  // POV_TEMPORAL_DITHER
+volatile uint32_t TeensyPOV::revolutionCount = 0;
+void (* volatile TeensyPOV::frameCallback)(uint32_t, uint32_t) = nullptr;
+volatile uint8_t TeensyPOV::frameDivider = 1;
+volatile uint8_t TeensyPOV::frameCountdown = 1;
+volatile bool TeensyPOV::frameBusy = false;
+volatile uint32_t TeensyPOV::frameRevolution;
+volatile uint32_t TeensyPOV::framePeriod;
 volatile uint32_t TeensyPOV::currentNumColorBits = 0;
+volatile uint32_t TeensyPOV::currentNumPaletteEntries = 1;
 volatile uint32_t TeensyPOV::currentNumSegments = 1 << currentLogNumSegments;
 volatile uint32_t TeensyPOV::currentSegmentMask = currentNumSegments - 1;
 volatile uint32_t TeensyPOV::currentColorMask;
 volatile uint32_t TeensyPOV::goodRpmCount;
 volatile uint32_t TeensyPOV::currentDisplaySegment;
 volatile uint32_t TeensyPOV::currentTdcDisplaySegment = 0;
-volatile uint32_t TeensyPOV::updateTdcDisplaySegment = currentTdcDisplaySegment;
-volatile uint32_t TeensyPOV::lastRpmTimerReading;
+volatile uint32_t TeensyPOV::updateTdcPosition = currentTdcDisplaySegment
+		<< tdcPositionShift;
+volatile uint32_t TeensyPOV::lastRotationCount;
+volatile uint8_t TeensyPOV::overrunPolicy = OVERRUN_SKIP;
+volatile uint16_t TeensyPOV::segmentsShown = 0;
+volatile uint32_t TeensyPOV::revolutionCompression = 0;
+volatile bool TeensyPOV::intervalCorrection = false;
+volatile int64_t TeensyPOV::segmentInterval;
+volatile int64_t TeensyPOV::segmentIntervalStep;
+volatile uint32_t TeensyPOV::lastTdcLatency;
+volatile uint8_t TeensyPOV::glitchFilterPercent = 0;
 volatile uint8_t TeensyPOV::hallPin;
+volatile PovTelemetry TeensyPOV::telemetry;
 #ifdef DEBUG_MODE
 volatile bool TeensyPOV::segmentTimerIsrFire = false;
 volatile bool TeensyPOV::rpmTimerIsrFire = false;
@@ -55,7 +104,7 @@ bool TeensyPOV::povSetup(uint8_t hPin, CRGB *ledPtr, uint8_t num) {
 	 * 	uint8_t num -- Number of LEDs
 	 *
 	 * 	Returns:
-	 * 		true if num < maxNumLeds
+	 * 		true if num <= maxNumLeds (and, with HALL_INPUT_CAPTURE, hPin is an FTM0 input capture pin)
 	 */
 	const uint8_t rpmTimerIndex = 0;
 	const uint8_t segmentTimerIndex = 1;
@@ -69,6 +118,11 @@ bool TeensyPOV::povSetup(uint8_t hPin, CRGB *ledPtr, uint8_t num) {
 	hallPin = hPin;
 	leds = ledPtr;
 	numLeds = num;
+#ifdef POV_APA102_HDR
+	if (apa102SpiRate == 0) {
+		setApa102Spi(apa102DefaultSpiRate);
+	}
+#endif  // POV_APA102_HDR
 	allLedsOff(); // Initialize LEDs and set all off
 
 	// Enable Periodic Interrupt Timers (PIT) - from PJRC Teensy IntervalTimer.cpp code
@@ -97,6 +151,16 @@ bool TeensyPOV::povSetup(uint8_t hPin, CRGB *ledPtr, uint8_t num) {
 			segmentTimerInterruptPriority);	// Set interrupt priority
 	NVIC_ENABLE_IRQ(IRQ_PIT_CH0 + segmentTimerIndex);		// Enable interrupt
 
+	// PIT channel 2 is not started, its interrupt is pended by tdcIsrActive() to run frame callbacks
+	// at a lower priority than the segment timing
+	funct_table[frameInterruptIndex] = frameIsr;
+	NVIC_SET_PRIORITY(IRQ_PIT_CH0 + frameInterruptIndex, frameInterruptPriority);
+	NVIC_ENABLE_IRQ(IRQ_PIT_CH0 + frameInterruptIndex);
+
+	// CPU cycle counter, used to time the frame callbacks
+	ARM_DEMCR |= ARM_DEMCR_TRCENA;
+	ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
 #ifdef SIMULATE_RPM
 	// Set up timer interrupt to simulate Hall sensor (Top Dead Center)
 	const uint8_t tdcSimulatorTimerIndex = 3;
@@ -112,6 +176,12 @@ bool TeensyPOV::povSetup(uint8_t hPin, CRGB *ledPtr, uint8_t num) {
 	NVIC_ENABLE_IRQ(IRQ_PIT_CH0 + tdcSimulatorTimerIndex);// Enable interrupt
 	tdcSimulator->TCTRL = 3;
 
+#elif defined(HALL_INPUT_CAPTURE)
+	// Hall sensor edge time stamped by FTM0 input capture hardware
+	if (!captureSetup(hallPin)) {
+		return false;
+	}
+
 #else
 	// Set up interrupt for Hall sensor (Top Dead Center)
 	pinMode(hallPin, INPUT_PULLUP);
@@ -123,12 +193,15 @@ bool TeensyPOV::povSetup(uint8_t hPin, CRGB *ledPtr, uint8_t num) {
 }
 
 void TeensyPOV::loadPattern(const LedArrayStruct *patternStruct) {
-	uint32_t row, column;
+	uint32_t row, sourceRow, column;
 
+	// Pattern rows are repeated or decimated if it was drawn for a different number of segments
 	for (row = 0; row < currentNumSegments; row++) {
+		sourceRow = (row << patternStruct->logNumSegments)
+				>> currentLogNumSegments;
 		for (column = 0; column < patternStruct->columns; column++) {
-			segmentArray[row][column] = *(patternStruct->array
-					+ row * patternStruct->columns + column);
+			drawArray[row][column] = *(patternStruct->array
+					+ sourceRow * patternStruct->columns + column);
 		}
 	}
 }
@@ -149,6 +222,24 @@ uint16_t TeensyPOV::getNumSegments() {
 	return currentNumSegments;
 }
 
+uint16_t TeensyPOV::getNumPaletteEntries() {
+	/*
+	 * Get number of entries in the current palette: 2 ^ (color bits) for each palette band.
+	 */
+	return currentNumPaletteEntries;
+}
+
+uint32_t TeensyPOV::getRevolutionCount() {
+	/*
+	 * Get number of revolutions displayed since power up. Can be used to pace animations.
+	 *	Parameters:
+	 *			N/A
+	 *	Returns:
+	 * 			Count of revolutions (uint32_t)
+	 */
+	return revolutionCount;
+}
+
 uint32_t TeensyPOV::getLastRotationCount() {
 	/*
 	 * Get duration of last POV blade rotation in units of PIT ticks.
@@ -159,7 +250,182 @@ uint32_t TeensyPOV::getLastRotationCount() {
 	 *	Returns:
 	 * 			Count of PIT ticks (uint32_t)
 	 */
-	return rpmCycles - lastRpmTimerReading;
+	return lastRotationCount;
+}
+
+void TeensyPOV::setGlitchFilter(uint8_t percent) {
+	/*
+	 * Reject Hall sensor edges that arrive implausibly early.
+	 * Parameters:
+	 * 	uint8_t percent -- An edge arriving before this percentage of the last rotation period has elapsed
+	 * 		is treated as noise and ignored. Use zero (default) to disable the filter. 75 is a reasonable value.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (percent > 100) {
+		percent = 100;
+	}
+	glitchFilterPercent = percent;
+}
+
+void TeensyPOV::setOverrunPolicy(uint8_t policy) {
+	/*
+	 * Select how segment timing reacts when the rotor speed changes.
+	 * Parameters:
+	 * 	uint8_t policy --
+	 * 		OVERRUN_SKIP (default) - Segments are timed from the last rotation period. If the rotor speeds up, segments
+	 * 			not yet shown when the next TDC arrives are dropped.
+	 * 		OVERRUN_COMPRESS - Segments are timed from the period extrapolated from the last two rotations, so the
+	 * 			whole revolution is compressed (or stretched) to fit a rotor that is speeding up (or slowing down).
+	 * 		OVERRUN_CORRECT - As OVERRUN_COMPRESS, but the segment period is also corrected within the revolution to
+	 * 			follow a constant angular acceleration.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (policy > OVERRUN_CORRECT) {
+		policy = OVERRUN_SKIP;
+	}
+	overrunPolicy = policy;
+}
+
+uint32_t TeensyPOV::segmentCostTicks(uint8_t logSegments, uint32_t spiRate) {
+	/*
+	 * Estimate the time taken by one segment update (unpacking + SPI output) at the current LED count and color bits.
+	 * Parameters:
+	 * 	uint8_t logSegments -- Log (base 2) of number of segments. Below LOG_512_SEGMENTS each segment also blanks the LEDs.
+	 *
+	 * 	uint32_t spiRate -- LED clock rate in Hz, as given to FastLED.addLeds() (e.g. DATA_RATE_MHZ(24)).
+	 *
+	 * Returns:
+	 * 	Estimated PIT ticks
+	 */
+	uint32_t cpuCycles, spiBits, showCount, words;
+
+	words = (numLeds * currentNumColorBits + bitsPerWord - 1) / bitsPerWord;
+	cpuCycles = isrOverheadCycles + numLeds
+			* ((currentNumColorBits >= COLOR_BITS_4) ? ledLookupCycles : ledUnpackCycles)
+			+ words * wordLoadCycles
+			+ (numRotationBands - 1) * (bandSetupCycles + wordLoadCycles);
+
+	// APA102: start frame, one 32-bit frame per LED, end frame of (numLeds / 2) clocks
+	spiBits = 32 * (numLeds + 1) + numLeds / 2;
+	showCount = (logSegments < LOG_512_SEGMENTS) ? 2 : 1;
+
+	return (uint64_t) cpuCycles * F_BUS / F_CPU
+			+ (uint64_t) spiBits * showCount * F_BUS / spiRate;
+}
+
+uint8_t TeensyPOV::governLogNumSegments(uint8_t logSegments, uint32_t spiRate,
+		uint8_t minLog, uint8_t maxLog) {
+	/*
+	 * Pick the highest number of segments whose update fits the segment period at the measured rotation speed.
+	 * Parameters:
+	 * 	uint8_t logSegments -- Log (base 2) of the number of segments now in use.
+	 *
+	 * 	uint32_t spiRate -- LED clock rate in Hz.
+	 *
+	 * 	uint8_t minLog, maxLog -- Allowed range of log (base 2) number of segments.
+	 *
+	 * Returns:
+	 * 	Log (base 2) of number of segments to use. Steps down when the update takes more than 3/4 of a segment period,
+	 * 	steps up only when it would take less than 5/8 of the shorter period (hysteresis).
+	 */
+	uint32_t rotation = lastRotationCount;
+	uint32_t segmentTicks;
+
+	if (rotation == 0) {
+		return logSegments;
+	}
+	if (logSegments < minLog) {
+		logSegments = minLog;
+	}
+	if (logSegments > maxLog) {
+		logSegments = maxLog;
+	}
+
+	while (logSegments > minLog) {
+		segmentTicks = rotation >> logSegments;
+		if (segmentCostTicks(logSegments, spiRate) <= segmentTicks / 4 * 3) {
+			break;
+		}
+		logSegments--;
+	}
+
+	while (logSegments < maxLog) {
+		segmentTicks = rotation >> (logSegments + 1);
+		if (segmentCostTicks(logSegments + 1, spiRate) > segmentTicks / 8 * 5) {
+			break;
+		}
+		logSegments++;
+	}
+	return logSegments;
+}
+
+void TeensyPOV::setFrameCallback(void (*ptr)(uint32_t, uint32_t),
+		uint8_t everyN) {
+	/*
+	 * Set optional callback function to be called once every 'everyN' revolutions, just after Top Dead Center.
+	 * It runs in a low priority interrupt, so it may take most of a revolution without disturbing the
+	 * segment timing, but must not block. If it is still running when the next one is due, that frame is skipped.
+	 * Parameters:
+	 * 	void (*ptr)(uint32_t revolution, uint32_t period) -- Pointer to the function to be called, or nullptr for none.
+	 * 		It is passed the revolution count (see getRevolutionCount()) and the last rotation period in PIT ticks.
+	 *
+	 * 	uint8_t everyN -- Number of revolutions per call (1 = every revolution).
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (everyN == 0) {
+		everyN = 1;
+	}
+	noInterrupts();
+	frameCallback = ptr;
+	frameDivider = everyN;
+	frameCountdown = everyN;
+	interrupts();
+}
+
+void TeensyPOV::getTelemetry(PovTelemetry *ptr) {
+	/*
+	 * Get a consistent copy of the timing engine's counters.
+	 * Parameters:
+	 * 	PovTelemetry *ptr -- Pointer to structure to receive the counters. Latencies are in PIT ticks.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	noInterrupts();
+	ptr->revolutions = telemetry.revolutions;
+	ptr->glitchesRejected = telemetry.glitchesRejected;
+	ptr->lastCaptureLatency = telemetry.lastCaptureLatency;
+	ptr->maxCaptureLatency = telemetry.maxCaptureLatency;
+	ptr->droppedSegments = telemetry.droppedSegments;
+	ptr->compressedSegments = telemetry.compressedSegments;
+	ptr->lastDroppedSegments = telemetry.lastDroppedSegments;
+	ptr->lastCompressedSegments = telemetry.lastCompressedSegments;
+	ptr->framesSkipped = telemetry.framesSkipped;
+	ptr->lastFrameCycles = telemetry.lastFrameCycles;
+	ptr->maxFrameCycles = telemetry.maxFrameCycles;
+	interrupts();
+}
+
+void TeensyPOV::clearTelemetry() {
+	noInterrupts();
+	telemetry.revolutions = 0;
+	telemetry.glitchesRejected = 0;
+	telemetry.lastCaptureLatency = 0;
+	telemetry.maxCaptureLatency = 0;
+	telemetry.droppedSegments = 0;
+	telemetry.compressedSegments = 0;
+	telemetry.lastDroppedSegments = 0;
+	telemetry.lastCompressedSegments = 0;
+	telemetry.framesSkipped = 0;
+	telemetry.lastFrameCycles = 0;
+	telemetry.maxFrameCycles = 0;
+	interrupts();
 }
 
 void TeensyPOV::setPixel(uint16_t segment, uint16_t pixel, uint32_t value) {
@@ -184,110 +450,719 @@ void TeensyPOV::setPixel(uint16_t segment, uint16_t pixel, uint32_t value) {
 	value <<= pixelShift;
 	value &= pixelMask;
 
-	segmentArray[segment][pixelWord] &= (~pixelMask);
-	segmentArray[segment][pixelWord] |= value;
+	drawArray[segment][pixelWord] &= (~pixelMask);
+	drawArray[segment][pixelWord] |= value;
+}
+
+bool TeensyPOV::setTruecolor(const CRGB *frame, uint8_t logSegments,
+		uint16_t tdcSegment) {
+	/*
+	 * Show 24-bit RGB segments directly, with no palette. Replaces the current display configuration until the next
+	 * setParameters() (e.g. a TeensyPovDisplay activation).
+	 * Parameters:
+	 * 	const CRGB *frame -- Colors of every LED (innermost first) of every segment, i.e. CRGB[segments][number of LEDs].
+	 * 		May be in flash (const) for large frames. The array pointed to must be static or global. nullptr goes back
+	 * 		to palette mode with the current segment data.
+	 *
+	 * 	uint8_t logSegments -- Log (base 2) of number of segments in the frame, up to maxLogNumSegments.
+	 *
+	 * 	uint16_t tdcSegment -- Segment number to display when rotating blade hits Top Dead Center.
+	 *
+	 * Returns:
+	 * 	false if the number of segments isn't supported.
+	 */
+	return startTruecolor(frame, logSegments, tdcSegment, updateLedsTruecolor);
+}
+
+void TeensyPOV::stageTruecolorFrame(const CRGB *frame) {
+	/*
+	 * Show another frame of the same size as the one given to setTruecolor() from the next Top Dead Center,
+	 * e.g. for animation. No effect in palette mode.
+	 */
+	stageFrame(frame, updateLedsTruecolor);
+}
+
+bool TeensyPOV::startTruecolor(const void *frame, uint8_t logSegments,
+		uint16_t tdcSegment, void (*vector)(void)) {
+	if (frame == nullptr) {
+		noInterrupts();
+		updateVector = paletteVector();
+		truecolorFrame = nullptr;
+		stagedTruecolorFrame = nullptr;
+		interrupts();
+		return true;
+	}
+	if (logSegments < LOG_2_SEGMENTS || logSegments > maxLogNumSegments
+			|| tdcSegment >= (1U << logSegments)) {
+		return false;
+	}
+	setParameters(logSegments, COLOR_BITS_8, tdcSegment);
+	noInterrupts();
+	truecolorFrame = frame;
+	updateVector = vector;
+	interrupts();
+	return true;
+}
+
+void TeensyPOV::stageFrame(const void *frame, void (*vector)(void)) {
+	noInterrupts();
+	if (updateVector == vector) {
+		stagedTruecolorFrame = frame;
+	}
+	interrupts();
+}
+
+#ifdef POV_APA102_HDR
+/*
+ * APA102 LED frames are sent straight from SPI0 as 16-bit transfers: 32 zero bits, then one 32-bit word per LED:
+ * 0xE0 | 5-bit brightness, blue, green, red (the BGR order used by the examples), then zeros to clock the data
+ * through the string. Palette entries are encoded once when loaded so the segment interrupt only looks them up.
+ */
+static const uint32_t spiFifoDepth = 4;
+
+static inline void apa102Word(uint32_t word) {
+	while ((SPI0_SR & 0xF000) >= (spiFifoDepth << 12)) {
+		// Wait for room in the transmit FIFO
+	}
+	SPI0_PUSHR = word >> 16;
+	while ((SPI0_SR & 0xF000) >= (spiFifoDepth << 12)) {
+	}
+	SPI0_PUSHR = word & 0xFFFF;
+}
+
+static inline void apa102EndFrame(uint32_t numLeds) {
+	// One extra clock per two LEDs
+	for (uint32_t index1 = 0; index1 < numLeds; index1 += 64) {
+		apa102Word(0);
+	}
+}
+
+uint32_t TeensyPOV::setApa102Spi(uint32_t spiRate) {
+	/*
+	 * Set the clock rate of the APA102 LEDs, driven directly from SPI0 (data on pin 11, clock on pin 13) so their 5-bit
+	 * brightness field can be used. The LEDs must not be registered with FastLED.addLeds(). Optional, povSetup()
+	 * sets 12 MHz if this hasn't been called.
+	 * Parameters:
+	 * 	uint32_t spiRate -- Highest clock rate wanted, in Hz.
+	 *
+	 * Returns:
+	 * 	Clock rate set, in Hz.
+	 */
+	static const uint8_t prescalers[] = { 2, 3, 5, 7 };
+	uint32_t rate, ctar = SPI_CTAR_FMSZ(15) | SPI_CTAR_PBR(3) | SPI_CTAR_BR(15);
+	uint8_t prescaler, scaler, doubler;
+
+	apa102SpiRate = F_BUS / (7UL << 15);		// Slowest
+	for (prescaler = 0; prescaler < 4; prescaler++) {
+		for (scaler = 0; scaler < 16; scaler++) {
+			for (doubler = 1; doubler <= 2; doubler++) {
+				// Scalers 2, 4, 6, 8, 16, 32, ... 32768
+				rate = F_BUS * doubler / prescalers[prescaler]
+						/ ((scaler < 4) ? 2 * (scaler + 1) : 1UL << scaler);
+				if (rate <= spiRate && rate > apa102SpiRate) {
+					apa102SpiRate = rate;
+					ctar = SPI_CTAR_FMSZ(15) | SPI_CTAR_PBR(prescaler)
+							| SPI_CTAR_BR(scaler) | ((doubler == 2) ? SPI_CTAR_DBR : 0);
+				}
+			}
+		}
+	}
+	SIM_SCGC6 |= SIM_SCGC6_SPI0;
+	SPI0_MCR = SPI_MCR_MSTR | SPI_MCR_PCSIS(0x1F) | SPI_MCR_HALT;
+	SPI0_CTAR0 = ctar;
+	SPI0_MCR = SPI_MCR_MSTR | SPI_MCR_PCSIS(0x1F) | SPI_MCR_CLR_TXF
+			| SPI_MCR_CLR_RXF;
+	CORE_PIN11_CONFIG = PORT_PCR_DSE | PORT_PCR_MUX(2);
+	CORE_PIN13_CONFIG = PORT_PCR_DSE | PORT_PCR_MUX(2);
+	return apa102SpiRate;
+}
+
+uint32_t TeensyPOV::apa102Encode(uint32_t color) {
+	/*
+	 * Split a dimmed color into the 5-bit brightness field and 8-bit RGB. Levels are in 1/31 of an LED step, so dim
+	 * colors keep up to 5 more bits of resolution: the smallest brightness that fits the brightest channel is used.
+	 */
+	uint32_t level[3], brightest = 0, brightness, word = 0;
+	uint8_t channel;
+
+	for (channel = 0; channel < 3; channel++) {
+		level[channel] = (((color >> (8 * channel)) & 0xFF) * dimLevel * 31 + 127)
+				/ 255;
+		brightest = max(brightest, level[channel]);
+	}
+	brightness = (brightest + 254) / 255;
+	if (brightness == 0) {
+		return 0xE0000000;
+	}
+	for (channel = 0; channel < 3; channel++) {
+		// Blue, green, red from the top: level[2] is red
+		word = (word << 8)
+				| min((level[channel] + brightness / 2) / brightness, (uint32_t) 255);
+	}
+	return ((0xE0 | brightness) << 24) | word;
+}
+
+void TeensyPOV::encodePalette(volatile uint32_t *palette) {
+	uint16_t index1;
+	for (index1 = 0; index1 < currentNumPaletteEntries; index1++) {
+		palette[paletteEntries + index1] = apa102Encode(palette[index1]);
+	}
+}
+
+void TeensyPOV::setDimming(uint8_t level) {
+	/*
+	 * Dim the whole display without losing palette resolution: colors are re-encoded from their 8-bit values,
+	 * the lost range coming out of the brightness field. Truecolor frames get the nearest brightness field only;
+	 * re-encode APA102 frames with encodeApa102() instead.
+	 * Parameters:
+	 * 	uint8_t level -- 255 for full brightness, 0 for off.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	dimLevel = level;
+	apa102Brightness = (level * 31UL + 254) / 255;
+	encodePalette(currentColors);
+	encodePalette(stagedColors);
+#ifdef POV_TEMPORAL_DITHER
+	for (uint8_t phase = 0; phase < numDitherPhases && numDitherPhases > 1;
+			phase++) {
+		encodePalette(ditherArray[phase]);
+	}
+#endif  // POV_TEMPORAL_DITHER
+}
+
+void TeensyPOV::encodeApa102(const CRGB *in, uint32_t *out, uint32_t count) {
+	/*
+	 * Encode colors as APA102 LED frames at the current dimming, e.g. to build frames for setApa102Frame().
+	 * Parameters:
+	 * 	const CRGB *in -- Colors.
+	 *
+	 * 	uint32_t *out -- LED frames, count words.
+	 *
+	 * 	uint32_t count -- Number of colors.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	while (count--) {
+		*out++ = apa102Encode(((uint32_t) in->r << 16) | (in->g << 8) | in->b);
+		in++;
+	}
+}
+
+bool TeensyPOV::setApa102Frame(const uint32_t *frame, uint8_t logSegments,
+		uint16_t tdcSegment) {
+	/*
+	 * As setTruecolor(), but with every LED already encoded as an APA102 LED frame (see encodeApa102()),
+	 * i.e. uint32_t[segments][number of LEDs]. The segment interrupt just sends the words.
+	 */
+	return startTruecolor(frame, logSegments, tdcSegment, updateLedsApa102);
+}
+
+void TeensyPOV::stageApa102Frame(const uint32_t *frame) {
+	/*
+	 * As stageTruecolorFrame(), for frames given to setApa102Frame().
+	 */
+	stageFrame(frame, updateLedsApa102);
+}
+#endif  // POV_APA102_HDR
+
+void TeensyPOV::beginFrame() {
+	/*
+	 * Start drawing a new frame. With POV_DOUBLE_BUFFER, setPixel() etc. draw into a back buffer that isn't
+	 * displayed until endFrame(). The back buffer starts as a copy of what is displayed, or as the frame still waiting
+	 * to be shown if endFrame() was called less than a revolution ago. Without POV_DOUBLE_BUFFER this does nothing.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	uint32_t row, column, columns;
+	bool wasPending;
+
+	if (numSegmentBuffers == 1) {
+		return;
+	}
+	noInterrupts();
+	wasPending = bufferSwapPending;
+	bufferSwapPending = false;
+	interrupts();
+	if (wasPending) {
+		return;
+	}
+
+	columns = (numLeds * currentNumColorBits + bitsPerWord - 1) / bitsPerWord;
+	for (row = 0; row < currentNumSegments; row++) {
+		for (column = 0; column < columns; column++) {
+			drawArray[row][column] = displayArray[row][column];
+		}
+	}
+}
+
+void TeensyPOV::endFrame() {
+	/*
+	 * Show the frame drawn since beginFrame() from the next Top Dead Center, or immediately if the display isn't running.
+	 * Without POV_DOUBLE_BUFFER this does nothing.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	requestSwap(true, false);
+}
+
+void TeensyPOV::requestSwap(bool segments, bool palette) {
+	// Palette and segment buffers requested together are swapped by the same Top Dead Center
+	SegmentRow *rows;
+	volatile uint32_t *swap;
+
+	if (numSegmentBuffers == 1) {
+		segments = false;
+	}
+	noInterrupts();
+	if (rpmGood()) {
+		bufferSwapPending |= segments;
+		paletteSwapPending |= palette;
+	} else {
+		if (segments) {
+			rows = displayArray;
+			displayArray = drawArray;
+			drawArray = rows;
+		}
+		if (palette) {
+			swap = currentColors;
+			currentColors = stagedColors;
+			stagedColors = swap;
+		}
+	}
+	interrupts();
 }
 
 
 
 void TeensyPOV::loadColors(const uint32_t *cPtr) {
 	uint16_t index1;
-	for (index1 = 0; index1 < (1 << currentNumColorBits); index1++) {
-		colorArray[index1] = *(cPtr + index1);
+	paletteSwapPending = false;
+	for (index1 = 0; index1 < currentNumPaletteEntries; index1++) {
+		currentColors[index1] = *(cPtr + index1);
+	}
+#ifdef POV_APA102_HDR
+	encodePalette(currentColors);
+#endif  // POV_APA102_HDR
+}
+
+bool TeensyPOV::setPaletteBands(const uint8_t *bandStart, uint8_t n) {
+	/*
+	 * Give each radial band of LEDs its own bank of 2 ^ (color bits) palette entries, multiplying the number of
+	 * colors without more color bits. Palettes loaded afterwards hold n banks one after the other: band 0 uses
+	 * entries 0 to (2 ^ bits) - 1, band 1 the next 2 ^ bits entries, etc. The bank is resolved by a per-LED
+	 * lookup table built here, so the LED update costs the same.
+	 * Parameters:
+	 * 	const uint8_t *bandStart -- Array of first LED (0 = innermost) of each band in increasing order.
+	 * 		bandStart[0] should be 0. Use nullptr for a single band.
+	 *
+	 * 	uint8_t n -- Number of bands.
+	 *
+	 * Returns:
+	 * 	true if the banks fit in the palette (n * 2 ^ (color bits) <= 256)
+	 */
+	uint8_t index;
+
+	if (bandStart == nullptr || n <= 1) {
+		numPaletteBands = 1;
+		paletteBandStart[0] = 0;
+		buildPaletteBands();
+		return true;
+	}
+	if (n > maxPaletteBands
+			|| ((uint32_t) n << currentNumColorBits) > (1UL << maxNumColorBits)) {
+		return false;
+	}
+	for (index = 0; index < n; index++) {
+		paletteBandStart[index] = bandStart[index];
+	}
+	numPaletteBands = n;
+	buildPaletteBands();
+	return true;
+}
+
+void TeensyPOV::buildPaletteBands() {
+	uint32_t led;
+	uint8_t band = 0;
+
+	if (((uint32_t) numPaletteBands << currentNumColorBits)
+			> (1UL << maxNumColorBits)) {
+		numPaletteBands = 1;
+	}
+	for (led = 0; led < maxNumLeds; led++) {
+		while (band + 1 < numPaletteBands && led >= paletteBandStart[band + 1]) {
+			band++;
+		}
+		ledPaletteBase[led] = band << currentNumColorBits;
+	}
+	currentNumPaletteEntries = numPaletteBands << currentNumColorBits;
+}
+
+bool TeensyPOV::setRotationBands(const uint8_t *bandStart, uint8_t n) {
+	/*
+	 * Let radial bands of LEDs turn independently of each other, e.g. counter-rotating text rings around a
+	 * fixed logo. Each band shows the segment data at its own offset from the displayed segment. The offsets move
+	 * by each band's velocity once per revolution (see setBandRotation()), so nothing is redrawn.
+	 * Parameters:
+	 * 	const uint8_t *bandStart -- Array of first LED (0 = innermost) of each band in increasing order.
+	 * 		bandStart[0] should be 0. Use nullptr for a single band, turning with the whole display.
+	 *
+	 * 	uint8_t n -- Number of bands.
+	 *
+	 * Returns:
+	 * 	false if n is more than 8
+	 */
+	uint8_t index;
+
+	if (n > maxRotationBands) {
+		return false;
+	}
+	if (bandStart == nullptr) {
+		n = 1;
+	}
+	noInterrupts();
+	for (index = 0; index < maxRotationBands; index++) {
+		rotationBandStart[index] = (index < n && bandStart) ? bandStart[index] : 0;
+		bandVelocity[index] = 0;
+		bandPosition[index] = 0;
+		bandOffset[index] = 0;
+	}
+	numRotationBands = (n > 1) ? n : 1;
+	if (!truecolorFrame) {
+		updateVector = paletteVector();
+	}
+	interrupts();
+	return true;
+}
+
+void TeensyPOV::setBandRotation(uint8_t band, int32_t velocity) {
+	/*
+	 * Parameters:
+	 * 	uint8_t band -- Band set by setRotationBands().
+	 *
+	 * 	int32_t velocity -- Segments per revolution in 16.16 fixed point (65536 = one segment per revolution).
+	 * 		Positive values turn the band the same way as increasing the Top Dead Center segment turns the display.
+	 */
+	if (band < maxRotationBands) {
+		bandVelocity[band] = velocity;
+	}
+}
+
+void TeensyPOV::setBandPosition(uint8_t band, uint32_t position) {
+	/*
+	 * Parameters:
+	 * 	uint8_t band -- Band set by setRotationBands().
+	 *
+	 * 	uint32_t position -- Offset from the display's own position in 16.16 fixed point segments.
+	 */
+	if (band < maxRotationBands) {
+		noInterrupts();
+		bandPosition[band] = position;
+		bandOffset[band] = (position >> tdcPositionShift) & currentSegmentMask;
+		interrupts();
+	}
+}
+
+void (*TeensyPOV::paletteVector(void))(void) {
+	// The palette mode LED update, with the per band lookup only when bands turn independently
+	return (numRotationBands > 1) ? updateLedsBands : updateLeds;
+}
+
+void TeensyPOV::stagePalette(const uint32_t *cPtr) {
+	/*
+	 * Stage a new palette to replace the current one at the next Top Dead Center. Segment data is not touched.
+	 * Parameters:
+	 * 	const uint32_t *cPtr -- Pointer to array of RGB colors. Array must have at least getNumPaletteEntries()
+	 * 		elements. It is copied, so it need not remain valid.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	volatile uint32_t *colors;
+	uint16_t index1;
+
+	colors = beginPalette();
+	for (index1 = 0; index1 < currentNumPaletteEntries; index1++) {
+		colors[index1] = *(cPtr + index1);
 	}
+	commitPalette();
+}
+
+volatile uint32_t *TeensyPOV::beginPalette() {
+	/*
+	 * Get the staging palette to fill in place, then call commitPalette(). Cancels any swap not yet done.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	Pointer to the getNumPaletteEntries() staging palette entries, initially undefined.
+	 */
+	noInterrupts();
+	paletteSwapPending = false;
+	interrupts();
+	return stagedColors;
+}
+
+void TeensyPOV::commitPalette() {
+	/*
+	 * Swap in the palette filled after beginPalette() at the next Top Dead Center,
+	 * or immediately if the display isn't running.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+#ifdef POV_APA102_HDR
+	encodePalette(stagedColors);
+#endif  // POV_APA102_HDR
+	requestSwap(false, true);
+}
+
+bool TeensyPOV::paletteStaged() {
+	/*
+	 * Returns:
+	 * 	true if a committed palette is still waiting for Top Dead Center
+	 */
+	return paletteSwapPending;
 }
 
+#ifdef POV_TEMPORAL_DITHER
+bool TeensyPOV::setDitherPalettes(const uint32_t * const *palettes,
+		uint8_t numPhases) {
+	/*
+	 * Show a different palette on successive revolutions, selected by the revolution count at Top Dead Center.
+	 * The eye averages them, giving shades between the LEDs' steps at no extra cost per segment.
+	 * While active the planes replace the current palette (staged palettes and TeensyPovPalette animations
+	 * don't show). Stopped by stopDither() and by a change of display configuration.
+	 * Parameters:
+	 * 	const uint32_t * const *palettes -- Array of numPhases pointers to palettes of getNumPaletteEntries()
+	 * 		colors each. They are copied, so they need not remain valid.
+	 *
+	 * 	uint8_t numPhases -- Number of palettes: 2 or 4 (1 stops dithering).
+	 *
+	 * Returns:
+	 * 	false if numPhases isn't 1, 2 or 4.
+	 */
+	uint16_t index1;
+	uint8_t phase;
+
+	if (numPhases != 1 && numPhases != 2 && numPhases != maxDitherPhases) {
+		return false;
+	}
+	stopDither();					// No plane is shown while the planes are written
+	for (phase = 0; phase < numPhases && numPhases > 1; phase++) {
+		for (index1 = 0; index1 < currentNumPaletteEntries; index1++) {
+			ditherArray[phase][index1] = palettes[phase][index1];
+		}
+#ifdef POV_APA102_HDR
+		encodePalette(ditherArray[phase]);
+#endif  // POV_APA102_HDR
+	}
+	numDitherPhases = numPhases;
+	return true;
+}
+
+bool TeensyPOV::loadDitherPalette(const uint16_t *colors, uint8_t numPhases) {
+	/*
+	 * Build and show dither palettes (see setDitherPalettes()) from colors with 8 extra bits per channel.
+	 * Each plane rounds the fraction up or down against an ordered threshold, so across numPhases revolutions
+	 * every channel averages to its exact value, e.g. 0x0080 (half of the dimmest step) is on every other
+	 * revolution.
+	 * Parameters:
+	 * 	const uint16_t *colors -- Red, green, blue per palette entry, each 8.8 fixed point (0x0000 - 0xFF00),
+	 * 		3 * getNumPaletteEntries() values in all.
+	 *
+	 * 	uint8_t numPhases -- Number of planes: 2 or 4.
+	 *
+	 * Returns:
+	 * 	false if numPhases isn't 2 or 4.
+	 */
+	static const uint8_t order[maxDitherPhases] = { 0, 2, 1, 3 };	// Spreads the ones out in time
+	uint16_t index1, value;
+	uint8_t phase, rank, channel, threshold, level;
+	uint32_t color;
+
+	if (numPhases != 2 && numPhases != maxDitherPhases) {
+		return false;
+	}
+	stopDither();
+	for (phase = 0; phase < numPhases; phase++) {
+		rank = (numPhases == maxDitherPhases) ? order[phase] : phase;
+		threshold = ((2 * rank + 1) * 128) / numPhases;
+		for (index1 = 0; index1 < currentNumPaletteEntries; index1++) {
+			color = 0;
+			for (channel = 0; channel < 3; channel++) {
+				value = colors[3 * index1 + channel];
+				level = value >> 8;
+				if ((value & 0xFF) > threshold && level < 255) {
+					level++;
+				}
+				color = (color << 8) | level;
+			}
+			ditherArray[phase][index1] = color;
+		}
+#ifdef POV_APA102_HDR
+		encodePalette(ditherArray[phase]);
+#endif  // POV_APA102_HDR
+	}
+	numDitherPhases = numPhases;
+	return true;
+}
+
+void TeensyPOV::stopDither() {
+	// Back to the current palette now rather than at the next TDC, so no plane is left in use
+	noInterrupts();
+	numDitherPhases = 1;
+	activeColors = currentColors;
+	interrupts();
+}
+#endif  // POV_TEMPORAL_DITHER
+
 void TeensyPOV::loadString(const char *string, TextPosition pos, uint8_t topLed,
 		uint8_t color, uint8_t background, bool invert) {
-	char charBuffer[maxTextChars + 1], *bufferPosition;
-	uint8_t len, fontMask, ledBit;
-	//uint8_t padPosition;
-	uint8_t charMatrix[5];
-	int8_t bufferPositionDelta;
-	uint16_t currentMaxChars, stopLed, startLed, physicalSegment;
-	uint16_t charCounter, pixelCounter, matrixCounter;
-	uint16_t virtualSegment;
+	DisplayStringSpec spec = { string, pos, topLed, color, background, invert };
+	uint8_t columns[maxTextChars * charColumns + 1];
+	TextLayout layout;
 
-	if (topLed >= numLeds) {
-		return;
+	if (compileString(&spec, &layout, columns, sizeof(columns))) {
+		drawLayout(&layout, columns, color, background);
 	}
+}
 
-	if (topLed < 6) {
-		return;
-	}
+uint32_t TeensyPOV::stringHash(const DisplayStringSpec *spec) {
+	// FNV-1a of the characters shown and everything else that changes the layout (not the colors)
+	uint32_t hash = 2166136261UL;
+	uint16_t index1, currentMaxChars = currentNumSegments / (2 * charColumns);
 
-	stopLed = topLed;
-	startLed = stopLed - 6;
+	for (index1 = 0; index1 < currentMaxChars && spec->characters[index1] != '\0';
+			index1++) {
+		hash = (hash ^ (uint8_t) spec->characters[index1]) * 16777619UL;
+	}
+	hash = (hash ^ index1) * 16777619UL;
+	hash = (hash ^ spec->position) * 16777619UL;
+	hash = (hash ^ spec->topRow) * 16777619UL;
+	hash = (hash ^ spec->invert) * 16777619UL;
+	return (hash ^ currentLogNumSegments) * 16777619UL;
+}
 
-	memset(charBuffer, '\0', maxTextChars);
+bool TeensyPOV::compileString(const DisplayStringSpec *spec, TextLayout *layout,
+		uint8_t *columns, uint16_t capacity) {
+	/*
+	 * Lay out a string once as font columns (bit 0 = innermost LED of the 7 LED band), one byte per segment
+	 * starting at layout->firstSegment, so drawLayout() just copies them in. Centering, character order and
+	 * inversion are resolved here.
+	 * Returns:
+	 * 	false if the columns don't fit in capacity bytes
+	 */
+	const char *bufferPosition;
+	int8_t bufferPositionDelta;
+	uint8_t charMatrix[5];
+	uint16_t len, currentMaxChars, charCounter, virtualSegment;
+
+	layout->characters = spec->characters;
+	layout->hash = stringHash(spec);
+	layout->topRow = spec->topRow;
+	layout->numColumns = 0;
+	layout->firstSegment = 0;
+	if (spec->topRow >= numLeds || spec->topRow < 6) {
+		return true;
+	}
 
-	currentMaxChars = currentNumSegments / (2 * 7);
-	len = strlen(string);
-	if (len > currentMaxChars) {
-		len = currentMaxChars;
+	currentMaxChars = currentNumSegments / (2 * charColumns);
+	len = strnlen(spec->characters, currentMaxChars);
+	if (len * charColumns > capacity) {
+		return false;
 	}
-	strncpy(charBuffer, string, len);
 
-	switch (pos) {
+	switch (spec->position) {
 	case TOP:
 		virtualSegment = 3 * currentNumSegments / 4 + 1;
-		virtualSegment += (currentNumSegments / 2 - len * 7) / 2;
-		bufferPosition = charBuffer;
+		virtualSegment += (currentNumSegments / 2 - len * charColumns) / 2;
+		bufferPosition = spec->characters;
 		bufferPositionDelta = 1;
 		break;
 
 	case BOTTOM:
 		virtualSegment = currentNumSegments / 4 + 1;
-		virtualSegment += (currentNumSegments / 2 - len * 7) / 2;
-		if (invert) {
-			bufferPosition = charBuffer + len - 1;
+		virtualSegment += (currentNumSegments / 2 - len * charColumns) / 2;
+		if (spec->invert) {
+			bufferPosition = spec->characters + len - 1;
 			bufferPositionDelta = -1;
 		} else {
-			bufferPosition = charBuffer;
+			bufferPosition = spec->characters;
 			bufferPositionDelta = 1;
 		}
 		break;
 
 	default:
-		return;
+		return true;
 	}
-	physicalSegment = virtualSegment & currentSegmentMask;
+	layout->firstSegment = virtualSegment & currentSegmentMask;
+	layout->numColumns = len * charColumns;
 
 	for (charCounter = 0; charCounter < len; charCounter++) {
-	textCharacters::getMatrix(*bufferPosition, charMatrix, invert);
+		textCharacters::getMatrix(*bufferPosition, charMatrix, spec->invert);
+		*columns++ = 0;
+		memcpy(columns, charMatrix, sizeof(charMatrix));
+		columns += sizeof(charMatrix);
+		*columns++ = 0;
+		bufferPosition += bufferPositionDelta;
+	}
+	return true;
+}
 
-		for (pixelCounter = startLed; pixelCounter <= stopLed; pixelCounter++) {
-			setPixel(physicalSegment, pixelCounter, background);
-		}
-		virtualSegment++;
-		physicalSegment = virtualSegment & currentSegmentMask;
-
-		for (matrixCounter = 0; matrixCounter < 5; matrixCounter++) {
-			fontMask = 0x01;
-			for (pixelCounter = startLed; pixelCounter <= stopLed;
-					pixelCounter++) {
-				ledBit = 0;
-				if (charMatrix[matrixCounter] & fontMask) {
-					ledBit = 1;
-				}
-				fontMask <<= 1;
+void TeensyPOV::drawLayout(const TextLayout *layout, const uint8_t *columns,
+		uint8_t color, uint8_t background) {
+	// Each column is expanded to its 7 pixels through a nibble table and merged with at most 3 word operations
+	uint32_t expand[16], pixels, mask0, mask1, mask2;
+	uint64_t value, bandMask;
+	uint8_t bits = currentNumColorBits, shift, nibble, pixel;
+	uint16_t column, segment, word;
+	volatile uint32_t *row;
 
-				if (ledBit == 1) {
-					setPixel(physicalSegment, pixelCounter, color);
-				} else {
-					setPixel(physicalSegment, pixelCounter, background);
-				}
-			}
-			virtualSegment++;
-			physicalSegment = virtualSegment & currentSegmentMask;
+	if (layout->numColumns == 0) {
+		return;
+	}
+	for (nibble = 0; nibble < 16; nibble++) {
+		pixels = 0;
+		for (pixel = 0; pixel < 4; pixel++) {
+			pixels |= (uint32_t) ((((nibble >> pixel) & 1) ? color : background)
+					& currentColorMask) << (pixel * bits);
 		}
-
-		for (pixelCounter = startLed; pixelCounter <= stopLed; pixelCounter++) {
-			setPixel(physicalSegment, pixelCounter, background);
+		expand[nibble] = pixels;
+	}
+	bandMask = (1ULL << (7 * bits)) - 1;
+	word = (layout->topRow - 6) * bits / bitsPerWord;
+	shift = (layout->topRow - 6) * bits % bitsPerWord;
+	mask0 = (uint32_t) (bandMask << shift);
+	mask1 = (uint32_t) (bandMask >> (bitsPerWord - shift));
+	mask2 = (shift + 7U * bits > 2 * bitsPerWord) ?
+			(uint32_t) (bandMask >> (2 * bitsPerWord - shift)) : 0;
+
+	segment = layout->firstSegment;
+	for (column = 0; column < layout->numColumns; column++) {
+		value = (expand[columns[column] & 0x0F]
+				| ((uint64_t) expand[columns[column] >> 4] << (4 * bits))) & bandMask;
+		row = drawArray[segment & currentSegmentMask];
+		row[word] = (row[word] & ~mask0) | (uint32_t) (value << shift);
+		if (mask1) {
+			row[word + 1] = (row[word + 1] & ~mask1)
+					| (uint32_t) (value >> (bitsPerWord - shift));
 		}
-		virtualSegment++;
-		physicalSegment = virtualSegment & currentSegmentMask;
-		bufferPosition += bufferPositionDelta;
+		if (mask2) {
+			row[word + 2] = (row[word + 2] & ~mask2)
+					| (uint32_t) (value >> (2 * bitsPerWord - shift));
+		}
+		segment++;
 	}
 }
 
@@ -298,70 +1173,440 @@ void TeensyPOV::setParameters(uint8_t logSegments, uint8_t colorBits,
 	rpmTimer->TCTRL = 0;			// Disable PIT
 	rpmTimer->TFLG = 1;				// Clear interrupt flag
 	tdcInteruptVector = dummy_funct;
+	segmentsShown = 0;
 	allLedsOff();
+	updateVector = paletteVector();
+	truecolorFrame = nullptr;
+	stagedTruecolorFrame = nullptr;
 
+	if (logSegments > maxLogNumSegments) {
+		logSegments = maxLogNumSegments;
+	}
 	currentLogNumSegments = logSegments;
 	currentNumSegments = 1 << currentLogNumSegments;
 	currentSegmentMask = currentNumSegments - 1;
 	currentNumColorBits = colorBits;
 	currentTdcDisplaySegment = tdcSegment;
-	updateTdcDisplaySegment = currentTdcDisplaySegment;
+	updateTdcPosition = currentTdcDisplaySegment << tdcPositionShift;
 	currentColorMask = (1 << currentNumColorBits) - 1;
 	pixelsPerWord = 32 / currentNumColorBits;
-
-	for (uint16_t i = 0; i < maxNumSegments; i++) {
-		for (uint16_t j = 0; j < maxColumns; j++) {
-			segmentArray[i][j] = 0;
+	buildPaletteBands();
+	for (uint8_t band = 0; band < maxRotationBands; band++) {
+		bandPosition[band] = 0;
+		bandOffset[band] = 0;
+	}
+#ifdef POV_TEMPORAL_DITHER
+	numDitherPhases = 1;
+#endif  // POV_TEMPORAL_DITHER
+
+	bufferSwapPending = false;
+	displayArray = segmentArray[0];
+	drawArray = segmentArray[numSegmentBuffers - 1];
+	for (uint8_t b = 0; b < numSegmentBuffers; b++) {
+		for (uint16_t i = 0; i < maxNumSegments; i++) {
+			for (uint16_t j = 0; j < maxColumns; j++) {
+				segmentArray[b][i][j] = 0;
+			}
 		}
 	}
 	tdcInteruptVector = tdcIsrInit;
 	rpmTimer->TCTRL = 3;							// Enable PIT and interrupt
 }
 
+void TeensyPOV::resample(uint8_t logSegments) {
+	// Change the number of segments without stopping the display. Existing segment data is decimated or
+	// repeated; the rest of the current revolution runs at the new rate. Only the rescaling of the segment
+	// index, timer and TDC position is done with interrupts off, the rows are copied with them on.
+	uint32_t columns, shift;
+	uint8_t band, oldLogSegments = currentLogNumSegments;
+#ifdef POV_DOUBLE_BUFFER
+	SegmentRow *rows;
+#endif  // POV_DOUBLE_BUFFER
+
+	if (logSegments == currentLogNumSegments || logSegments > maxLogNumSegments
+			|| updateVector != paletteVector()) {
+		return;		// Truecolor frames have a fixed number of segments
+	}
+	columns = (numLeds * currentNumColorBits + bitsPerWord - 1) / bitsPerWord;
+
+#ifdef POV_DOUBLE_BUFFER
+	// Resample the frame to be shown (a pending one, else the displayed one) into the draw buffer, which
+	// isn't displayed, then swap it in along with the rescale
+	noInterrupts();
+	rows = bufferSwapPending ? drawArray : displayArray;
+	bufferSwapPending = false;
+	interrupts();
+	resampleRows(rows, drawArray, oldLogSegments, logSegments, columns);
+#endif  // POV_DOUBLE_BUFFER
+
+	noInterrupts();
+#ifdef POV_DOUBLE_BUFFER
+	rows = displayArray;
+	displayArray = drawArray;
+	drawArray = rows;
+#endif  // POV_DOUBLE_BUFFER
+	if (logSegments < currentLogNumSegments) {
+		shift = currentLogNumSegments - logSegments;
+		currentTdcDisplaySegment >>= shift;
+		updateTdcPosition >>= shift;
+		for (band = 0; band < numRotationBands; band++) {
+			bandPosition[band] >>= shift;
+			bandVelocity[band] >>= shift;
+		}
+		currentDisplaySegment >>= shift;
+		segmentTimer->LDVAL <<= shift;
+	} else {
+		shift = logSegments - currentLogNumSegments;
+		currentTdcDisplaySegment <<= shift;
+		updateTdcPosition <<= shift;
+		for (band = 0; band < numRotationBands; band++) {
+			bandPosition[band] <<= shift;
+			bandVelocity[band] *= 1L << shift;
+		}
+		currentDisplaySegment <<= shift;
+		segmentTimer->LDVAL >>= shift;
+	}
+	currentLogNumSegments = logSegments;
+	currentNumSegments = 1 << currentLogNumSegments;
+	currentSegmentMask = currentNumSegments - 1;
+	segmentsShown = 0;
+	intervalCorrection = false;
+	interrupts();
+
+	// With POV_DOUBLE_BUFFER this is the previous frame, now the draw buffer. Without it the display shows
+	// partly resampled rows until the copy is done, a fraction of a revolution.
+	resampleRows(drawArray, drawArray, oldLogSegments, logSegments, columns);
+}
+
+void TeensyPOV::resampleRows(SegmentRow *from, SegmentRow *to, uint8_t fromLog, uint8_t toLog,
+		uint32_t columns) {
+	// Decimate or repeat rows. In place (from == to) too: rows are copied in the order that reads each before
+	// it's overwritten.
+	uint32_t row, column, shift;
+
+	if (toLog < fromLog) {
+		shift = fromLog - toLog;
+		for (row = 0; row < (1UL << toLog); row++) {
+			for (column = 0; column < columns; column++) {
+				to[row][column] = from[row << shift][column];
+			}
+		}
+	} else {
+		shift = toLog - fromLog;
+		for (row = (1UL << toLog); row-- > 0;) {
+			for (column = 0; column < columns; column++) {
+				to[row][column] = from[row >> shift][column];
+			}
+		}
+	}
+}
+
 void TeensyPOV::allLedsOff() {
 	uint32_t index1;
 	for (index1 = 0; index1 < numLeds; index1++) {
 		leds[index1] = CRGB::Black;
 	}
-	FastLED.show();
+	showLeds();
 }
 
 
-void TeensyPOV::updateLeds() {
+/*
+ * At 4 and 8 color bits the palette indices sit on nibble or byte boundaries, so unpackWords() splits a whole
+ * word into one index per byte at once and adds four LEDs' palette bases with one byte-wise add (an index plus
+ * its base never exceeds 255, see buildPaletteBands()). On the Cortex-M4 these are its DSP SIMD instructions;
+ * elsewhere (the host simulator) the same operations in plain C.
+ */
+#if defined(__ARM_FEATURE_DSP)
+static inline uint32_t evenBytes(uint32_t word) {
+	// Bytes 0 and 2, zero extended to halfwords
+	uint32_t result;
+
+	__asm__("uxtb16 %0, %1" : "=r" (result) : "r" (word));
+	return result;
+}
+
+static inline uint32_t oddBytes(uint32_t word) {
+	// Bytes 1 and 3, zero extended to halfwords
+	uint32_t result;
+
+	__asm__("uxtb16 %0, %1, ror #8" : "=r" (result) : "r" (word));
+	return result;
+}
+
+static inline uint32_t lowHalves(uint32_t bottom, uint32_t top) {
+	// Low halfword of bottom, then low halfword of top
+	uint32_t result;
+
+	__asm__("pkhbt %0, %1, %2, lsl #16" : "=r" (result) : "r" (bottom), "r" (top));
+	return result;
+}
+
+static inline uint32_t highHalves(uint32_t bottom, uint32_t top) {
+	// High halfword of bottom, then high halfword of top
+	uint32_t result;
+
+	__asm__("pkhtb %0, %1, %2, asr #16" : "=r" (result) : "r" (top), "r" (bottom));
+	return result;
+}
+
+static inline uint32_t addBytes(uint32_t a, uint32_t b) {
+	uint32_t result;
+
+	__asm__("uadd8 %0, %1, %2" : "=r" (result) : "r" (a), "r" (b) : "cc");
+	return result;
+}
+#else
+static inline uint32_t evenBytes(uint32_t word) {
+	return word & 0x00FF00FF;
+}
+
+static inline uint32_t oddBytes(uint32_t word) {
+	return (word >> 8) & 0x00FF00FF;
+}
+
+static inline uint32_t lowHalves(uint32_t bottom, uint32_t top) {
+	return (bottom & 0xFFFF) | (top << 16);
+}
+
+static inline uint32_t highHalves(uint32_t bottom, uint32_t top) {
+	return (bottom >> 16) | (top & 0xFFFF0000);
+}
+
+static inline uint32_t addBytes(uint32_t a, uint32_t b) {
+	// Each byte wraps on its own, as UADD8
+	return ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+}
+#endif  // __ARM_FEATURE_DSP
+
+static inline uint32_t nibblesToBytes(uint32_t halves) {
+	// Two halfwords holding two nibbles each (evenBytes() / oddBytes() of a 4-bit word) to one nibble per byte
+	return (halves | (halves << 4)) & 0x0F0F0F0F;
+}
+
+inline void TeensyPOV::outputLed(uint32_t index, uint32_t color) {
+#ifdef POV_APA102_HDR
+	(void) index;				// Sent in order
+	apa102Word(color);
+#else
+	leds[index] = color;
+#endif  // POV_APA102_HDR
+}
+
+inline void TeensyPOV::unpackLeds(volatile uint32_t *row, uint32_t first,
+		uint32_t last, volatile uint32_t *colors) {
+	// Look up LEDs first to last - 1 of a segment row. The row's words hold a whole number of pixels.
+	uint32_t head, tail;
+
+	if (currentNumColorBits != COLOR_BITS_4 && currentNumColorBits != COLOR_BITS_8) {
+		unpackPixels(row, first, last, colors);
+		return;
+	}
+	// One at a time up to a word boundary, whole words, then the rest
+	head = (first + pixelsPerWord - 1) / pixelsPerWord * pixelsPerWord;
+	if (head > last) {
+		head = last;
+	}
+	tail = head + (last - head) / pixelsPerWord * pixelsPerWord;
+	unpackPixels(row, first, head, colors);
+	unpackWords(row, head, tail, colors);
+	unpackPixels(row, tail, last, colors);
+}
+
+inline void TeensyPOV::unpackPixels(volatile uint32_t *row, uint32_t first,
+		uint32_t last, volatile uint32_t *colors) {
+	// Any color bits, one LED per step
 	uint32_t currentWord, bitCounter;
-	uint32_t index1, index2;
-	index2 = 1;
-	currentWord = segmentArray[currentDisplaySegment][0];
-	bitCounter = bitCountLoad;
-	for (index1 = 0; index1 < numLeds; index1++) {
-		leds[index1] = colorArray[currentWord & currentColorMask];
+	uint32_t index1, index2, bit;
+
+	if (first >= last) {
+		return;
+	}
+	bit = first * currentNumColorBits;
+	index2 = bit / bitsPerWord;
+	bit %= bitsPerWord;
+	currentWord = row[index2++] >> bit;
+	bitCounter = bitCountLoad >> bit;
+	for (index1 = first; index1 < last; index1++) {
+		outputLed(index1, colors[ledPaletteBase[index1]
+				+ (currentWord & currentColorMask)]);
 		currentWord >>= currentNumColorBits;
 		bitCounter >>= currentNumColorBits;
 		if (bitCounter == 0) {
 			bitCounter = bitCountLoad;
-			currentWord = segmentArray[currentDisplaySegment][index2++];
+			currentWord = row[index2++];
+		}
+	}
+}
+
+inline void TeensyPOV::unpackWords(volatile uint32_t *row, uint32_t first,
+		uint32_t last, volatile uint32_t *colors) {
+	// 4 or 8 color bits, first and last on word boundaries: four LEDs per step
+	uint32_t index1, index2, word, indices, oddIndices, base, nextBase;
+
+	index2 = first / pixelsPerWord;
+	if (currentNumColorBits == COLOR_BITS_8) {
+		for (index1 = first; index1 < last; index1 += 4) {
+			memcpy(&base, ledPaletteBase + index1, sizeof(base));
+			indices = addBytes(row[index2++], base);
+			outputLed(index1, colors[indices & 0xFF]);
+			outputLed(index1 + 1, colors[(indices >> 8) & 0xFF]);
+			outputLed(index1 + 2, colors[(indices >> 16) & 0xFF]);
+			outputLed(index1 + 3, colors[indices >> 24]);
 		}
+		return;
 	}
+	for (index1 = first; index1 < last; index1 += 8) {
+		// Even bytes hold LEDs 0, 1, 4 and 5 of the word, odd bytes LEDs 2, 3, 6 and 7
+		word = row[index2++];
+		memcpy(&base, ledPaletteBase + index1, sizeof(base));
+		memcpy(&nextBase, ledPaletteBase + index1 + 4, sizeof(nextBase));
+		indices = addBytes(nibblesToBytes(evenBytes(word)), lowHalves(base, nextBase));
+		oddIndices = addBytes(nibblesToBytes(oddBytes(word)), highHalves(base, nextBase));
+		outputLed(index1, colors[indices & 0xFF]);
+		outputLed(index1 + 1, colors[(indices >> 8) & 0xFF]);
+		outputLed(index1 + 2, colors[oddIndices & 0xFF]);
+		outputLed(index1 + 3, colors[(oddIndices >> 8) & 0xFF]);
+		outputLed(index1 + 4, colors[(indices >> 16) & 0xFF]);
+		outputLed(index1 + 5, colors[indices >> 24]);
+		outputLed(index1 + 6, colors[(oddIndices >> 16) & 0xFF]);
+		outputLed(index1 + 7, colors[oddIndices >> 24]);
+	}
+}
+
+void TeensyPOV::updateLeds() {
+#ifdef POV_TEMPORAL_DITHER
+	volatile uint32_t *colors = activeColors;
+#else
+	volatile uint32_t *colors = currentColors;
+#endif  // POV_TEMPORAL_DITHER
+#ifdef POV_APA102_HDR
+	colors += paletteEntries;		// Encoded LED frames, see encodePalette()
+	apa102Word(0);
+#endif  // POV_APA102_HDR
+	unpackLeds(displayArray[currentDisplaySegment], 0, numLeds, colors);
+#ifdef POV_APA102_HDR
+	apa102EndFrame(numLeds);
+#else
+	FastLED.show();
+#endif  // POV_APA102_HDR
+	if (currentLogNumSegments < LOG_512_SEGMENTS) {
+		allLedsOff();
+	}
+}
+
+void TeensyPOV::updateLedsBands() {
+	// As updateLeds(), with each rotation band read from the segment at its own offset
+	uint32_t band, first, last;
+#ifdef POV_TEMPORAL_DITHER
+	volatile uint32_t *colors = activeColors;
+#else
+	volatile uint32_t *colors = currentColors;
+#endif  // POV_TEMPORAL_DITHER
+#ifdef POV_APA102_HDR
+	colors += paletteEntries;		// Encoded LED frames, see encodePalette()
+	apa102Word(0);
+#endif  // POV_APA102_HDR
+	for (band = 0; band < numRotationBands; band++) {
+		first = rotationBandStart[band];
+		last = (band + 1 < numRotationBands) ? rotationBandStart[band + 1] : numLeds;
+		if (last > numLeds) {
+			last = numLeds;
+		}
+		if (first < last) {
+			unpackLeds(displayArray[(currentDisplaySegment + bandOffset[band])
+					& currentSegmentMask], first, last, colors);
+		}
+	}
+#ifdef POV_APA102_HDR
+	apa102EndFrame(numLeds);
+#else
 	FastLED.show();
+#endif  // POV_APA102_HDR
 	if (currentLogNumSegments < LOG_512_SEGMENTS) {
 		allLedsOff();
 	}
 }
 
+void TeensyPOV::updateLedsTruecolor() {
+	// Truecolor path, no palette lookup: the segment's RGB values are copied straight to the LEDs
+	memcpy(leds, (const CRGB *) truecolorFrame + currentDisplaySegment * numLeds,
+			numLeds * sizeof(CRGB));
+	showLeds();
+	if (currentLogNumSegments < LOG_512_SEGMENTS) {
+		allLedsOff();
+	}
+}
+
+#ifdef POV_APA102_HDR
+void TeensyPOV::updateLedsApa102() {
+	// Pre-encoded frames: the segment's LED frames are sent as they are
+	const uint32_t *row = (const uint32_t *) truecolorFrame
+			+ currentDisplaySegment * numLeds;
+	uint32_t index1;
+
+	apa102Word(0);
+	for (index1 = 0; index1 < numLeds; index1++) {
+		apa102Word(row[index1]);
+	}
+	apa102EndFrame(numLeds);
+	if (currentLogNumSegments < LOG_512_SEGMENTS) {
+		allLedsOff();
+	}
+}
+#endif  // POV_APA102_HDR
+
+void TeensyPOV::showLeds() {
+	// Send leds[] to the LEDs
+#ifdef POV_APA102_HDR
+	uint32_t index1, brightness = (0xE0 | apa102Brightness) << 24;
+
+	apa102Word(0);
+	for (index1 = 0; index1 < numLeds; index1++) {
+		apa102Word(brightness | (leds[index1].b << 16) | (leds[index1].g << 8)
+				| leds[index1].r);
+	}
+	apa102EndFrame(numLeds);
+#else
+	FastLED.show();
+#endif  // POV_APA102_HDR
+}
+
 static void mainTdcISR() {
 	TeensyPOV::tdcInteruptVector();
 }
 
+uint32_t TeensyPOV::tdcCaptureLatency() {
+	// PIT ticks elapsed between the Hall edge and now
+#if defined(SIMULATE_RPM)
+	return tdcSimulator->LDVAL - tdcSimulator->CVAL;
+#elif defined(HALL_INPUT_CAPTURE)
+	return captureLatency;
+#else
+	return 0;
+#endif  // SIMULATE_RPM
+}
+
 void TeensyPOV::tdcIsrInit() {
 	// This ISR fires every time blade passes Hall detector (Top Dead Center)
 #ifdef DEBUG_MODE
 	tdcIsrFire = 2;
 #endif  // DEBUG_MODE
 
+	uint32_t currentRpmCounter, latency;
+
+	latency = tdcCaptureLatency();
+	currentRpmCounter = rpmTimer->CVAL;
 	rpmTimer->TCTRL = 0;	// Reset RPM PIT and interrupt
 	rpmTimer->TFLG = 1;
 	rpmTimer->TCTRL = 3;
 
+	// First edge after a reset only starts the measurement
+	lastRotationCount =
+			(goodRpmCount > 0) ?
+					rpmCycles - currentRpmCounter + latency - lastTdcLatency :
+					0;
+	lastTdcLatency = latency;
+
 	if (++goodRpmCount >= minGoodRpmCount) { // Confirm spinning at good RPM for several revolutions
 		tdcInteruptVector = tdcIsrActive;
 	}
@@ -376,24 +1621,163 @@ void TeensyPOV::tdcIsrActive() {
 	tdcIsrFire = 1;
 #endif  // DEBUG_MODE
 
-	uint32_t currentRpmCounter, newSegmentCounter;
+	uint32_t currentRpmCounter, newSegmentCounter, latency, period, previous;
+	uint32_t predicted, limit, firstSegmentCounter, position, phase, shortfall, segmentTicks;
+	uint16_t dropped, compressed;
 
+	latency = tdcCaptureLatency();
 	currentRpmCounter = rpmTimer->CVAL;
+
+	// Period between Hall edges, corrected for interrupt latency at both ends
+	period = rpmCycles - currentRpmCounter + latency - lastTdcLatency;
+	if (period < (lastRotationCount / 100) * glitchFilterPercent) {
+		// Too early to be a real TDC, leave the timers running
+		telemetry.glitchesRejected++;
+		return;
+	}
+
 	rpmTimer->TCTRL = 0;	// Reset RPM PIT and interrupt
 	rpmTimer->TFLG = 1;
 	rpmTimer->TCTRL = 3;
-	lastRpmTimerReading = currentRpmCounter;
-
 	segmentTimer->TCTRL = 0;
 	segmentTimer->TFLG = 1;
-	newSegmentCounter = (rpmCycles - currentRpmCounter)
-			>> currentLogNumSegments;
-	segmentTimer->LDVAL = newSegmentCounter;
+	previous = lastRotationCount;
+	lastRotationCount = period;
+	lastTdcLatency = latency;
+	revolutionCount++;
+	telemetry.revolutions++;
+	telemetry.lastCaptureLatency = latency;
+	if (latency > telemetry.maxCaptureLatency) {
+		telemetry.maxCaptureLatency = latency;
+	}
+
+	// Account for the revolution that just ended
+	if (segmentsShown > 0) {
+		dropped = currentNumSegments - segmentsShown;
+		// Segments the compression kept from being dropped: the part of the shortening the rotor really needed,
+		// in whole segments of the period it would otherwise have been timed from
+		compressed = 0;
+		segmentTicks = previous >> currentLogNumSegments;
+		if (revolutionCompression > 0 && period < previous && segmentTicks > 0) {
+			shortfall = previous - period;
+			if (shortfall > revolutionCompression) {
+				shortfall = revolutionCompression;
+			}
+			compressed = shortfall / segmentTicks;
+			if (compressed > segmentsShown) {
+				compressed = segmentsShown;
+			}
+		}
+		telemetry.lastDroppedSegments = dropped;
+		telemetry.lastCompressedSegments = compressed;
+		telemetry.droppedSegments += dropped;
+		telemetry.compressedSegments += compressed;
+	}
+
+	// Extrapolate next period assuming constant angular acceleration, limited to +/- 25%
+	predicted = period;
+	if (overrunPolicy != OVERRUN_SKIP && previous > 0) {
+		limit = period >> 2;
+		if (period + limit < previous) {
+			predicted = period - limit;
+		} else if (previous + limit < period) {
+			predicted = period + limit;
+		} else {
+			predicted = 2 * period - previous;
+		}
+	}
+	revolutionCompression = (predicted < period) ? period - predicted : 0;
+	newSegmentCounter = predicted >> currentLogNumSegments;
+
+	intervalCorrection = (overrunPolicy == OVERRUN_CORRECT)
+			&& (predicted != period);
+	if (intervalCorrection) {
+		// Segment period falls linearly through the revolution, in 1/65536 PIT ticks:
+		// step = (period - predicted) / N^2, first = predicted / N + step * (N - 1) / 2
+		segmentIntervalStep = (((int64_t) period - predicted) << 16)
+				>> (2 * currentLogNumSegments);
+		segmentInterval = (((int64_t) predicted << 16) >> currentLogNumSegments)
+				+ segmentIntervalStep * (currentNumSegments - 1) / 2;
+		newSegmentCounter = segmentInterval >> 16;
+	}
+
+	// Fractional part of TDC position shortens the first segment, shifting the whole image by a fraction of a segment.
+	// The Hall edge was 'latency' ticks ago, so take that off too.
+	position = updateTdcPosition;
+	phase = position & tdcFractionMask;
+	firstSegmentCounter = newSegmentCounter
+			- (((uint64_t) newSegmentCounter * phase) >> tdcPositionShift);
+	if (firstSegmentCounter > latency + 1) {
+		firstSegmentCounter -= latency;
+	} else {
+		firstSegmentCounter = 1;
+	}
+	segmentTimer->LDVAL = firstSegmentCounter;
 	segmentTimer->TCTRL = 3;		// Enable segment PIT and interrupt
-	currentTdcDisplaySegment = updateTdcDisplaySegment;
+	segmentTimer->LDVAL = newSegmentCounter;	// Used from next reload on
+	if (bufferSwapPending) {
+		SegmentRow *rows = displayArray;
+		displayArray = drawArray;
+		drawArray = rows;
+		bufferSwapPending = false;
+	}
+	if (paletteSwapPending) {
+		volatile uint32_t *swap = currentColors;
+		currentColors = stagedColors;
+		stagedColors = swap;
+		paletteSwapPending = false;
+	}
+	if (stagedTruecolorFrame) {
+		truecolorFrame = stagedTruecolorFrame;
+		stagedTruecolorFrame = nullptr;
+	}
+#ifdef POV_TEMPORAL_DITHER
+	// One palette plane per revolution, so the eye averages them
+	activeColors = (numDitherPhases > 1) ?
+			ditherArray[revolutionCount & (numDitherPhases - 1)] : currentColors;
+#endif  // POV_TEMPORAL_DITHER
+	for (uint8_t band = 0; band < numRotationBands; band++) {
+		bandPosition[band] += bandVelocity[band];
+		bandOffset[band] = (bandPosition[band] >> tdcPositionShift)
+				& currentSegmentMask;
+	}
+	currentTdcDisplaySegment = (position >> tdcPositionShift)
+			& currentSegmentMask;
 	currentDisplaySegment = currentTdcDisplaySegment;
-	updateLeds();	// Set LEDs per currentDisplaySegment
+	updateVector();	// Set LEDs per currentDisplaySegment
 	currentDisplaySegment = (currentDisplaySegment + 1) & currentSegmentMask;
+	segmentsShown = 1;
+
+	if (frameCallback && --frameCountdown == 0) {
+		frameCountdown = frameDivider;
+		if (frameBusy) {
+			telemetry.framesSkipped++;
+		} else {
+			frameRevolution = revolutionCount;
+			framePeriod = period;
+			NVIC_SET_PENDING(IRQ_PIT_CH0 + frameInterruptIndex);
+		}
+	}
+}
+
+void TeensyPOV::frameIsr() {
+	// Runs at frameInterruptPriority after tdcIsrActive() pends it
+	void (*callback)(uint32_t, uint32_t) = frameCallback;
+
+	uint32_t cycles;
+
+	if (callback) {
+		frameBusy = true;
+		cycles = ARM_DWT_CYCCNT;
+		callback(frameRevolution, framePeriod);
+		// Includes time spent in the segment interrupts, so compare with the revolution period
+		cycles = ARM_DWT_CYCCNT - cycles;
+		telemetry.lastFrameCycles = cycles;
+		if (cycles > telemetry.maxFrameCycles) {
+			telemetry.maxFrameCycles = cycles;
+		}
+		frameBusy = false;
+	}
 }
 
 void TeensyPOV::rpmTimerIsr() {
@@ -407,6 +1791,7 @@ void TeensyPOV::rpmTimerIsr() {
 	segmentTimer->TCTRL = 0;		 //Disable PIT
 	segmentTimer->TFLG = 1;
 	goodRpmCount = 0;
+	segmentsShown = 0;
 
 	// Turn off all LEDs
 	//allLedsOff();
@@ -415,7 +1800,7 @@ void TeensyPOV::rpmTimerIsr() {
 		leds[index] = CRGB::Black;
 	}
 	leds[numLeds - 1] = displayErrorColor;
-	FastLED.show();
+	showLeds();
 	tdcInteruptVector = tdcIsrInit;
 }
 
@@ -426,7 +1811,13 @@ void TeensyPOV::segmentTimerIsr() {
 	segmentTimerIsrFire = true;
 #endif  // DEBUG_MODE
 
-	updateLeds();	// Set LEDs per currentDisplaySegment
+	if (intervalCorrection) {
+		// Takes effect on the next PIT reload
+		segmentInterval -= segmentIntervalStep;
+		segmentTimer->LDVAL = segmentInterval >> 16;
+	}
+	updateVector();	// Set LEDs per currentDisplaySegment
+	segmentsShown++;
 	currentDisplaySegment = (currentDisplaySegment + 1) & currentSegmentMask;
 	if (currentDisplaySegment == currentTdcDisplaySegment) {
 		// Shut down PIT since tdcDisplaySegment is displayed by tdcISR()
@@ -459,6 +1850,54 @@ void pit3_isr() {
 	TeensyPOV::funct_table[3]();
 }
 
+#if defined(HALL_INPUT_CAPTURE) && !defined(SIMULATE_RPM)
+bool TeensyPOV::captureSetup(uint8_t pin) {
+	// FTM0 channel number for each Teensy 3.x pin, -1 if none
+	static const int8_t ftm0Channel[] = { -1, -1, -1, -1, -1, 7, 4, -1, -1, 2,
+			3, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 6, 0, 1 };
+	const uint8_t captureInterruptPriority = 128;
+	volatile uint32_t *pinConfig;
+	int8_t channel;
+
+	if (pin >= sizeof(ftm0Channel) / sizeof(ftm0Channel[0])) {
+		return false;
+	}
+	channel = ftm0Channel[pin];
+	if (channel < 0) {
+		return false;
+	}
+
+	// Leave FTM0 clock / MOD as set by Teensyduino so analogWrite() still works on other pins
+	captureChannel = &FTM0_C0SC + 2 * channel;	// CnSC, CnV pairs
+	captureChannel[0] = 0;
+	captureChannel[0] = FTM_CSC_ELSB | FTM_CSC_CHIE;	// Capture on falling edge
+
+	pinConfig = portConfigRegister(pin);
+	*pinConfig = PORT_PCR_MUX(4) | PORT_PCR_PE | PORT_PCR_PS;	// FTM0 alt function, pull-up
+
+	NVIC_SET_PRIORITY(IRQ_FTM0, captureInterruptPriority);
+	NVIC_ENABLE_IRQ(IRQ_FTM0);
+	return true;
+}
+
+void ftm0_isr() {
+	volatile uint32_t *channel = captureChannel;
+	uint32_t prescale, modulus, elapsed;
+
+	if (!(channel[0] & FTM_CSC_CHF)) {
+		return;
+	}
+	channel[0] &= ~FTM_CSC_CHF;
+
+	// FTM0 and the PITs both run from the bus clock
+	prescale = FTM0_SC & 0x7;
+	modulus = FTM0_MOD + 1;
+	elapsed = (FTM0_CNT + modulus - channel[1]) % modulus;
+	captureLatency = elapsed << prescale;
+	TeensyPOV::tdcInteruptVector();
+}
+#endif  // HALL_INPUT_CAPTURE
+
 #ifdef DEBUG_MODE
 void TeensyPOV::debugPrint() {
 	uint32_t localLast;
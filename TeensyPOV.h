@@ -10,7 +10,12 @@
 
 //#define SIMULATE_RPM
 //#define DEBUG_MODE
+//#define HALL_INPUT_CAPTURE
+//#define POV_DOUBLE_BUFFER
+//#define POV_TEMPORAL_DITHER
+//#define POV_APA102_HDR
 
+#include "TeensyPovProtocol.h"		// POV_MAX_LEDS, POV_MAX_LOG_SEGMENTS
 #include <Arduino.h>
 #define FASTLED_INTERNAL
 #include "FastLED.h"
@@ -28,6 +33,20 @@ struct LedArrayStruct {
 	uint32_t tdcDisplaySegment;
 };
 
+struct PovTelemetry {
+	uint32_t revolutions;
+	uint32_t glitchesRejected;
+	uint32_t lastCaptureLatency;
+	uint32_t maxCaptureLatency;
+	uint32_t droppedSegments;
+	uint32_t compressedSegments;
+	uint16_t lastDroppedSegments;
+	uint16_t lastCompressedSegments;
+	uint32_t framesSkipped;
+	uint32_t lastFrameCycles;
+	uint32_t maxFrameCycles;
+};
+
 struct DisplayStringSpec {
 	const char *characters;
 	TextPosition position;
@@ -37,8 +56,30 @@ struct DisplayStringSpec {
 	bool invert;
 };
 
+struct TextLayout {
+	// A DisplayStringSpec compiled to font columns (see TeensyPOV::compileString())
+	const char *characters;
+	uint32_t hash;				// Of the characters, placement and number of segments compiled for
+	uint16_t firstSegment;
+	uint16_t offset;			// Of the first column in the owner's column pool
+	uint16_t numColumns;
+	uint16_t capacity;			// Columns reserved in the pool
+	uint8_t topRow;
+};
+
 class TeensyPOV {
 	friend class TeensyPovDisplay;
+	friend class TeensyPovPalette;
+	friend class TeensyPovStream;
+	friend class TeensyPovCanvas;
+	friend class TeensyPovDraw;
+	friend class TeensyPovMarquee;
+	friend class TeensyPovLayer;
+	friend class TeensyPovCompositor;
+	friend class TeensyPovSprite;
+	friend class TeensyPovSpriteSet;
+	friend class TeensyPovAudio;
+	friend class TeensyPovContent;
 public:
 	static const uint8_t LOG_2_SEGMENTS = 1;
 	static const uint8_t LOG_4_SEGMENTS = 2;
@@ -55,14 +96,54 @@ public:
 	static const uint8_t COLOR_BITS_4 = 4;
 	static const uint8_t COLOR_BITS_8 = 8;
 
+	static const uint8_t maxLogNumSegments = POV_MAX_LOG_SEGMENTS;
+
+	static const uint8_t OVERRUN_SKIP = 0;
+	static const uint8_t OVERRUN_COMPRESS = 1;
+	static const uint8_t OVERRUN_CORRECT = 2;
+
 	static bool povSetup(uint8_t, CRGB *, uint8_t);
 	static bool rpmGood(void);
 	static uint16_t getNumSegments(void);
+	static uint16_t getNumPaletteEntries(void);
 	static uint32_t getLastRotationCount(void);
+	static uint32_t getRevolutionCount(void);
 	static void setPixel(uint16_t, uint16_t, uint32_t);
+	static bool setTruecolor(const CRGB *, uint8_t, uint16_t);
+	static void stageTruecolorFrame(const CRGB *);
+#ifdef POV_APA102_HDR
+	static uint32_t setApa102Spi(uint32_t);
+	static void setDimming(uint8_t);
+	static void encodeApa102(const CRGB *, uint32_t *, uint32_t);
+	static bool setApa102Frame(const uint32_t *, uint8_t, uint16_t);
+	static void stageApa102Frame(const uint32_t *);
+#endif  // POV_APA102_HDR
+	static void beginFrame(void);
+	static void endFrame(void);
+	static void setGlitchFilter(uint8_t);
+	static void setOverrunPolicy(uint8_t);
+	static void setFrameCallback(void (*)(uint32_t, uint32_t), uint8_t);
+	static bool setPaletteBands(const uint8_t *, uint8_t);
+	static bool setRotationBands(const uint8_t *, uint8_t);
+	static void setBandRotation(uint8_t, int32_t);
+	static void setBandPosition(uint8_t, uint32_t);
+	static void stagePalette(const uint32_t *);
+	static volatile uint32_t *beginPalette(void);
+	static void commitPalette(void);
+	static bool paletteStaged(void);
+	static uint32_t segmentCostTicks(uint8_t, uint32_t);
+	static uint8_t governLogNumSegments(uint8_t, uint32_t, uint8_t, uint8_t);
+	static void getTelemetry(PovTelemetry *);
+	static void clearTelemetry(void);
 	static void (*funct_table[4])();
 	static void (*tdcInteruptVector)();
 
+#ifdef POV_TEMPORAL_DITHER
+	static bool setDitherPalettes(const uint32_t * const *, uint8_t);
+	static bool loadDitherPalette(const uint16_t *, uint8_t);
+	static void stopDither(void);
+#endif  // POV_TEMPORAL_DITHER
+
 #ifdef DEBUG_MODE
 	static void debugPrint(void);
 #endif 		//DEBUG_MODE
@@ -70,16 +151,40 @@ public:
 private:
 	static void dummy_funct(void);
 	static void rpmTimerIsr(void);
+	static void frameIsr(void);
 	static void segmentTimerIsr(void);
 	static void tdcIsrInit(void);
 	static void tdcIsrActive(void);
+	static uint32_t tdcCaptureLatency(void);
 	static void updateLeds(void);
+	static void updateLedsBands(void);
+	static inline void unpackLeds(volatile uint32_t *, uint32_t, uint32_t, volatile uint32_t *);
+	static inline void unpackPixels(volatile uint32_t *, uint32_t, uint32_t, volatile uint32_t *);
+	static inline void unpackWords(volatile uint32_t *, uint32_t, uint32_t, volatile uint32_t *);
+	static inline void outputLed(uint32_t, uint32_t);
+	static void (*paletteVector(void))(void);
+	static void updateLedsTruecolor(void);
+	static bool startTruecolor(const void *, uint8_t, uint16_t, void (*)(void));
+	static void stageFrame(const void *, void (*)(void));
 	static void allLedsOff(void);
+	static void showLeds(void);
+#ifdef POV_APA102_HDR
+	static void updateLedsApa102(void);
+	static uint32_t apa102Encode(uint32_t);
+	static void encodePalette(volatile uint32_t *);
+#endif  // POV_APA102_HDR
 	static void loadPattern(const LedArrayStruct *);
 	static void loadColors(const uint32_t *);
 	static void setParameters(uint8_t, uint8_t, uint16_t);
+	static void resample(uint8_t);
+	static void buildPaletteBands(void);
+	static void requestSwap(bool, bool);
 	static void loadString(const char *, TextPosition, uint8_t, uint8_t,
 			uint8_t, bool);
+	static uint32_t stringHash(const DisplayStringSpec *);
+	static bool compileString(const DisplayStringSpec *, TextLayout *, uint8_t *,
+			uint16_t);
+	static void drawLayout(const TextLayout *, const uint8_t *, uint8_t, uint8_t);
 
 #ifndef SIMULATE_RPM
 	static const uint32_t maxRevolutionPeriod = 100000UL; // Only run LEDs when > 10 revs / sec (600 RPM)
@@ -90,22 +195,62 @@ private:
 	static const uint32_t rpmCycles = (F_BUS / 1000000UL) * maxRevolutionPeriod
 			- 1;
 
-	static const uint32_t maxNumLeds = 48;
+	static const uint32_t maxNumLeds = POV_MAX_LEDS;
 	static const uint32_t maxNumColorBits = COLOR_BITS_8;
+	static const uint32_t paletteEntries = 1 << maxNumColorBits;
+#ifdef POV_APA102_HDR
+	static const uint32_t paletteWords = 2 * paletteEntries;	// RGB, then the same colors encoded as APA102 LED frames
+	static const uint32_t apa102DefaultSpiRate = 12000000;
+#else
+	static const uint32_t paletteWords = paletteEntries;
+#endif  // POV_APA102_HDR
 	static const uint32_t bitCountLoad = 0x80000000;
-	static const uint32_t maxNumSegments = 1 << LOG_512_SEGMENTS;
+	static const uint32_t maxNumSegments = 1 << maxLogNumSegments;
 	static const uint32_t bitsPerSegment = maxNumLeds * maxNumColorBits;
 	static const uint32_t bitsPerWord = 32;
-	static const uint32_t maxColumns = (bitsPerSegment / bitsPerWord);
-	static const uint8_t maxTextChars = maxNumSegments / (2 * 7);
+	static const uint32_t maxColumns = (bitsPerSegment + bitsPerWord - 1) / bitsPerWord;
+	static_assert(POV_MAX_LEDS > 0 && POV_MAX_LEDS < 256, "POV_MAX_LEDS must be 1 - 255");
+	static_assert(POV_MAX_LOG_SEGMENTS >= LOG_2_SEGMENTS && POV_MAX_LOG_SEGMENTS <= LOG_512_SEGMENTS,
+			"POV_MAX_LOG_SEGMENTS must be 1 - 9");
+	static const uint8_t charColumns = 7;			// Blank, 5 font columns, blank
+	static const uint8_t maxTextChars = maxNumSegments / (2 * charColumns);
+#ifdef POV_DOUBLE_BUFFER
+	static const uint8_t numSegmentBuffers = 2;
+#else
+	static const uint8_t numSegmentBuffers = 1;
+#endif  // POV_DOUBLE_BUFFER
 	static const uint8_t minGoodRpmCount = 2;
+	static const uint8_t maxPaletteBands = 16;
+	static const uint8_t maxRotationBands = 8;
+	static const uint8_t frameInterruptIndex = 2;	// PIT channel 2 IRQ, pended by software
+	static const uint8_t frameInterruptPriority = 192;
+	static const uint8_t tdcPositionShift = 16;
+	static const uint32_t tdcFractionMask = (1UL << tdcPositionShift) - 1;
+
+	// updateLeds() cost model used by the resolution governor, in CPU cycles
+	static const uint32_t isrOverheadCycles = 150;
+	static const uint32_t ledUnpackCycles = 14;
+	static const uint32_t ledLookupCycles = 9;		// 4 and 8 color bits, see unpackWords()
+	static const uint32_t wordLoadCycles = 4;
+	static const uint32_t bandSetupCycles = 12;
 
 	static uint8_t pixelsPerWord;
+	static uint8_t numPaletteBands;
+	static uint8_t paletteBandStart[maxPaletteBands];
+	static uint8_t ledPaletteBase[maxNumLeds];
+	volatile static uint8_t numRotationBands;
+	static uint8_t rotationBandStart[maxRotationBands];
+	volatile static int32_t bandVelocity[maxRotationBands];	// 1/65536 segment per revolution
+	volatile static uint32_t bandPosition[maxRotationBands];	// Segment (upper 16 bits) and fraction, as updateTdcPosition
+	volatile static uint16_t bandOffset[maxRotationBands];		// Whole segments, read by updateLedsBands()
 	static uint32_t numLeds;
 	static CRGB *leds;
 
 	static KINETISK_PIT_CHANNEL_t *rpmTimer;
 	static KINETISK_PIT_CHANNEL_t *segmentTimer;
+#if defined(HALL_INPUT_CAPTURE) && !defined(SIMULATE_RPM)
+	static bool captureSetup(uint8_t);
+#endif  // HALL_INPUT_CAPTURE
 #ifdef SIMULATE_RPM
 	static const uint32_t tdcSimulatorCycles = (F_BUS / 1000000UL) * 50000UL
 			- 1;
@@ -113,18 +258,57 @@ private:
 #endif  // SIMULATE_RPM
 
 	volatile static uint8_t currentLogNumSegments;
-	volatile static uint32_t segmentArray[maxNumSegments][maxColumns];
-	volatile static uint32_t colorArray[1 << maxNumColorBits];
+	typedef volatile uint32_t SegmentRow[maxColumns];
+	static void resampleRows(SegmentRow *, SegmentRow *, uint8_t, uint8_t, uint32_t);
+	volatile static uint32_t segmentArray[numSegmentBuffers][maxNumSegments][maxColumns];
+	static SegmentRow * volatile displayArray;		// Read by updateLeds()
+	static SegmentRow * volatile drawArray;			// Written by setPixel(), loadPattern(), etc.
+	volatile static bool bufferSwapPending;
+	volatile static uint32_t colorArray[2][paletteWords];
+	static volatile uint32_t * volatile currentColors;
+	static volatile uint32_t * volatile stagedColors;
+	volatile static bool paletteSwapPending;
+	static void (* volatile updateVector)(void);		// updateLeds(), updateLedsBands(), updateLedsTruecolor() or updateLedsApa102()
+	static const void * volatile truecolorFrame;		// CRGB or encoded APA102 rows, per updateVector
+	static const void * volatile stagedTruecolorFrame;
+#ifdef POV_APA102_HDR
+	static uint32_t apa102SpiRate;
+	volatile static uint8_t dimLevel;
+	volatile static uint32_t apa102Brightness;		// Brightness field for showLeds(), follows dimLevel
+#endif  // POV_APA102_HDR
+#ifdef POV_TEMPORAL_DITHER
+	static const uint8_t maxDitherPhases = 4;
+	volatile static uint32_t ditherArray[maxDitherPhases][paletteWords];
+	static volatile uint32_t * volatile activeColors;	// Read by updateLeds(), chosen each TDC
+	volatile static uint8_t numDitherPhases;
+#endif  // POV_TEMPORAL_DITHER
+	volatile static uint32_t revolutionCount;
+	static void (* volatile frameCallback)(uint32_t, uint32_t);
+	volatile static uint8_t frameDivider;
+	volatile static uint8_t frameCountdown;
+	volatile static bool frameBusy;
+	volatile static uint32_t frameRevolution;
+	volatile static uint32_t framePeriod;
 	volatile static uint32_t currentNumColorBits;
+	volatile static uint32_t currentNumPaletteEntries;
 	volatile static uint32_t currentNumSegments;
 	volatile static uint32_t currentSegmentMask;
 	volatile static uint32_t currentColorMask;
 	volatile static uint32_t goodRpmCount;
 	volatile static uint32_t currentDisplaySegment;
 	volatile static uint32_t currentTdcDisplaySegment;
-	volatile static uint32_t updateTdcDisplaySegment;
-	volatile static uint32_t lastRpmTimerReading;
+	volatile static uint32_t updateTdcPosition;		// Segment (upper 16 bits) and fraction of segment (lower 16 bits)
+	volatile static uint32_t lastRotationCount;
+	volatile static uint8_t overrunPolicy;
+	volatile static uint16_t segmentsShown;
+	volatile static uint32_t revolutionCompression;		// PIT ticks taken off the measured period
+	volatile static bool intervalCorrection;
+	volatile static int64_t segmentInterval;
+	volatile static int64_t segmentIntervalStep;
+	volatile static uint32_t lastTdcLatency;
+	volatile static uint8_t glitchFilterPercent;
 	volatile static uint8_t hallPin;
+	volatile static PovTelemetry telemetry;
 #ifdef DEBUG_MODE
 	volatile static bool segmentTimerIsrFire;
 	volatile static bool rpmTimerIsrFire;
@@ -0,0 +1,342 @@
+/*
+ * TeensyPovAudio.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovAudio.h"
+#include "TeensyPovDraw.h"
+
+/*
+ * Samples are taken by ADC0, triggered by the Programmable Delay Block at a fixed rate, into a ring buffer.
+ * Once per revolution (frame callback, below the segment timing in priority) the latest 256 samples are
+ * analyzed by TeensyPovFft and drawn. Only the part of each bar that changed length is written, a run of
+ * packed words at a time by TeensyPovDraw, so drawing costs little next to the FFT.
+ */
+
+TeensyPovAudio * volatile TeensyPovAudio::active = nullptr;
+
+TeensyPovAudio::TeensyPovAudio(uint8_t numBands, uint8_t drawStyle) :
+		fft(numBands) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	uint8_t numBands -- 1, 2, 4, 8 or 16 frequency bands.
+	 *
+	 * 	uint8_t drawStyle -- BARS or RINGS.
+	 */
+	style = drawStyle;
+	memset((void *) ring, 0, sizeof(ring));
+	memset(height, 0, sizeof(height));
+	memset(peak, 0, sizeof(peak));
+	memset(peakTimer, 0, sizeof(peakTimer));
+	memset((void *) &stats, 0, sizeof(stats));
+}
+
+bool TeensyPovAudio::begin(uint8_t pin, uint32_t sampleRate) {
+	/*
+	 * Sample an analog input. Only one TeensyPovAudio object can sample at a time.
+	 * Parameters:
+	 * 	uint8_t pin -- A0 - A9 (pins 14 - 23), biased to mid supply.
+	 *
+	 * 	uint32_t sampleRate -- Samples per second, e.g. 8000 (bands then reach 4 kHz). At least F_BUS / 65536.
+	 *
+	 * Returns:
+	 * 	false if the pin or rate isn't supported.
+	 */
+	// ADC0 channel of A0 - A9, as the Teensy 3.x core's pin2sc1a table
+	static const uint8_t adcChannel[] = { 5, 14, 8, 9, 13, 12, 6, 7, 15, 4 };
+	uint32_t modulus;
+
+	if (pin < 14 || pin > 23 || sampleRate == 0) {
+		return false;
+	}
+	modulus = F_BUS / sampleRate;
+	if (modulus == 0 || modulus > 65536) {
+		return false;
+	}
+	end();
+	active = this;
+
+	// Let the core calibrate ADC0 and set up the pin, then hand conversions over to the PDB
+	analogReadResolution(12);
+	analogRead(pin);
+	SIM_SCGC6 |= SIM_SCGC6_PDB;
+	PDB0_MOD = modulus - 1;
+	PDB0_IDLY = 0;
+	PDB0_CH0C1 = PDB_CH0C1_TOS(1) | PDB_CH0C1_EN(1);
+	PDB0_SC = PDB_SC_TRGSEL(15) | PDB_SC_PDBEN | PDB_SC_CONT | PDB_SC_LDOK;
+	ADC0_SC2 |= ADC_SC2_ADTRG;
+	ADC0_SC1A = ADC_SC1_AIEN | adcChannel[pin - 14];
+	// Through the RAM vector table, so sketches using adc0_isr() for something else still link
+	attachInterruptVector(IRQ_ADC0, adcIsr);
+	NVIC_SET_PRIORITY(IRQ_ADC0, adcInterruptPriority);
+	NVIC_ENABLE_IRQ(IRQ_ADC0);
+	PDB0_SC |= PDB_SC_SWTRIG;
+	return true;
+}
+
+void TeensyPovAudio::end() {
+	/*
+	 * Stop sampling, leaving ADC0 to analogRead().
+	 */
+	if (active != this || !(SIM_SCGC6 & SIM_SCGC6_PDB)) {
+		return;
+	}
+	NVIC_DISABLE_IRQ(IRQ_ADC0);
+	PDB0_SC = 0;
+	ADC0_SC2 &= ~ADC_SC2_ADTRG;
+	ADC0_SC1A = 0x1F;				// Conversions off
+}
+
+void TeensyPovAudio::adcIsr() {
+	TeensyPovAudio *audio = active;
+	int16_t sample = ((int16_t) ADC0_RA - 2048) << 4;	// 12 bit unsigned to Q15
+
+	if (audio) {
+		audio->ring[audio->ringHead] = sample;
+		audio->ringHead = (audio->ringHead + 1) & (ringSize - 1);
+		audio->stats.samples++;
+	}
+}
+
+void TeensyPovAudio::push(const int16_t *samples, uint16_t n) {
+	/*
+	 * Add samples from another source instead of begin(), e.g. decoded audio.
+	 * Parameters:
+	 * 	const int16_t *samples -- Signed samples, oldest first.
+	 *
+	 * 	uint16_t n -- Number of samples.
+	 */
+	while (n--) {
+		ring[ringHead] = *samples++;
+		ringHead = (ringHead + 1) & (ringSize - 1);
+		stats.samples++;
+	}
+}
+
+void TeensyPovAudio::setLeds(uint8_t first, uint8_t last) {
+	/*
+	 * Draw between LEDs first and last (0 = innermost). The default is the whole blade.
+	 */
+	firstLed = first;
+	lastLed = last;
+	redraw();
+}
+
+void TeensyPovAudio::setColors(uint8_t bar, uint8_t peakMarker, uint8_t background) {
+	/*
+	 * Parameters:
+	 * 	uint8_t bar, peakMarker, background -- Colors expressed as index into current Palette. RINGS uses
+	 * 		background below the floor level and palette entries 1 and up as a ramp from quiet to loud.
+	 */
+	barColor = bar;
+	peakColor = peakMarker;
+	backgroundColor = background;
+	redraw();
+}
+
+void TeensyPovAudio::setRange(uint8_t floor, uint8_t span) {
+	/*
+	 * Parameters:
+	 * 	uint8_t floor -- Band level (see TeensyPovFft::logLevel()) drawn as nothing. Default 40.
+	 *
+	 * 	uint8_t span -- Levels above floor for a full length bar or the top color. Default 64 (48 dB).
+	 */
+	floorLevel = floor;
+	spanLevels = span ? span : 1;
+}
+
+void TeensyPovAudio::start() {
+	/*
+	 * Analyze and draw once per revolution from the frame callback. Only one TeensyPovAudio object can be started.
+	 */
+	active = this;
+	redraw();
+	TeensyPOV::setFrameCallback(frameCallback, 1);
+}
+
+void TeensyPovAudio::stop() {
+	if (TeensyPOV::frameCallback == frameCallback) {
+		TeensyPOV::setFrameCallback(nullptr, 1);
+	}
+}
+
+void TeensyPovAudio::frameCallback(uint32_t, uint32_t) {
+	TeensyPovAudio *audio = active;
+
+	if (audio) {
+		audio->update();
+	}
+}
+
+void TeensyPovAudio::redraw() {
+	/*
+	 * Draw everything again at the next update(), e.g. after something else has drawn over the bars.
+	 */
+	drawnLogNumSegments = 0;
+}
+
+const uint8_t *TeensyPovAudio::getLevels() {
+	/*
+	 * Returns:
+	 * 	Band levels from the last update() (see TeensyPovFft::logLevel()).
+	 */
+	return fft.getLevels();
+}
+
+uint8_t TeensyPovAudio::getNumBands() {
+	return fft.getNumBands();
+}
+
+void TeensyPovAudio::getStats(AudioStats *ptr) {
+	/*
+	 * Get the cost of the last update in CPU cycles (including time spent in the segment interrupts meanwhile).
+	 */
+	noInterrupts();
+	ptr->analyzeCycles = stats.analyzeCycles;
+	ptr->drawCycles = stats.drawCycles;
+	ptr->maxCycles = stats.maxCycles;
+	ptr->samples = stats.samples;
+	ptr->updates = stats.updates;
+	interrupts();
+}
+
+void TeensyPovAudio::update() {
+	/*
+	 * Analyze the latest 256 samples and draw them, wrapped in beginFrame() / endFrame(). Called once per
+	 * revolution after start(), or call it yourself.
+	 */
+	uint32_t startCycles = ARM_DWT_CYCCNT, analyzedCycles, doneCycles;
+	uint16_t index, head = ringHead;
+
+	for (index = 0; index < TeensyPovFft::size; index++) {
+		window[index] = ring[(head - TeensyPovFft::size + index) & (ringSize - 1)];
+	}
+	fft.analyze(window);
+	levelsToHeights();
+	analyzedCycles = ARM_DWT_CYCCNT;
+
+	TeensyPOV::beginFrame();
+	if (style == RINGS) {
+		drawRings();
+	} else {
+		drawBars();
+	}
+	TeensyPOV::endFrame();
+	doneCycles = ARM_DWT_CYCCNT;
+
+	stats.analyzeCycles = analyzedCycles - startCycles;
+	stats.drawCycles = doneCycles - analyzedCycles;
+	if (doneCycles - startCycles > stats.maxCycles) {
+		stats.maxCycles = doneCycles - startCycles;
+	}
+	stats.updates++;
+}
+
+void TeensyPovAudio::levelsToHeights() {
+	// Bars jump up and fall one LED per update; peak markers hold, then fall
+	const uint8_t *levels = fft.getLevels();
+	uint8_t numBands = fft.getNumBands(), band, target, length;
+	uint8_t last = min((uint32_t) lastLed, TeensyPOV::numLeds - 1);
+	uint16_t numColors = 1 << TeensyPOV::currentNumColorBits;
+
+	length = (last >= firstLed) ? last - firstLed + 1 : 0;
+	for (band = 0; band < numBands; band++) {
+		if (levels[band] <= floorLevel) {
+			target = 0;
+		} else if (style == RINGS) {
+			target = min((uint32_t) (levels[band] - floorLevel) * (numColors - 1)
+					/ spanLevels, numColors - 1UL);
+		} else {
+			target = min((uint32_t) (levels[band] - floorLevel) * length
+					/ spanLevels, (uint32_t) length);
+		}
+		if (style == RINGS || target >= height[band]) {
+			height[band] = target;
+		} else {
+			height[band]--;
+		}
+		if (height[band] >= peak[band]) {
+			peak[band] = height[band];
+			peakTimer[band] = peakHold;
+		} else if (peakTimer[band] > 0) {
+			peakTimer[band]--;
+		} else {
+			peak[band]--;
+		}
+	}
+}
+
+void TeensyPovAudio::drawBars() {
+	uint8_t numBands = fft.getNumBands(), band, oldHeight, newHeight, length;
+	uint8_t last = min((uint32_t) lastLed, TeensyPOV::numLeds - 1);
+	uint16_t width = TeensyPOV::currentNumSegments / numBands, gap, first, end;
+
+	if (width < 2 || last < firstLed) {
+		return;
+	}
+	length = last - firstLed + 1;
+	gap = max(width / 4, 1);
+	if (drawnLogNumSegments != TeensyPOV::currentLogNumSegments) {
+		TeensyPovDraw::sector(0, TeensyPOV::currentNumSegments - 1, firstLed, last,
+				backgroundColor);
+		memset(drawnHeight, 0, sizeof(drawnHeight));
+		memset(drawnPeak, 0, sizeof(drawnPeak));
+		drawnLogNumSegments = TeensyPOV::currentLogNumSegments;
+	}
+
+	for (band = 0; band < numBands; band++) {
+		first = band * width;
+		end = first + width - gap - 1;
+		oldHeight = min(drawnHeight[band], length);
+		newHeight = min(height[band], length);
+		if (newHeight > oldHeight) {
+			TeensyPovDraw::sector(first, end, firstLed + oldHeight,
+					firstLed + newHeight - 1, barColor);
+		} else if (newHeight < oldHeight) {
+			TeensyPovDraw::sector(first, end, firstLed + newHeight,
+					firstLed + oldHeight - 1, backgroundColor);
+		}
+		drawnHeight[band] = newHeight;
+
+		// Peak marker on the top LED of the recent highest bar, shown while it is above the bar
+		if (drawnPeak[band] != peak[band] || newHeight != oldHeight) {
+			if (drawnPeak[band] != peak[band] && drawnPeak[band] > newHeight
+					&& drawnPeak[band] <= length) {
+				TeensyPovDraw::sector(first, end, firstLed + drawnPeak[band] - 1,
+						firstLed + drawnPeak[band] - 1, backgroundColor);
+			}
+			if (peak[band] > newHeight && peak[band] <= length) {
+				TeensyPovDraw::sector(first, end, firstLed + peak[band] - 1,
+						firstLed + peak[band] - 1, peakColor);
+			}
+			drawnPeak[band] = peak[band];
+		}
+	}
+}
+
+void TeensyPovAudio::drawRings() {
+	uint8_t numBands = fft.getNumBands(), band, width, color;
+	uint8_t last = min((uint32_t) lastLed, TeensyPOV::numLeds - 1);
+
+	if (last < firstLed) {
+		return;
+	}
+	width = (last - firstLed + 1) / numBands;
+	if (width == 0) {
+		return;
+	}
+	if (drawnLogNumSegments != TeensyPOV::currentLogNumSegments) {
+		memset(drawnHeight, 0xFF, sizeof(drawnHeight));
+		drawnLogNumSegments = TeensyPOV::currentLogNumSegments;
+	}
+	for (band = 0; band < numBands; band++) {
+		if (height[band] != drawnHeight[band]) {
+			color = height[band] ? height[band] : backgroundColor;
+			TeensyPovDraw::ring(firstLed + band * width, color, width);
+			drawnHeight[band] = height[band];
+		}
+	}
+}
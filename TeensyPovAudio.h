@@ -0,0 +1,71 @@
+/*
+ * TeensyPovAudio.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVAUDIO_H_
+#define TEENSYPOVAUDIO_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+#include "TeensyPovFft.h"
+
+struct AudioStats {
+	uint32_t analyzeCycles;			// Last FFT and band levels
+	uint32_t drawCycles;			// Last drawing
+	uint32_t maxCycles;				// Longest update()
+	uint32_t samples;				// Samples received
+	uint32_t updates;
+};
+
+class TeensyPovAudio {
+	friend class TeensyPovDisplay;
+	friend class TeensyPovContent;
+private:
+	static const uint16_t ringSize = 2 * TeensyPovFft::size;	// Power of 2
+	static const uint8_t adcInterruptPriority = 160;		// Below the segment timer, above frame callbacks
+	static TeensyPovAudio * volatile active;				// Owner of the ADC and the frame callback
+	TeensyPovFft fft;
+	volatile int16_t ring[ringSize];
+	volatile uint16_t ringHead = 0;
+	int16_t window[TeensyPovFft::size];
+	uint8_t style;
+	uint8_t firstLed = 0, lastLed = 255;
+	uint8_t barColor = 1, peakColor = 2, backgroundColor = 0;
+	uint8_t floorLevel = 40, spanLevels = 64;
+	uint8_t peakHold = 8;
+	uint8_t height[TeensyPovFft::maxBands];			// Bar length in LEDs, or ring color
+	uint8_t peak[TeensyPovFft::maxBands];
+	uint8_t peakTimer[TeensyPovFft::maxBands];
+	uint8_t drawnHeight[TeensyPovFft::maxBands];
+	uint8_t drawnPeak[TeensyPovFft::maxBands];
+	uint8_t drawnLogNumSegments = 0;
+	volatile AudioStats stats;
+	void levelsToHeights(void);
+	void drawBars(void);
+	void drawRings(void);
+	static void frameCallback(uint32_t, uint32_t);
+	static void adcIsr(void);
+
+public:
+	static const uint8_t BARS = 0;			// A radial bar per band around the display
+	static const uint8_t RINGS = 1;			// A ring per band, colored by level
+	TeensyPovAudio(uint8_t = TeensyPovFft::maxBands, uint8_t = BARS);
+	bool begin(uint8_t, uint32_t);
+	void end(void);
+	void push(const int16_t *, uint16_t);
+	void setLeds(uint8_t, uint8_t);
+	void setColors(uint8_t, uint8_t, uint8_t);
+	void setRange(uint8_t, uint8_t);
+	void start(void);
+	void stop(void);
+	void update(void);
+	void redraw(void);
+	const uint8_t *getLevels(void);
+	uint8_t getNumBands(void);
+	void getStats(AudioStats *);
+};
+
+#endif /* TEENSYPOVAUDIO_H_ */
@@ -0,0 +1,325 @@
+/*
+ * TeensyPovCanvas.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovCanvas.h"
+
+/*
+ * Lookup table layout (user supplied buffer, see lutBytes()), for the first quarter of the segments
+ * after Top Dead Center only. The other three quarters are the same points rotated 90, 180 and 270
+ * degrees about the canvas center, which is exact on a square pixel grid.
+ * 	Per segment:  bounding box (4 bytes): min x, max x, min y, max y
+ * 	Then per segment, per LED (2 bytes): x, y
+ * Coordinates are doubled and relative to the canvas center: u = 2 * x - (size - 1), so they fit an
+ * int8_t for canvases up to 128 x 128 and rotate without rounding.
+ */
+
+TeensyPovCanvas::TeensyPovCanvas(uint8_t *buffer, uint8_t canvasSize,
+		int8_t *table, uint32_t tableBytes, uint8_t inner) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	uint8_t *buffer -- Pixels, canvasSize * canvasSize palette indexes, row by row from the top left. The
+	 * 		array pointed to must be static or global.
+	 *
+	 * 	uint8_t canvasSize -- Width and height of the canvas, 1 to 128. The display's circle touches the edges.
+	 *
+	 * 	int8_t *table -- Lookup table storage, at least lutBytes(log number of segments, number of LEDs) bytes.
+	 * 		The array pointed to must be static or global.
+	 *
+	 * 	uint32_t tableBytes -- Size of table.
+	 *
+	 * 	uint8_t inner -- Radius of the innermost LED, in LED spacings.
+	 */
+	pixels = buffer;
+	size = (canvasSize > 128) ? 128 : canvasSize;
+	lut = table;
+	lutCapacity = tableBytes;
+	innerRadius = inner;
+	invalidate();
+}
+
+uint8_t TeensyPovCanvas::getSize() {
+	return size;
+}
+
+uint8_t *TeensyPovCanvas::getBuffer() {
+	/*
+	 * Direct access to the pixels, e.g. for blitting. Call invalidate() for the area changed.
+	 */
+	return pixels;
+}
+
+uint8_t TeensyPovCanvas::getPixel(uint8_t x, uint8_t y) {
+	if (x >= size || y >= size) {
+		return 0;
+	}
+	return pixels[y * size + x];
+}
+
+void TeensyPovCanvas::setPixel(uint8_t x, uint8_t y, uint8_t color) {
+	/*
+	 * Parameters:
+	 * 	uint8_t x, y -- Position, (0, 0) is top left. Top is Top Dead Center.
+	 *
+	 * 	uint8_t color -- Color expressed as index into current Palette.
+	 */
+	if (x >= size || y >= size) {
+		return;
+	}
+	pixels[y * size + x] = color;
+	markDirty(x, y, x, y);
+}
+
+void TeensyPovCanvas::fill(uint8_t color) {
+	memset(pixels, color, size * size);
+	invalidate();
+}
+
+void TeensyPovCanvas::fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h,
+		uint8_t color) {
+	uint8_t x1, y1, row;
+
+	if (x >= size || y >= size || w == 0 || h == 0) {
+		return;
+	}
+	x1 = (w > size - x) ? size - 1 : x + w - 1;
+	y1 = (h > size - y) ? size - 1 : y + h - 1;
+	for (row = y; row <= y1; row++) {
+		memset(pixels + row * size + x, color, x1 - x + 1);
+	}
+	markDirty(x, y, x1, y1);
+}
+
+void TeensyPovCanvas::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
+		uint8_t color) {
+	// Bresenham
+	int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+	int16_t sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+	int16_t error = dx + dy, x = x0, y = y0, e2;
+
+	for (;;) {
+		if (x < size && y < size) {
+			pixels[y * size + x] = color;
+		}
+		if (x == x1 && y == y1) {
+			break;
+		}
+		e2 = 2 * error;
+		if (e2 >= dy) {
+			error += dy;
+			x += sx;
+		}
+		if (e2 <= dx) {
+			error += dx;
+			y += sy;
+		}
+	}
+	markDirty(min(x0, x1), min(y0, y1), max(x0, x1), max(y0, y1));
+}
+
+void TeensyPovCanvas::invalidate(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+	/*
+	 * Mark an area changed through getBuffer() so the next flush() resolves it.
+	 */
+	if (x >= size || y >= size || w == 0 || h == 0) {
+		return;
+	}
+	markDirty(x, y, (w > size - x) ? size - 1 : x + w - 1,
+			(h > size - y) ? size - 1 : y + h - 1);
+}
+
+void TeensyPovCanvas::invalidate() {
+	numDirty = 0;
+	markDirty(0, 0, size - 1, size - 1);
+}
+
+void TeensyPovCanvas::markDirty(uint8_t x0, uint8_t y0, uint8_t x1,
+		uint8_t y1) {
+	// Adds to the dirty list. When full, merges with the rectangle whose area grows least.
+	uint32_t growth, bestGrowth = UINT32_MAX;
+	uint8_t index, best = 0;
+	DirtyRect merged;
+
+	for (index = 0; index < numDirty; index++) {
+		if (x0 >= dirty[index].x0 && x1 <= dirty[index].x1
+				&& y0 >= dirty[index].y0 && y1 <= dirty[index].y1) {
+			return;
+		}
+	}
+	if (numDirty < maxDirtyRects) {
+		dirty[numDirty++] = {x0, y0, x1, y1};
+		return;
+	}
+	for (index = 0; index < numDirty; index++) {
+		merged.x0 = min(x0, dirty[index].x0);
+		merged.y0 = min(y0, dirty[index].y0);
+		merged.x1 = max(x1, dirty[index].x1);
+		merged.y1 = max(y1, dirty[index].y1);
+		growth = (merged.x1 - merged.x0 + 1) * (merged.y1 - merged.y0 + 1)
+				- (dirty[index].x1 - dirty[index].x0 + 1)
+						* (dirty[index].y1 - dirty[index].y0 + 1);
+		if (growth < bestGrowth) {
+			bestGrowth = growth;
+			best = index;
+		}
+	}
+	dirty[best].x0 = min(x0, dirty[best].x0);
+	dirty[best].y0 = min(y0, dirty[best].y0);
+	dirty[best].x1 = max(x1, dirty[best].x1);
+	dirty[best].y1 = max(y1, dirty[best].y1);
+}
+
+bool TeensyPovCanvas::buildLut() {
+	// Once per configuration, the only place floating point is used
+	uint16_t quarter = TeensyPOV::currentNumSegments / 4, segment;
+	uint8_t numLeds = TeensyPOV::numLeds, led;
+	int8_t *box, *point;
+	float center = (size - 1) / 2.0f;
+	float scale = size / 2.0f / (innerRadius + numLeds);
+	float angle, radius;
+	int16_t x, y;
+
+	if (quarter == 0 || size == 0
+			|| lutBytes(TeensyPOV::currentLogNumSegments, numLeds) > lutCapacity) {
+		lutNumLeds = 0;
+		return false;
+	}
+	for (segment = 0; segment < quarter; segment++) {
+		box = lut + 4 * segment;
+		point = lut + 4 * quarter + 2 * numLeds * segment;
+		box[0] = box[2] = 127;
+		box[1] = box[3] = -128;
+		angle = 2.0f * PI * segment / TeensyPOV::currentNumSegments;
+		for (led = 0; led < numLeds; led++) {
+			radius = (innerRadius + led + 0.5f) * scale;
+			x = lroundf(center + radius * sinf(angle));
+			y = lroundf(center - radius * cosf(angle));
+			x = constrain(x, (int16_t) 0, (int16_t) (size - 1));
+			y = constrain(y, (int16_t) 0, (int16_t) (size - 1));
+			point[0] = 2 * x - (size - 1);
+			point[1] = 2 * y - (size - 1);
+			box[0] = min(box[0], point[0]);
+			box[1] = max(box[1], point[0]);
+			box[2] = min(box[2], point[1]);
+			box[3] = max(box[3], point[1]);
+			point += 2;
+		}
+	}
+	lutLogNumSegments = TeensyPOV::currentLogNumSegments;
+	lutNumLeds = numLeds;
+	return true;
+}
+
+static inline void rotate(uint8_t quadrant, int8_t u, int8_t v, int16_t *x,
+		int16_t *y) {
+	// Clockwise by quadrant * 90 degrees, in doubled center-relative coordinates (y down)
+	switch (quadrant) {
+	case 0:
+		*x = u;
+		*y = v;
+		break;
+	case 1:
+		*x = -v;
+		*y = u;
+		break;
+	case 2:
+		*x = -u;
+		*y = -v;
+		break;
+	default:
+		*x = v;
+		*y = -u;
+		break;
+	}
+}
+
+bool TeensyPovCanvas::segmentDirty(uint8_t quadrant, const int8_t *box) {
+	int16_t ax, ay, bx, by, x0, x1, y0, y1;
+	uint8_t index;
+
+	rotate(quadrant, box[0], box[2], &ax, &ay);
+	rotate(quadrant, box[1], box[3], &bx, &by);
+	x0 = (min(ax, bx) + size - 1) >> 1;
+	x1 = (max(ax, bx) + size - 1) >> 1;
+	y0 = (min(ay, by) + size - 1) >> 1;
+	y1 = (max(ay, by) + size - 1) >> 1;
+	for (index = 0; index < numDirty; index++) {
+		if (x0 <= dirty[index].x1 && x1 >= dirty[index].x0
+				&& y0 <= dirty[index].y1 && y1 >= dirty[index].y0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TeensyPovCanvas::resolveSegment(uint16_t segment, uint8_t quadrant,
+		const int8_t *point) {
+	// Rebuild one segment's packed words from the canvas
+	uint32_t words[TeensyPOV::maxColumns] = { 0 };
+	uint32_t colorMask = TeensyPOV::currentColorMask;
+	uint8_t bits = TeensyPOV::currentNumColorBits;
+	uint8_t shift = 0, column = 0, led;
+	int16_t x, y;
+
+	for (led = 0; led < lutNumLeds; led++, point += 2) {
+		rotate(quadrant, point[0], point[1], &x, &y);
+		words[column] |= (pixels[((y + size - 1) >> 1) * size
+				+ ((x + size - 1) >> 1)] & colorMask) << shift;
+		shift += bits;
+		if (shift == 32) {
+			shift = 0;
+			column++;
+		}
+	}
+	if (shift != 0) {
+		column++;
+	}
+	for (led = 0; led < column; led++) {
+		TeensyPOV::drawArray[segment][led] = words[led];
+	}
+}
+
+bool TeensyPovCanvas::flush() {
+	/*
+	 * Resolve the areas changed since the last flush into segment data through the lookup table.
+	 * Only segments whose points cross a changed area are rebuilt. The table is rebuilt (and the whole
+	 * canvas resolved) if the display configuration has changed.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	false if the display has fewer than 4 segments or the lookup table is too small for it.
+	 */
+	uint16_t numSegments = TeensyPOV::currentNumSegments;
+	uint16_t quarter = numSegments / 4, angle, base;
+	uint8_t quadrant;
+
+	if (lutLogNumSegments != TeensyPOV::currentLogNumSegments
+			|| lutNumLeds != TeensyPOV::numLeds) {
+		if (!buildLut()) {
+			return false;
+		}
+		invalidate();
+	}
+	if (numDirty == 0) {
+		return true;
+	}
+
+	TeensyPOV::beginFrame();
+	for (angle = 0; angle < numSegments; angle++) {
+		// Segment 'angle' segments clockwise from segment 0; the engine rotates it to the TDC segment
+		quadrant = angle / quarter;
+		base = angle % quarter;
+		if (segmentDirty(quadrant, lut + 4 * base)) {
+			resolveSegment(angle, quadrant,
+					lut + 4 * quarter + 2 * lutNumLeds * base);
+		}
+	}
+	TeensyPOV::endFrame();
+	numDirty = 0;
+	return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * TeensyPovCanvas.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVCANVAS_H_
+#define TEENSYPOVCANVAS_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+
+class TeensyPovCanvas {
+private:
+	struct DirtyRect {
+		uint8_t x0, y0, x1, y1;			// Inclusive
+	};
+	static const uint8_t maxDirtyRects = 4;
+	uint8_t *pixels;
+	uint8_t size;
+	int8_t *lut;
+	uint32_t lutCapacity;
+	uint8_t innerRadius;
+	uint8_t lutLogNumSegments = 0, lutNumLeds = 0;
+	DirtyRect dirty[maxDirtyRects];
+	uint8_t numDirty = 0;
+	bool buildLut(void);
+	void markDirty(uint8_t, uint8_t, uint8_t, uint8_t);
+	void resolveSegment(uint16_t, uint8_t, const int8_t *);
+	bool segmentDirty(uint8_t, const int8_t *);
+
+public:
+	// Bytes of lookup table needed for a configuration (quarter of the segments, by quadrant symmetry)
+	static constexpr uint32_t lutBytes(uint8_t logNumSegments, uint8_t numLeds) {
+		return ((1UL << logNumSegments) / 4) * (4 + 2 * (uint32_t) numLeds);
+	}
+	TeensyPovCanvas(uint8_t *, uint8_t, int8_t *, uint32_t, uint8_t = 1);
+	uint8_t getSize(void);
+	uint8_t *getBuffer(void);
+	uint8_t getPixel(uint8_t, uint8_t);
+	void setPixel(uint8_t, uint8_t, uint8_t);
+	void fill(uint8_t);
+	void fillRect(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t);
+	void drawLine(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t);
+	void invalidate(uint8_t, uint8_t, uint8_t, uint8_t);
+	void invalidate(void);
+	bool flush(void);
+};
+
+#endif /* TEENSYPOVCANVAS_H_ */
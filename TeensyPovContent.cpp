@@ -0,0 +1,511 @@
+/*
+ * TeensyPovContent.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovContent.h"
+#include "TeensyPovDisplay.h"
+
+/*
+ * Plays the displays and animations of a content pack (TeensyPovPack.h) in playlist order. While a frame is
+ * shown, the next one is read a chunk per update() into the back buffer (and its palette into the staged
+ * palette), straight from the file, then swapped in at the Top Dead Center after it falls due. So only one
+ * directory entry is held in RAM and the read is spread over many loop() passes. Payloads start on sector
+ * boundaries, so the SD library reads whole sectors of a raw frame straight into the segment buffer;
+ * run length coded frames are decoded as they are read, literal runs going straight in as well.
+ *
+ * Prefetching needs POV_DOUBLE_BUFFER and the same number of segments, color bits and words per segment
+ * as what is showing. Otherwise the next frame is read in one go when it falls due: straight into the
+ * displayed segments without POV_DOUBLE_BUFFER, or after setParameters() for a new geometry, which
+ * restarts the display as activating a TeensyPovDisplay does.
+ */
+
+static const uint32_t maxReadBytes = 16384;
+
+TeensyPovContent::TeensyPovContent() {
+	/*
+	 * Constructor
+	 */
+	memset(&current, 0, sizeof(current));
+	memset(&next, 0, sizeof(next));
+	memset(&payload, 0, sizeof(payload));
+	memset(&stats, 0, sizeof(stats));
+}
+
+bool TeensyPovContent::begin(const char *path) {
+	/*
+	 * Open a content pack. Call SD.begin() first.
+	 * Parameters:
+	 * 	const char *path -- File name on the SD card.
+	 *
+	 * Returns:
+	 * 	false if the file can't be opened, isn't a content pack of this version, is cut short or its
+	 * 	directory is corrupt.
+	 */
+	uint8_t buffer[povPackHeaderLength];
+	PovPackHeader header;
+	PovChecksum checksum;
+	uint16_t index;
+
+	end();
+	file = SD.open(path, FILE_READ);
+	if (!file) {
+		return false;
+	}
+	if (file.read(buffer, povPackHeaderLength) != povPackHeaderLength
+			|| !povPackParseHeader(buffer, &header) || header.fileSize != file.size()
+			|| header.directoryOffset + (uint32_t) header.numEntries * povPackEntryLength
+					> header.fileSize
+			|| !file.seek(header.directoryOffset)) {
+		end();
+		return false;
+	}
+	for (index = 0; index < header.numEntries; index++) {
+		if (file.read(buffer, povPackEntryLength) != povPackEntryLength) {
+			end();
+			return false;
+		}
+		checksum.add(buffer, povPackEntryLength);
+	}
+	if (checksum.value() != header.directoryChecksum) {
+		end();
+		return false;
+	}
+	numEntries = header.numEntries;
+	directoryOffset = header.directoryOffset;
+	return true;
+}
+
+void TeensyPovContent::end() {
+	/*
+	 * Stop playing and close the pack. What is showing stays on the display.
+	 */
+	stop();
+	if (file) {
+		file.close();
+	}
+	numEntries = 0;
+}
+
+uint16_t TeensyPovContent::getNumEntries() {
+	return numEntries;
+}
+
+bool TeensyPovContent::getEntry(uint16_t index, PovPackEntry *entry) {
+	/*
+	 * Read a directory entry.
+	 * Parameters:
+	 * 	uint16_t index -- Entry number, 0 to getNumEntries() - 1.
+	 *
+	 * 	PovPackEntry *entry -- Receives the entry.
+	 *
+	 * Returns:
+	 * 	false if there is no such entry.
+	 */
+	uint8_t buffer[povPackEntryLength];
+
+	if (!file || index >= numEntries
+			|| !file.seek(directoryOffset + (uint32_t) index * povPackEntryLength)
+			|| file.read(buffer, sizeof(buffer)) != sizeof(buffer)) {
+		return false;
+	}
+	povPackParseEntry(buffer, entry);
+	return true;
+}
+
+void TeensyPovContent::setPlaylist(const uint16_t *entries, uint16_t n, bool loop) {
+	/*
+	 * Set the order entries are played in. Takes effect from the next entry.
+	 * Parameters:
+	 * 	const uint16_t *entries -- Entry numbers, in playing order. nullptr plays every entry in directory order.
+	 * 		The array pointed to must be static or global.
+	 *
+	 * 	uint16_t n -- Number of entries in the playlist.
+	 *
+	 * 	bool loop -- Start over after the last entry (default), otherwise stay on it.
+	 */
+	playlist = entries;
+	playlistLength = entries ? n : 0;
+	repeat = loop;
+}
+
+void TeensyPovContent::setReadChunk(uint32_t bytes) {
+	/*
+	 * Set how much of the next frame update() reads at a time while prefetching (default 4096 bytes, at least
+	 * one segment is read). Smaller chunks keep loop() more responsive, larger ones get long frames in sooner.
+	 */
+	readChunk = bytes;
+}
+
+bool TeensyPovContent::play(uint16_t position) {
+	/*
+	 * Start playing from a playlist position. The first frame is shown by the next update().
+	 * Parameters:
+	 * 	uint16_t position -- Playlist position (entry number without a playlist). Unplayable entries are skipped.
+	 *
+	 * Returns:
+	 * 	false if there is nothing playable from there.
+	 */
+	if (!findEntry(position, &next, &nextPosition)) {
+		playing = false;
+		return false;
+	}
+
+	// Take the display over from any TeensyPovDisplay, which starts from scratch when activated again
+	TeensyPovDisplay::currentActivePov = 0;
+	if (TeensyPovAudio::active) {
+		TeensyPovAudio::active->stop();
+	}
+	nextFrame = 0;
+	nextDue = millis();
+	nextIsNewEntry = true;
+	startNext();
+	shown = false;
+	playing = true;
+	return true;
+}
+
+void TeensyPovContent::stop() {
+	/*
+	 * Stop playing. What is showing stays on the display.
+	 */
+	playing = false;
+	planned = false;
+}
+
+bool TeensyPovContent::update() {
+	/*
+	 * Read some more of the next frame and show it if it is due. Call from loop().
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	true if a new frame was sent to the display.
+	 */
+	uint32_t start, elapsed;
+	bool due, prefetch, ready;
+
+	if (!playing) {
+		return false;
+	}
+	if (!planned && !planNext()) {
+		playing = false;			// Nothing more to show
+		return false;
+	}
+
+	due = (int32_t) (millis() - nextDue) >= 0;
+	prefetch = TeensyPOV::numSegmentBuffers > 1 && shown && sameGeometry(current, next);
+	if (prefetch) {
+		if (TeensyPOV::bufferSwapPending || TeensyPOV::paletteSwapPending) {
+			return false;			// Back buffer still waiting for Top Dead Center
+		}
+	} else if (!due) {
+		return false;
+	} else if (!shown || !sameGeometry(current, next)) {
+		TeensyPOV::setParameters(next.logNumSegments, next.numColorBits, next.tdcSegment);
+		TeensyPOV::setPaletteBands(nullptr, 0);
+		TeensyPOV::setRotationBands(nullptr, 0);
+	}
+
+	start = micros();
+	ready = readNext(prefetch ? readChunk : UINT32_MAX);
+	elapsed = micros() - start;
+	if (elapsed > stats.maxReadMicros) {
+		stats.maxReadMicros = elapsed;
+	}
+	if (!ready) {
+		if (due && !lateCounted) {
+			stats.lateFrames++;
+			lateCounted = true;
+		}
+		return false;
+	}
+	if (!due) {
+		return false;
+	}
+	show();
+	return true;
+}
+
+bool TeensyPovContent::planNext() {
+	// Next frame of this entry, or the first frame of the next entry in the playlist
+	uint32_t frameDue;
+	bool animated;
+
+	animated = current.frameInterval > 0 && current.numFrames > 1;
+	frameDue = frameTimer + current.frameInterval;
+	if (animated && ((current.duration == 0) ? currentFrame + 1 < current.numFrames
+			: frameDue - entryTimer < current.duration)) {
+		next = current;
+		nextPosition = currentPosition;
+		nextFrame = (currentFrame + 1) % current.numFrames;
+		nextDue = frameDue;
+		nextIsNewEntry = false;
+	} else {
+		if (animated && current.duration == 0) {
+			nextDue = frameDue;
+		} else if (current.duration == 0) {
+			return false;			// Still, shown until play() is called
+		} else {
+			nextDue = entryTimer + current.duration;
+		}
+		if (!findEntry(currentPosition + 1, &next, &nextPosition)) {
+			return false;
+		}
+		nextFrame = 0;
+		nextIsNewEntry = true;
+	}
+	startNext();
+	return true;
+}
+
+void TeensyPovContent::startNext() {
+	// Find the next frame's payload and start reading it from the beginning
+	uint8_t buffer[povPackFrameLength];
+
+	if (!file.seek(next.frameTableOffset + (uint32_t) nextFrame * povPackFrameLength)
+			|| file.read(buffer, povPackFrameLength) != povPackFrameLength) {
+		memset(&payload, 0, sizeof(payload));
+		payload.flags = POV_PACK_RLE;			// Decodes to nothing, counted as an error
+	} else {
+		povPackParseFrame(buffer, &payload);
+	}
+	payloadRead = 0;
+	paletteRead = 0;
+	segmentsRead = 0;
+	columnsRead = 0;
+	runCount = 0;
+	lateCounted = false;
+	planned = true;
+}
+
+bool TeensyPovContent::findEntry(uint16_t position, PovPackEntry *entry, uint16_t *found) {
+	// First playable entry from a playlist position on
+	uint16_t length, tries;
+
+	length = playlist ? playlistLength : numEntries;
+	for (tries = 0; tries < length; tries++, position++) {
+		if (position >= length) {
+			if (!repeat) {
+				return false;
+			}
+			position = 0;
+		}
+		if (getEntry(playlist ? playlist[position] : position, entry) && playable(*entry)) {
+			*found = position;
+			return true;
+		}
+		stats.errors++;
+	}
+	return false;
+}
+
+bool TeensyPovContent::playable(const PovPackEntry &entry) {
+	return entry.logNumSegments >= 1 && entry.logNumSegments <= TeensyPOV::maxLogNumSegments
+			&& (entry.numColorBits == TeensyPOV::COLOR_BITS_1
+					|| entry.numColorBits == TeensyPOV::COLOR_BITS_2
+					|| entry.numColorBits == TeensyPOV::COLOR_BITS_4
+					|| entry.numColorBits == TeensyPOV::COLOR_BITS_8)
+			&& entry.numLeds > 0 && entry.numLeds <= TeensyPOV::numLeds
+			&& entry.wordsPerSegment
+					== (entry.numLeds * entry.numColorBits + TeensyPOV::bitsPerWord - 1)
+							/ TeensyPOV::bitsPerWord
+			&& entry.tdcSegment < (1U << entry.logNumSegments)
+			&& entry.numFrames > 0 && entry.numPaletteEntries <= 256 && entry.flags == 0;
+}
+
+bool TeensyPovContent::sameGeometry(const PovPackEntry &a, const PovPackEntry &b) {
+	// Segments of one can be read into a buffer laid out for the other
+	return a.logNumSegments == b.logNumSegments && a.numColorBits == b.numColorBits
+			&& a.wordsPerSegment == b.wordsPerSegment;
+}
+
+bool TeensyPovContent::readNext(uint32_t budget) {
+	// Reads up to budget bytes (at least one segment) of the next frame, palette first. Returns true once complete.
+	uint32_t numSegments, segmentBytes, rows, bytes, spent = 0;
+	uint16_t index, count, entries;
+	volatile uint32_t *colors;
+
+	if (nextIsNewEntry && paletteRead == 0) {
+		entries = TeensyPOV::currentNumPaletteEntries;
+		count = (next.numPaletteEntries < entries) ? next.numPaletteEntries : entries;
+		colors = TeensyPOV::stagedColors;
+		if (!file.seek(next.paletteOffset)
+				|| file.read((void *) colors, count * 4) != count * 4) {
+			stats.errors++;
+			count = 0;
+		}
+		for (index = count; index < entries; index++) {
+			colors[index] = 0;
+		}
+		paletteRead = entries;
+		spent = count * 4;
+	}
+
+	numSegments = 1UL << next.logNumSegments;
+	segmentBytes = next.segmentBytes();
+	if (segmentsRead < numSegments && !file.seek(payload.offset + payloadRead)) {
+		stats.errors++;
+		segmentsRead = numSegments;
+	}
+	if (payload.flags & POV_PACK_RLE) {
+		return decodeNext(budget, spent);
+	}
+	if (segmentsRead == 0 && payload.length != next.frameBytes()) {
+		stats.errors++;
+		segmentsRead = numSegments;
+	}
+	while (segmentsRead < numSegments && (spent == 0 || spent + segmentBytes <= budget)) {
+		// Rows as long as the pack's are contiguous in the buffer, read as many as the budget allows
+		rows = 1;
+		if (next.wordsPerSegment == TeensyPOV::maxColumns) {
+			rows = (budget - spent) / segmentBytes;
+			rows = (rows > maxReadBytes / segmentBytes) ? maxReadBytes / segmentBytes : rows;
+			rows = (rows > numSegments - segmentsRead) ? numSegments - segmentsRead : rows;
+			rows = (rows < 1) ? 1 : rows;
+		}
+		bytes = rows * segmentBytes;
+		if (file.read((void *) TeensyPOV::drawArray[segmentsRead], bytes) != (int) bytes) {
+			stats.errors++;
+			segmentsRead = numSegments;		// Show what there is rather than stall
+			break;
+		}
+		for (index = 0; index < rows; index++) {
+			clearRowTail(segmentsRead + index);
+		}
+		segmentsRead += rows;
+		payloadRead += bytes;
+		spent += bytes;
+	}
+	return segmentsRead == numSegments;
+}
+
+bool TeensyPovContent::decodeNext(uint32_t budget, uint32_t spent) {
+	// Run length coded payload: runs of one word are filled in, literal runs read straight into the rows
+	uint32_t numSegments, count, bytes, control, index;
+	uint8_t buffer[4];
+	volatile uint32_t *row;
+
+	numSegments = 1UL << next.logNumSegments;
+	while (segmentsRead < numSegments && (spent == 0 || spent < budget)) {
+		if (runCount == 0) {
+			if (payloadRead + 4 > payload.length || file.read(buffer, 4) != 4) {
+				break;
+			}
+			control = povPackGet(buffer, 4);
+			payloadRead += 4;
+			runCount = (control & ~povPackRunFlag) + 1;
+			runRepeats = control & povPackRunFlag;
+			if (runRepeats) {
+				if (payloadRead + 4 > payload.length || file.read(buffer, 4) != 4) {
+					break;
+				}
+				runValue = povPackGet(buffer, 4);
+				payloadRead += 4;
+			}
+		}
+
+		count = next.wordsPerSegment - columnsRead;
+		count = (runCount < count) ? runCount : count;
+		row = TeensyPOV::drawArray[segmentsRead] + columnsRead;
+		if (runRepeats) {
+			for (index = 0; index < count; index++) {
+				row[index] = runValue;
+			}
+		} else {
+			bytes = count * 4;
+			if (payloadRead + bytes > payload.length
+					|| file.read((void *) row, bytes) != (int) bytes) {
+				break;
+			}
+			payloadRead += bytes;
+		}
+		runCount -= count;
+		spent += count * 4;
+		columnsRead += count;
+		if (columnsRead == next.wordsPerSegment) {
+			clearRowTail(segmentsRead);
+			columnsRead = 0;
+			segmentsRead++;
+		}
+	}
+	if (segmentsRead < numSegments && (spent == 0 || spent < budget)) {
+		stats.errors++;
+		segmentsRead = numSegments;		// Show what there is rather than stall
+	}
+	return segmentsRead == numSegments;
+}
+
+void TeensyPovContent::clearRowTail(uint32_t segment) {
+	// An entry for fewer LEDs than the strip has leaves the outer LEDs' words of the row to be blanked
+	uint32_t column = next.wordsPerSegment;
+	uint32_t columns = (TeensyPOV::numLeds * next.numColorBits + TeensyPOV::bitsPerWord - 1)
+			/ TeensyPOV::bitsPerWord;
+
+	for (; column < columns; column++) {
+		TeensyPOV::drawArray[segment][column] = 0;
+	}
+}
+
+void TeensyPovContent::show() {
+	// Swap the next frame in from the next Top Dead Center, or now if the display isn't running
+	uint32_t now, lag;
+
+	if (nextIsNewEntry) {
+#ifdef POV_APA102_HDR
+		TeensyPOV::encodePalette(TeensyPOV::stagedColors);
+#endif  // POV_APA102_HDR
+		TeensyPOV::updateTdcPosition = (uint32_t) next.tdcSegment << TeensyPOV::tdcPositionShift;
+		stats.entriesShown++;
+	}
+	TeensyPOV::requestSwap(true, nextIsNewEntry);
+	stats.framesShown++;
+
+	// Keep to the schedule unless more than a frame behind
+	now = millis();
+	lag = now - nextDue;
+	frameTimer = (lag > next.frameInterval) ? now : nextDue;
+	if (nextIsNewEntry) {
+		entryTimer = frameTimer;
+	}
+	current = next;
+	currentPosition = nextPosition;
+	currentFrame = nextFrame;
+	shown = true;
+	planned = false;
+}
+
+bool TeensyPovContent::isPlaying() {
+	/*
+	 * Returns:
+	 * 	false once stopped, or when nothing more will be shown (a still that stays until play() is called,
+	 * 	or the end of a playlist that doesn't loop).
+	 */
+	return playing;
+}
+
+uint16_t TeensyPovContent::getPosition() {
+	/*
+	 * Returns:
+	 * 	Playlist position (entry number without a playlist) of what is showing.
+	 */
+	return currentPosition;
+}
+
+uint16_t TeensyPovContent::getFrame() {
+	/*
+	 * Returns:
+	 * 	Frame number of what is showing.
+	 */
+	return currentFrame;
+}
+
+void TeensyPovContent::getStats(ContentStats *ptr) {
+	/*
+	 * Parameters:
+	 * 	ContentStats *ptr -- Receives the counters.
+	 */
+	*ptr = stats;
+}
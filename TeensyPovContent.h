@@ -0,0 +1,86 @@
+/*
+ * TeensyPovContent.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVCONTENT_H_
+#define TEENSYPOVCONTENT_H_
+
+#include <Arduino.h>
+#include <SD.h>
+#include "TeensyPOV.h"
+#include "TeensyPovPack.h"
+
+struct ContentStats {
+	uint32_t framesShown;
+	uint32_t entriesShown;
+	uint32_t lateFrames;			// Not read in full by the time they were due
+	uint32_t errors;				// Entries skipped as unplayable, reads that came up short
+	uint32_t maxReadMicros;			// Longest read in one update()
+};
+
+class TeensyPovContent {
+private:
+	File file;
+	uint16_t numEntries = 0;
+	uint32_t directoryOffset = 0;
+	const uint16_t *playlist = nullptr;
+	uint16_t playlistLength = 0;
+	bool repeat = true;
+	bool playing = false;
+	uint32_t readChunk = 4096;
+
+	// What is showing
+	PovPackEntry current;
+	uint16_t currentPosition = 0;
+	uint16_t currentFrame = 0;
+	uint32_t frameTimer = 0, entryTimer = 0;
+	bool shown = false;
+
+	// What comes next, and how much of it is in the back buffer
+	PovPackEntry next;
+	uint16_t nextPosition = 0;
+	uint16_t nextFrame = 0;
+	uint32_t nextDue = 0;
+	bool planned = false;
+	bool nextIsNewEntry = false;
+	bool lateCounted = false;
+	PovPackFrame payload;
+	uint32_t payloadRead = 0;
+	uint16_t paletteRead = 0;
+	uint16_t segmentsRead = 0;
+	uint8_t columnsRead = 0;
+	uint32_t runCount = 0, runValue = 0;	// What is left of the current POV_PACK_RLE run
+	bool runRepeats = false;
+
+	ContentStats stats;
+	bool planNext(void);
+	bool findEntry(uint16_t, PovPackEntry *, uint16_t *);
+	bool playable(const PovPackEntry &);
+	bool sameGeometry(const PovPackEntry &, const PovPackEntry &);
+	void startNext(void);
+	bool readNext(uint32_t);
+	bool decodeNext(uint32_t, uint32_t);
+	void clearRowTail(uint32_t);
+	void show(void);
+
+public:
+	TeensyPovContent();
+	bool begin(const char *);
+	void end(void);
+	uint16_t getNumEntries(void);
+	bool getEntry(uint16_t, PovPackEntry *);
+	void setPlaylist(const uint16_t *, uint16_t, bool = true);
+	void setReadChunk(uint32_t);
+	bool play(uint16_t = 0);
+	void stop(void);
+	bool update(void);
+	bool isPlaying(void);
+	uint16_t getPosition(void);
+	uint16_t getFrame(void);
+	void getStats(ContentStats *);
+};
+
+#endif /* TEENSYPOVCONTENT_H_ */
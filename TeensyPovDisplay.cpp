@@ -40,6 +40,18 @@ void TeensyPovDisplay::load(const LedArrayStruct *pattern) {
 	rotationPeriod = 0;
 	rotationTimer = 0;
 	rotationIncrement = 0;
+	angularVelocity = 0;
+	governorSpiRate = 0;
+	paletteAnimation = nullptr;
+	paletteBandStart = nullptr;
+	numPaletteBands = 0;
+	rotationBandStart = nullptr;
+	numRotationBands = 0;
+	truecolorFrame = nullptr;
+	compositor = nullptr;
+	audio = nullptr;
+	numTextLayouts = 0;
+	textColumnsUsed = 0;
 	activationCallback = nullptr;
 	updateCallback = nullptr;
 	expireCallback = nullptr;
@@ -74,6 +86,18 @@ void TeensyPovDisplay::load(const LedArrayStruct *pattern,
 	rotationPeriod = 0;
 	rotationTimer = 0;
 	rotationIncrement = 0;
+	angularVelocity = 0;
+	governorSpiRate = 0;
+	paletteAnimation = nullptr;
+	paletteBandStart = nullptr;
+	numPaletteBands = 0;
+	rotationBandStart = nullptr;
+	numRotationBands = 0;
+	truecolorFrame = nullptr;
+	compositor = nullptr;
+	audio = nullptr;
+	numTextLayouts = 0;
+	textColumnsUsed = 0;
 	activationCallback = nullptr;
 	updateCallback = nullptr;
 	expireCallback = nullptr;
@@ -101,6 +125,18 @@ void TeensyPovDisplay::load(const DisplayStringSpec *strArray, uint8_t n) {
 	rotationPeriod = 0;
 	rotationTimer = 0;
 	rotationIncrement = 0;
+	angularVelocity = 0;
+	governorSpiRate = 0;
+	paletteAnimation = nullptr;
+	paletteBandStart = nullptr;
+	numPaletteBands = 0;
+	rotationBandStart = nullptr;
+	numRotationBands = 0;
+	truecolorFrame = nullptr;
+	compositor = nullptr;
+	audio = nullptr;
+	numTextLayouts = 0;
+	textColumnsUsed = 0;
 	activationCallback = nullptr;
 	updateCallback = nullptr;
 	expireCallback = nullptr;
@@ -126,6 +162,18 @@ void TeensyPovDisplay::load() {
 	rotationPeriod = 0;
 	rotationTimer = 0;
 	rotationIncrement = 0;
+	angularVelocity = 0;
+	governorSpiRate = 0;
+	paletteAnimation = nullptr;
+	paletteBandStart = nullptr;
+	numPaletteBands = 0;
+	rotationBandStart = nullptr;
+	numRotationBands = 0;
+	truecolorFrame = nullptr;
+	compositor = nullptr;
+	audio = nullptr;
+	numTextLayouts = 0;
+	textColumnsUsed = 0;
 	activationCallback = nullptr;
 	updateCallback = nullptr;
 	expireCallback = nullptr;
@@ -178,6 +226,150 @@ void TeensyPovDisplay::setTiming(uint32_t duration, uint32_t rotation,
 	rotationIncrement = tdcDelta;
 }
 
+void TeensyPovDisplay::setAngularVelocity(int16_t degreesPerSecond) {
+	/*
+	 * Rotate the display smoothly. The Top Dead Center position advances by fractions of a segment,
+	 * so motion is smooth at any number of segments. Optional, set to zero by the load() method.
+	 * Overrides the rotation set by setTiming().
+	 *
+	 * Parameters:
+	 * 	int16_t degreesPerSecond -- Angular velocity. Use negative value for clockwise rotation and positive value
+	 * 		for anti-clockwise. Use zero for no rotation.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	angularVelocity = degreesPerSecond;
+	rotationRemainder = 0;
+	rotationTimer = millis();		// Advance from now, not from activation or the last setTiming() step
+}
+
+void TeensyPovDisplay::setGovernor(uint32_t spiRate, uint8_t minLogSeg,
+		uint8_t maxLogSeg) {
+	/*
+	 * Let the number of segments follow the rotor speed. Optional, the governor is disabled by the load() method.
+	 * The highest number of segments whose LED update fits in the segment period is chosen automatically.
+	 * Bit map images and text are redrawn at the new resolution, other content is resampled.
+	 *
+	 * Parameters:
+	 * 	uint32_t spiRate -- LED clock rate in Hz, as given to FastLED.addLeds(). Use zero to disable the governor.
+	 *
+	 * 	uint8_t minLogSeg -- Log (base 2) of the fewest segments allowed. Use static constants defined by class TeensyPOV.
+	 *
+	 * 	uint8_t maxLogSeg -- Log (base 2) of the most segments allowed. Use static constants defined by class TeensyPOV.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (maxLogSeg > TeensyPOV::maxLogNumSegments) {
+		maxLogSeg = TeensyPOV::maxLogNumSegments;
+	}
+	if (minLogSeg < TeensyPOV::LOG_2_SEGMENTS) {
+		minLogSeg = TeensyPOV::LOG_2_SEGMENTS;
+	}
+	if (minLogSeg > maxLogSeg) {
+		minLogSeg = maxLogSeg;
+	}
+	governorSpiRate = spiRate;
+	governorMinLog = minLogSeg;
+	governorMaxLog = maxLogSeg;
+}
+
+void TeensyPovDisplay::setPaletteAnimation(TeensyPovPalette *animation) {
+	/*
+	 * Attach a palette animation to be advanced by update() while this object is displayed. Optional, set to
+	 * nullptr by the load() method.
+	 * Parameters:
+	 * 	TeensyPovPalette *animation -- Pointer to the animation. The object pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	paletteAnimation = animation;
+}
+
+void TeensyPovDisplay::setPaletteBands(const uint8_t *bandStart, uint8_t n) {
+	/*
+	 * Give each radial band of LEDs its own bank of 2 ^ cBits palette entries (see TeensyPOV::setPaletteBands()).
+	 * Optional, the load() method sets a single band. The palette must then hold n * 2 ^ cBits entries.
+	 * Parameters:
+	 * 	const uint8_t *bandStart -- Array of first LED of each band, starting with 0. The array pointed to must be static or global.
+	 *
+	 * 	uint8_t n -- Number of bands.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	paletteBandStart = bandStart;
+	numPaletteBands = n;
+}
+
+void TeensyPovDisplay::setRotationBands(const uint8_t *bandStart, uint8_t n,
+		const int32_t *velocity) {
+	/*
+	 * Turn radial bands of LEDs independently (see TeensyPOV::setRotationBands()), e.g. counter-rotating text
+	 * rings around a fixed logo. Optional, the load() method sets a single band. The bands start from the
+	 * image's position each time the display is activated.
+	 * Parameters:
+	 * 	const uint8_t *bandStart -- Array of first LED of each band, starting with 0. The array pointed to must be static or global.
+	 *
+	 * 	uint8_t n -- Number of bands, up to 8.
+	 *
+	 * 	const int32_t *velocity -- Array of n band velocities in segments per revolution, 16.16 fixed point
+	 * 		(see TeensyPOV::setBandRotation()). The array pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	rotationBandStart = bandStart;
+	numRotationBands = n;
+	rotationBandVelocity = velocity;
+}
+
+void TeensyPovDisplay::setTruecolor(const CRGB *frame) {
+	/*
+	 * Show 24-bit RGB segments instead of palette indexes (see TeensyPOV::setTruecolor()). The number of segments
+	 * and Top Dead Center segment are those set by setDisplay(), the palette and any image or strings are not used.
+	 * Optional, set to nullptr by the load() method. Calling refresh() with a new frame shows it from the next
+	 * Top Dead Center.
+	 * Parameters:
+	 * 	const CRGB *frame -- Colors of every LED of every segment, CRGB[2 ^ logSeg][number of LEDs].
+	 * 		The array pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	truecolorFrame = frame;
+}
+
+void TeensyPovDisplay::setCompositor(TeensyPovCompositor *layers) {
+	/*
+	 * Show a stack of layers (see TeensyPovCompositor) on every activate() and refresh(). The layers make up the
+	 * whole frame, replacing any image or strings (draw those into a layer instead). Call the compositor's
+	 * composite() to show layer changes in between. Optional, set to nullptr by the load() method.
+	 * Parameters:
+	 * 	TeensyPovCompositor *layers -- Pointer to the compositor. The object pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	compositor = layers;
+}
+
+void TeensyPovDisplay::setAudio(TeensyPovAudio *visualizer) {
+	/*
+	 * Make this an audio visualizer display: while it is active the visualizer analyzes and draws once per
+	 * revolution (it takes over the frame callback), over the image and strings if any. Start the sampling
+	 * with the visualizer's begin(). Optional, set to nullptr by the load() method.
+	 * Parameters:
+	 * 	TeensyPovAudio *visualizer -- Pointer to the visualizer. The object pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	audio = visualizer;
+}
+
 void TeensyPovDisplay::activate() {
 	/*
 	 * Display a TeensyPOV object on the POV LEDs.
@@ -259,12 +451,36 @@ bool TeensyPovDisplay::update() {
 		return true;
 	}
 
-	if (rotationPeriod > 0) {
+	if (angularVelocity != 0) {
+		// TDC position in 1/65536 segment, 360000 = degrees per revolution * milliseconds per second
+		int64_t numerator = (int64_t) angularVelocity
+				* (int32_t) (currentMillis - rotationTimer)
+				* (TeensyPOV::currentNumSegments << TeensyPOV::tdcPositionShift)
+				+ rotationRemainder;
+		rotationTimer = currentMillis;
+		rotationPosition += (int32_t) (numerator / 360000);
+		rotationRemainder = numerator % 360000;
+		rotationPosition &= (TeensyPOV::currentSegmentMask
+				<< TeensyPOV::tdcPositionShift) | TeensyPOV::tdcFractionMask;
+		TeensyPOV::updateTdcPosition = rotationPosition;
+	} else if (rotationPeriod > 0) {
 		if (currentMillis - rotationTimer >= rotationPeriod) {
 			rotationTimer += rotationPeriod;
-			TeensyPOV::updateTdcDisplaySegment =
-					(TeensyPOV::currentTdcDisplaySegment + rotationIncrement)
-							& TeensyPOV::currentSegmentMask;
+			TeensyPOV::updateTdcPosition =
+					((TeensyPOV::currentTdcDisplaySegment + rotationIncrement)
+							& TeensyPOV::currentSegmentMask)
+							<< TeensyPOV::tdcPositionShift;
+		}
+	}
+
+	if (paletteAnimation) {
+		paletteAnimation->update();
+	}
+
+	if (governorSpiRate > 0) {
+		if (currentMillis - governorTimer >= governorInterval) {
+			governorTimer = currentMillis;
+			governResolution();
 		}
 	}
 
@@ -284,26 +500,81 @@ bool TeensyPovDisplay::update() {
 	return false;
 }
 
+void TeensyPovDisplay::governResolution() {
+	uint8_t newLogNumSegments;
+
+	if (!TeensyPOV::rpmGood() || truecolorFrame) {
+		return;		// Truecolor frames are made for one number of segments
+	}
+	newLogNumSegments = TeensyPOV::governLogNumSegments(logNumSegments,
+			governorSpiRate, governorMinLog, governorMaxLog);
+	if (newLogNumSegments == logNumSegments) {
+		return;
+	}
+
+	TeensyPOV::resample(newLogNumSegments);
+	if (compositor) {
+		compositor->resample(logNumSegments, newLogNumSegments);
+	}
+	if (newLogNumSegments > logNumSegments) {
+		tdcSegment <<= newLogNumSegments - logNumSegments;
+		rotationPosition <<= newLogNumSegments - logNumSegments;
+	} else {
+		tdcSegment >>= logNumSegments - newLogNumSegments;
+		rotationPosition >>= logNumSegments - newLogNumSegments;
+	}
+	logNumSegments = newLogNumSegments;
+
+	// Redraw what can be redrawn rather than keep the resampled copy
+	if (image || strings || compositor) {
+		loadPovStructures(false);
+	}
+}
+
 void TeensyPovDisplay::loadPovStructures(bool startTiming) {
-	uint8_t index;
-	const DisplayStringSpec *strPtr;
-	if (currentActivePov != idNum) {
+	if (truecolorFrame) {
+		if (currentActivePov != idNum) {
+			TeensyPOV::setTruecolor(truecolorFrame, logNumSegments, tdcSegment);
+		} else {
+			TeensyPOV::stageTruecolorFrame(truecolorFrame);
+		}
+	} else if (currentActivePov != idNum) {
 		TeensyPOV::setParameters(logNumSegments, numColorBits, tdcSegment);
 	}
+	TeensyPOV::beginFrame();
+
+	if (!truecolorFrame) {
+		TeensyPOV::setPaletteBands(paletteBandStart, numPaletteBands);
+		TeensyPOV::loadColors(colorPalette);
+		if (currentActivePov != idNum) {
+			// Band positions carry on through refresh()
+			TeensyPOV::setRotationBands(rotationBandStart, numRotationBands);
+			for (uint8_t band = 0; rotationBandStart && band < numRotationBands; band++) {
+				TeensyPOV::setBandRotation(band, rotationBandVelocity[band]);
+			}
+		}
+	}
 
-	TeensyPOV::loadColors(colorPalette);
-
-	if (image) {
+	if (image && !truecolorFrame) {
 		TeensyPOV::loadPattern(image);
 	}
 
-	if (strings) {
-		for (index = 0; index < numStrings; index++) {
-			strPtr = strings + index;
-			TeensyPOV::loadString(strPtr->characters, strPtr->position,
-					strPtr->topRow, strPtr->textColor, strPtr->backgroundColor,
-					strPtr->invert);
+	if (strings && !truecolorFrame) {
+		drawStrings();
+	}
+
+	if (compositor && !truecolorFrame) {
+		compositor->invalidate();
+		compositor->compositeSegments();
+	}
+
+	if (audio && !truecolorFrame) {
+		if (currentActivePov != idNum) {
+			audio->start();
 		}
+		audio->redraw();
+	} else if (currentActivePov != idNum && TeensyPovAudio::active) {
+		TeensyPovAudio::active->stop();
 	}
 	currentActivePov = idNum;
 
@@ -311,9 +582,50 @@ void TeensyPovDisplay::loadPovStructures(bool startTiming) {
 		expired = false;
 		durationTimer = millis();
 		rotationTimer = durationTimer;
+		rotationPosition = TeensyPOV::updateTdcPosition;
+		rotationRemainder = 0;
 		if (activationCallback) {
 			activationCallback(this);
 		}
 	}
+	TeensyPOV::endFrame();
 }
 
+void TeensyPovDisplay::drawStrings() {
+	// Strings are compiled to font columns once and just copied in after that. A string is only compiled again
+	// when its characters, placement or the number of segments change. Any that don't fit are drawn directly.
+	uint8_t index;
+	const DisplayStringSpec *strPtr;
+	TextLayout *layout;
+
+	for (index = 0; index < numStrings; index++) {
+		strPtr = strings + index;
+		layout = textLayouts + index;
+		if (index < numTextLayouts && (layout->characters != strPtr->characters
+				|| layout->hash != TeensyPOV::stringHash(strPtr))) {
+			if (!TeensyPOV::compileString(strPtr, layout,
+					textColumns + layout->offset, layout->capacity)) {
+				// Grew out of its space, lay out again from here
+				numTextLayouts = index;
+				textColumnsUsed = layout->offset;
+			}
+		}
+		if (index == numTextLayouts && index < maxTextLayouts
+				&& TeensyPOV::compileString(strPtr, layout,
+						textColumns + textColumnsUsed,
+						sizeof(textColumns) - textColumnsUsed)) {
+			layout->offset = textColumnsUsed;
+			layout->capacity = layout->numColumns;
+			textColumnsUsed += layout->numColumns;
+			numTextLayouts++;
+		}
+		if (index < numTextLayouts) {
+			TeensyPOV::drawLayout(layout, textColumns + layout->offset,
+					strPtr->textColor, strPtr->backgroundColor);
+		} else {
+			TeensyPOV::loadString(strPtr->characters, strPtr->position,
+					strPtr->topRow, strPtr->textColor, strPtr->backgroundColor,
+					strPtr->invert);
+		}
+	}
+}
@@ -12,12 +12,21 @@
 #define FASTLED_INTERNAL
 #include "FastLED.h"
 #include "TeensyPOV.h"
+#include "TeensyPovPalette.h"
+#include "TeensyPovLayer.h"
+#include "TeensyPovAudio.h"
 
 #if !defined(KINETISK)
 #error Kinetisk required
 #endif
 
+// Bytes per display for compiled strings, 7 per character
+#ifndef POV_TEXT_CACHE_BYTES
+#define POV_TEXT_CACHE_BYTES 256
+#endif
+
 class TeensyPovDisplay {
+	friend class TeensyPovContent;
 private:
 	uint8_t numColorBits = 0;
 	uint8_t logNumSegments = 1;
@@ -25,19 +34,41 @@ private:
 	const LedArrayStruct *image = nullptr;
 	const DisplayStringSpec *strings = nullptr;
 	uint8_t numStrings = 0;
+	static const uint8_t maxTextLayouts = 4;
+	TextLayout textLayouts[maxTextLayouts];		// Compiled strings, see drawStrings()
+	uint8_t numTextLayouts = 0;
+	uint8_t textColumns[POV_TEXT_CACHE_BYTES];
+	uint16_t textColumnsUsed = 0;
 	uint32_t displayDuration = 0, durationTimer = 0;
 	uint32_t rotationPeriod = 0, rotationTimer = 0;
 	int16_t rotationIncrement = 0;
+	int16_t angularVelocity = 0;
+	uint32_t rotationPosition = 0;
+	int32_t rotationRemainder = 0;
 	uint16_t tdcSegment = 0;
+	uint32_t governorSpiRate = 0, governorTimer = 0;
+	uint8_t governorMinLog = 1, governorMaxLog = 1;
+	TeensyPovPalette *paletteAnimation = nullptr;
+	const uint8_t *paletteBandStart = nullptr;
+	uint8_t numPaletteBands = 0;
+	const uint8_t *rotationBandStart = nullptr;
+	const int32_t *rotationBandVelocity = nullptr;
+	uint8_t numRotationBands = 0;
+	const CRGB *truecolorFrame = nullptr;
+	TeensyPovCompositor *compositor = nullptr;
+	TeensyPovAudio *audio = nullptr;
 	uint8_t idNum;
 	bool expired = false;
 	void loadPovStructures(bool);
+	void drawStrings(void);
+	void governResolution(void);
 	void (*activationCallback)(TeensyPovDisplay *) = nullptr;
 	void (*updateCallback)(TeensyPovDisplay *) = nullptr;
 	void (*expireCallback)(TeensyPovDisplay *) = nullptr;
 
 	static uint8_t numPov;
 	static uint8_t currentActivePov;
+	static const uint32_t governorInterval = 250;
 
 public:
 	TeensyPovDisplay();
@@ -49,6 +80,14 @@ public:
 	void refresh();
 	void setDisplay(uint8_t, uint8_t, uint16_t, const uint32_t *);
 	void setTiming(uint32_t, uint32_t, int16_t);
+	void setAngularVelocity(int16_t);
+	void setGovernor(uint32_t, uint8_t, uint8_t);
+	void setPaletteAnimation(TeensyPovPalette *);
+	void setPaletteBands(const uint8_t *, uint8_t);
+	void setRotationBands(const uint8_t *, uint8_t, const int32_t *);
+	void setTruecolor(const CRGB *);
+	void setCompositor(TeensyPovCompositor *);
+	void setAudio(TeensyPovAudio *);
 	void setActivationCallback(void (*)(TeensyPovDisplay *));
 	void setUpdateCallback(void (*)(TeensyPovDisplay *));
 	void setExpireCallback(void (*)(TeensyPovDisplay *));
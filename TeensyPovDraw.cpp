@@ -0,0 +1,351 @@
+/*
+ * TeensyPovDraw.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovDraw.h"
+
+/*
+ * Integer polar drawing into the draw buffer (see TeensyPOV::beginFrame()).
+ * Segments are display segments as in TeensyPOV::setPixel(), LEDs are 0 = innermost. Runs of LEDs
+ * are written a packed word at a time, with the word masks worked out once per call rather than per
+ * segment. Angles for lines use fixed point with 65536 units per revolution.
+ */
+
+// sin() over the first quarter of a 512 segment revolution, Q15. Smaller segment counts step through it.
+const int16_t TeensyPovDraw::sinTable[quarterWave + 1] = { 0, 402, 804, 1206,
+		1608, 2009, 2410, 2811, 3212, 3612, 4011, 4410, 4808, 5205, 5602, 5998,
+		6393, 6786, 7179, 7571, 7962, 8351, 8739, 9126, 9512, 9896, 10278, 10659,
+		11039, 11417, 11793, 12167, 12539, 12910, 13279, 13645, 14010, 14372,
+		14732, 15090, 15446, 15800, 16151, 16499, 16846, 17189, 17530, 17869,
+		18204, 18537, 18868, 19195, 19519, 19841, 20159, 20475, 20787, 21096,
+		21403, 21705, 22005, 22301, 22594, 22884, 23170, 23452, 23731, 24007,
+		24279, 24547, 24811, 25072, 25329, 25582, 25832, 26077, 26319, 26556,
+		26790, 27019, 27245, 27466, 27683, 27896, 28105, 28310, 28510, 28706,
+		28898, 29085, 29268, 29447, 29621, 29791, 29956, 30117, 30273, 30424,
+		30571, 30714, 30852, 30985, 31113, 31237, 31356, 31470, 31580, 31685,
+		31785, 31880, 31971, 32057, 32137, 32213, 32285, 32351, 32412, 32469,
+		32521, 32567, 32609, 32646, 32678, 32705, 32728, 32745, 32757, 32765,
+		32767 };
+
+uint8_t TeensyPovDraw::hubRadius = 0;
+
+int16_t TeensyPovDraw::sin16(uint16_t segment) {
+	/*
+	 * Parameters:
+	 * 	uint16_t segment -- Angle in segments of the current display, clockwise from segment 0.
+	 *
+	 * Returns:
+	 * 	sin() of the angle, scaled by 32767. Measured from segment 0, so it is the horizontal component.
+	 */
+	uint16_t index = (segment & TeensyPOV::currentSegmentMask)
+			<< (TeensyPOV::LOG_512_SEGMENTS - TeensyPOV::currentLogNumSegments);
+
+	return sinRevolution(index << 7);
+}
+
+int16_t TeensyPovDraw::cos16(uint16_t segment) {
+	return sin16(segment + (TeensyPOV::currentNumSegments >> 2));
+}
+
+void TeensyPovDraw::setHubRadius(uint8_t radius) {
+	/*
+	 * Distance from the center to LED 0, in LED spacings. Only affects line() and the polygons, which
+	 * need the true geometry to be straight. Default 0.
+	 */
+	hubRadius = radius;
+}
+
+int16_t TeensyPovDraw::sinRevolution(uint16_t angle) {
+	// Angle in 1/65536 revolution, nearest table entry
+	uint16_t index = ((angle + 64) >> 7) & 511;
+	uint16_t quadrant = index >> 7, offset = index & (quarterWave - 1);
+
+	switch (quadrant) {
+	case 0:
+		return sinTable[offset];
+	case 1:
+		return sinTable[quarterWave - offset];
+	case 2:
+		return -sinTable[offset];
+	default:
+		return -sinTable[quarterWave - offset];
+	}
+}
+
+uint16_t TeensyPovDraw::atan2Revolution(int32_t x, int32_t y) {
+	// Angle of (x, y) clockwise from +y in 1/65536 revolution. atan(t) ~ t pi/4 + 0.273 t (1 - t), error < 0.25 degree.
+	uint32_t ax = abs(x), ay = abs(y), t, a;
+
+	if (ax == 0 && ay == 0) {
+		return 0;
+	}
+	if (ax <= ay) {
+		t = ((uint64_t) ax << 15) / ay;
+		a = (8192 * t + ((t * (32768 - t)) >> 15) * 2847) >> 15;
+	} else {
+		t = ((uint64_t) ay << 15) / ax;
+		a = 16384 - ((8192 * t + ((t * (32768 - t)) >> 15) * 2847) >> 15);
+	}
+	if (x >= 0) {
+		return (y >= 0) ? a : 32768 - a;
+	}
+	return (y >= 0) ? 65536 - a : 32768 + a;
+}
+
+uint32_t TeensyPovDraw::isqrt(uint32_t value) {
+	uint32_t root = 0, bit = 1UL << 30;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+void TeensyPovDraw::putPixel(uint16_t segment, uint8_t led, uint8_t color) {
+	uint8_t pixelWord, pixelShift;
+	uint32_t pixelMask;
+
+	if (led >= TeensyPOV::numLeds) {
+		return;
+	}
+	segment &= TeensyPOV::currentSegmentMask;
+	pixelWord = led / TeensyPOV::pixelsPerWord;
+	pixelShift = (led % TeensyPOV::pixelsPerWord) * TeensyPOV::currentNumColorBits;
+	pixelMask = TeensyPOV::currentColorMask << pixelShift;
+	TeensyPOV::drawArray[segment][pixelWord] = (TeensyPOV::drawArray[segment][pixelWord]
+			& ~pixelMask) | (((uint32_t) color << pixelShift) & pixelMask);
+}
+
+void TeensyPovDraw::fillRuns(uint16_t firstSegment, uint16_t count,
+		uint8_t firstLed, uint8_t lastLed, uint8_t color) {
+	// LEDs firstLed to lastLed in 'count' segments clockwise from firstSegment, a word at a time
+	uint32_t masks[TeensyPOV::maxColumns];
+	uint32_t colorMask = TeensyPOV::currentColorMask;
+	uint32_t pattern = (color & colorMask) * (0xFFFFFFFFUL / colorMask);
+	uint8_t ppw = TeensyPOV::pixelsPerWord, bits = TeensyPOV::currentNumColorBits;
+	uint8_t firstWord, lastWord, word, low, high;
+	volatile uint32_t *row;
+	uint16_t segment;
+
+	if (firstLed > lastLed) {
+		uint8_t swap = firstLed;
+		firstLed = lastLed;
+		lastLed = swap;
+	}
+	if (firstLed >= TeensyPOV::numLeds) {
+		return;
+	}
+	if (lastLed >= TeensyPOV::numLeds) {
+		lastLed = TeensyPOV::numLeds - 1;
+	}
+	firstWord = firstLed / ppw;
+	lastWord = lastLed / ppw;
+	for (word = firstWord; word <= lastWord; word++) {
+		low = (word == firstWord) ? (firstLed % ppw) * bits : 0;
+		high = (word == lastWord) ? (lastLed % ppw + 1) * bits : 32;
+		masks[word] = ((high == 32) ? 0xFFFFFFFFUL : ((1UL << high) - 1))
+				& ~((1UL << low) - 1);
+	}
+
+	if (count > TeensyPOV::currentNumSegments) {
+		count = TeensyPOV::currentNumSegments;
+	}
+	segment = firstSegment & TeensyPOV::currentSegmentMask;
+	while (count-- > 0) {
+		row = TeensyPOV::drawArray[segment];
+		for (word = firstWord; word <= lastWord; word++) {
+			row[word] = (row[word] & ~masks[word]) | (pattern & masks[word]);
+		}
+		segment = (segment + 1) & TeensyPOV::currentSegmentMask;
+	}
+}
+
+void TeensyPovDraw::plot(uint16_t segment, int32_t radius, uint8_t color) {
+	/*
+	 * Plot a point given its radius, e.g. from a formula.
+	 * Parameters:
+	 * 	uint16_t segment -- Display segment.
+	 *
+	 * 	int32_t radius -- LED position in 1/256 LED spacing. Negative radii plot on the opposite side.
+	 *
+	 * 	uint8_t color -- Color expressed as index into current Palette.
+	 */
+	if (radius < 0) {
+		radius = -radius;
+		segment += TeensyPOV::currentNumSegments >> 1;
+	}
+	radius = (radius + (1 << (radiusShift - 1))) >> radiusShift;
+	if (radius < (int32_t) TeensyPOV::numLeds) {
+		putPixel(segment, radius, color);
+	}
+}
+
+void TeensyPovDraw::ring(uint8_t led, uint8_t color, uint8_t width) {
+	/*
+	 * Full circle(s) starting at 'led', 'width' LEDs wide.
+	 */
+	if (width == 0) {
+		return;
+	}
+	fillRuns(0, TeensyPOV::currentNumSegments, led, min(led + width - 1, 255),
+			color);
+}
+
+void TeensyPovDraw::spoke(uint16_t segment, uint8_t color) {
+	fillRuns(segment, 1, 0, TeensyPOV::numLeds - 1, color);
+}
+
+void TeensyPovDraw::spoke(uint16_t segment, uint8_t firstLed, uint8_t lastLed,
+		uint8_t color) {
+	fillRuns(segment, 1, firstLed, lastLed, color);
+}
+
+void TeensyPovDraw::arc(uint8_t led, uint16_t firstSegment,
+		uint16_t lastSegment, uint8_t color) {
+	/*
+	 * Part of a ring, clockwise from firstSegment to lastSegment inclusive (wraps through segment 0).
+	 */
+	fillRuns(firstSegment, ((lastSegment - firstSegment) & TeensyPOV::currentSegmentMask) + 1,
+			led, led, color);
+}
+
+void TeensyPovDraw::sector(uint16_t firstSegment, uint16_t lastSegment,
+		uint8_t firstLed, uint8_t lastLed, uint8_t color) {
+	/*
+	 * Filled annular sector, clockwise from firstSegment to lastSegment inclusive, LEDs firstLed to lastLed.
+	 */
+	fillRuns(firstSegment, ((lastSegment - firstSegment) & TeensyPOV::currentSegmentMask) + 1,
+			firstLed, lastLed, color);
+}
+
+void TeensyPovDraw::toCartesian(uint8_t led, uint32_t angle, int32_t *x,
+		int32_t *y) {
+	// Center of LED 'led' at 'angle' (1/65536 revolution) to x right, y up, in 1/256 LED spacing
+	int32_t radius = ((hubRadius + led) << radiusShift) + (1 << (radiusShift - 1));
+
+	*x = (radius * sinRevolution(angle)) >> 15;
+	*y = (radius * sinRevolution(angle + 16384)) >> 15;
+}
+
+void TeensyPovDraw::cartesianLine(int32_t x0, int32_t y0, int32_t x1,
+		int32_t y1, uint8_t color) {
+	// Walk the line in steps of 1/stepsPerLed LED spacing, plotting each new (segment, LED) once
+	int32_t dx = x1 - x0, dy = y1 - y0, x, y, radius;
+	int32_t steps = max(abs(dx), abs(dy)) * stepsPerLed >> radiusShift;
+	int32_t step, led, lastLed = -1;
+	uint16_t segment, lastSegment = 0xFFFF;
+	uint8_t segmentShift = 16 - TeensyPOV::currentLogNumSegments;
+
+	for (step = 0; step <= steps; step++) {
+		x = x0 + ((steps == 0) ? 0 : dx * step / steps);
+		y = y0 + ((steps == 0) ? 0 : dy * step / steps);
+		radius = isqrt((uint32_t) x * x + (uint32_t) y * y);
+		led = (radius >> radiusShift) - hubRadius;
+		segment = ((uint32_t) atan2Revolution(x, y)
+				+ (1UL << (segmentShift - 1))) >> segmentShift;
+		if (led < 0 || (led == lastLed && segment == lastSegment)) {
+			continue;
+		}
+		putPixel(segment, led, color);
+		lastLed = led;
+		lastSegment = segment;
+	}
+}
+
+void TeensyPovDraw::line(uint8_t led0, uint16_t segment0, uint8_t led1,
+		uint16_t segment1, uint8_t color) {
+	/*
+	 * Straight line between two LED positions (see setHubRadius()).
+	 */
+	uint8_t segmentShift = 16 - TeensyPOV::currentLogNumSegments;
+	int32_t x0, y0, x1, y1;
+
+	toCartesian(led0, (uint32_t) segment0 << segmentShift, &x0, &y0);
+	toCartesian(led1, (uint32_t) segment1 << segmentShift, &x1, &y1);
+	cartesianLine(x0, y0, x1, y1, color);
+}
+
+void TeensyPovDraw::polygon(const PolarPoint *points, uint8_t n,
+		uint8_t color) {
+	/*
+	 * Closed polygon through n points.
+	 */
+	uint8_t index;
+
+	for (index = 0; index < n; index++) {
+		line(points[index].led, points[index].segment,
+				points[(index + 1) % n].led, points[(index + 1) % n].segment,
+				color);
+	}
+}
+
+void TeensyPovDraw::regularPolygon(uint8_t sides, uint8_t led,
+		uint16_t rotation, uint8_t color) {
+	/*
+	 * Regular polygon with its vertices on LED 'led', the first vertex at segment 'rotation'.
+	 */
+	uint32_t start = (uint32_t) rotation << (16 - TeensyPOV::currentLogNumSegments);
+	int32_t x0, y0, x1, y1;
+	uint8_t side;
+
+	if (sides < 2) {
+		return;
+	}
+	toCartesian(led, start, &x0, &y0);
+	for (side = 1; side <= sides; side++) {
+		toCartesian(led, start + (side * 65536UL) / sides, &x1, &y1);
+		cartesianLine(x0, y0, x1, y1, color);
+		x0 = x1;
+		y0 = y1;
+	}
+}
+
+void TeensyPovDraw::curve(int32_t (*radius)(uint16_t), uint8_t color) {
+	/*
+	 * Parametric curve r(segment), e.g. roses and limacons.
+	 * Parameters:
+	 * 	int32_t (*radius)(uint16_t) -- Called once per segment, returns the LED position in 1/256 LED spacing
+	 * 		(negative plots on the opposite side, see plot()). Use sin16() / cos16() to stay in integers.
+	 *
+	 * 	uint8_t color -- Color expressed as index into current Palette.
+	 *
+	 * Points in neighboring segments are joined radially so steep parts of the curve have no gaps.
+	 */
+	uint16_t numSegments = TeensyPOV::currentNumSegments, segment, target;
+	uint16_t lastTarget = 0;
+	int32_t r, led, lastLed = -1;
+
+	for (segment = 0; segment <= numSegments; segment++) {
+		r = radius(segment & TeensyPOV::currentSegmentMask);
+		target = segment;
+		if (r < 0) {
+			r = -r;
+			target += numSegments >> 1;
+		}
+		target &= TeensyPOV::currentSegmentMask;
+		led = min((r + (1 << (radiusShift - 1))) >> radiusShift, 255);
+		if (lastLed >= 0
+				&& ((target - lastTarget) & TeensyPOV::currentSegmentMask) == 1
+				&& abs(led - lastLed) > 1) {
+			// Fill half the gap in each segment
+			fillRuns(lastTarget, 1, lastLed, (lastLed + led) / 2, color);
+			fillRuns(target, 1, (lastLed + led) / 2, led, color);
+		} else {
+			putPixel(target, led, color);
+		}
+		lastLed = led;
+		lastTarget = target;
+	}
+}
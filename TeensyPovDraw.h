@@ -0,0 +1,50 @@
+/*
+ * TeensyPovDraw.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVDRAW_H_
+#define TEENSYPOVDRAW_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+
+struct PolarPoint {
+	uint8_t led;
+	uint16_t segment;
+};
+
+class TeensyPovDraw {
+public:
+	static int16_t sin16(uint16_t);
+	static int16_t cos16(uint16_t);
+	static void setHubRadius(uint8_t);
+	static void plot(uint16_t, int32_t, uint8_t);
+	static void ring(uint8_t, uint8_t, uint8_t = 1);
+	static void spoke(uint16_t, uint8_t);
+	static void spoke(uint16_t, uint8_t, uint8_t, uint8_t);
+	static void arc(uint8_t, uint16_t, uint16_t, uint8_t);
+	static void sector(uint16_t, uint16_t, uint8_t, uint8_t, uint8_t);
+	static void line(uint8_t, uint16_t, uint8_t, uint16_t, uint8_t);
+	static void polygon(const PolarPoint *, uint8_t, uint8_t);
+	static void regularPolygon(uint8_t, uint8_t, uint16_t, uint8_t);
+	static void curve(int32_t (*)(uint16_t), uint8_t);
+
+private:
+	static const uint8_t radiusShift = 8;		// Radii in 1/256 LED spacing
+	static const uint8_t stepsPerLed = 4;		// Line sampling density
+	static const uint16_t quarterWave = 128;	// sinTable covers 512 segments
+	static const int16_t sinTable[quarterWave + 1];
+	static uint8_t hubRadius;
+	static int16_t sinRevolution(uint16_t);
+	static uint16_t atan2Revolution(int32_t, int32_t);
+	static uint32_t isqrt(uint32_t);
+	static void putPixel(uint16_t, uint8_t, uint8_t);
+	static void fillRuns(uint16_t, uint16_t, uint8_t, uint8_t, uint8_t);
+	static void toCartesian(uint8_t, uint32_t, int32_t *, int32_t *);
+	static void cartesianLine(int32_t, int32_t, int32_t, int32_t, uint8_t);
+};
+
+#endif /* TEENSYPOVDRAW_H_ */
@@ -0,0 +1,208 @@
+/*
+ * TeensyPovFft.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovFft.h"
+
+/*
+ * 256 point fixed point FFT of real samples, grouped into up to 16 log spaced bands. All arithmetic is
+ * 16 x 16 -> 32 bit integer: Q15 samples and twiddles, each butterfly stage halved so the output can't
+ * overflow (the result is the transform divided by 256). Levels are log2 of the magnitude in 1/8 octave
+ * steps (0.75 dB), so 8 bit values cover the whole range.
+ */
+
+// sin(2 pi k / 256) for the first quarter, Q15
+const int16_t TeensyPovFft::sinTable[size / 4 + 1] = { 0, 804, 1608, 2410,
+		3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739, 9512, 10278, 11039,
+		11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530, 18204,
+		18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279,
+		24811, 25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898,
+		29268, 29621, 29956, 30273, 30571, 30852, 31113, 31356, 31580, 31785,
+		31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757, 32767 };
+
+// Periodic Hann window, first half (the second half mirrors it about sample 128), Q15
+const int16_t TeensyPovFft::hannTable[size / 2 + 1] = { 0, 5, 20, 44, 79, 123,
+		177, 241, 315, 398, 491, 593, 705, 827, 958, 1098, 1247, 1406, 1573,
+		1749, 1935, 2128, 2331, 2542, 2761, 2989, 3224, 3468, 3719, 3978, 4244,
+		4518, 4799, 5087, 5381, 5682, 5990, 6304, 6624, 6950, 7282, 7619, 7961,
+		8308, 8661, 9018, 9379, 9745, 10114, 10487, 10864, 11245, 11628, 12014,
+		12403, 12794, 13188, 13583, 13980, 14378, 14778, 15179, 15580, 15982,
+		16384, 16786, 17188, 17589, 17990, 18390, 18788, 19185, 19580, 19974,
+		20365, 20754, 21140, 21523, 21904, 22281, 22654, 23023, 23389, 23750,
+		24107, 24460, 24807, 25149, 25486, 25818, 26144, 26464, 26778, 27086,
+		27387, 27681, 27969, 28250, 28524, 28790, 29049, 29300, 29544, 29779,
+		30007, 30226, 30437, 30640, 30833, 31019, 31195, 31362, 31521, 31670,
+		31810, 31941, 32063, 32175, 32277, 32370, 32453, 32527, 32591, 32645,
+		32689, 32724, 32748, 32763, 32767 };
+
+// First bin of each of 16 bands, about 128 ^ (band / 16); fewer bands use every 2nd, 4th ... edge
+const uint8_t TeensyPovFft::bandEdges[maxBands + 1] = { 1, 2, 3, 4, 5, 6, 7, 8,
+		11, 15, 21, 28, 38, 52, 70, 95, 128 };
+
+TeensyPovFft::TeensyPovFft(uint8_t n) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	uint8_t n -- Number of bands: 1, 2, 4, 8 or 16.
+	 */
+	numBands = maxBands;
+	setBands(n);
+	for (uint8_t band = 0; band < maxBands; band++) {
+		levels[band] = 0;
+	}
+}
+
+bool TeensyPovFft::setBands(uint8_t n) {
+	/*
+	 * Returns:
+	 * 	false unless n is 1, 2, 4, 8 or 16.
+	 */
+	if (n == 0 || n > maxBands || (maxBands % n) != 0 || (n & (n - 1)) != 0) {
+		return false;
+	}
+	numBands = n;
+	return true;
+}
+
+uint8_t TeensyPovFft::getNumBands() {
+	return numBands;
+}
+
+const uint8_t *TeensyPovFft::getLevels() {
+	/*
+	 * Returns:
+	 * 	The level of each band from the last analyze(), lowest frequencies first (see logLevel()).
+	 */
+	return levels;
+}
+
+uint8_t TeensyPovFft::getLevel() {
+	/*
+	 * Returns:
+	 * 	Peak level of the last window of samples, on the same scale as the bands.
+	 */
+	return level;
+}
+
+uint8_t TeensyPovFft::logLevel(uint32_t magnitude) {
+	/*
+	 * Returns:
+	 * 	8 * log2(magnitude), 0 for 0. A full scale sine wave gives a band level of about 104, and each halving
+	 * 	of its amplitude takes 8 off.
+	 */
+	uint8_t msb = 0;
+
+	if (magnitude == 0) {
+		return 0;
+	}
+	while (magnitude >> (msb + 1)) {
+		msb++;
+	}
+	// Top 3 bits below the leading one approximate the fraction
+	if (msb >= 3) {
+		magnitude >>= msb - 3;
+	} else {
+		magnitude <<= 3 - msb;
+	}
+	return (msb << 3) + (magnitude & 7);
+}
+
+int16_t TeensyPovFft::sine(uint16_t index) {
+	// sin(2 pi index / 256) for index 0 - 128
+	return (index <= size / 4) ? sinTable[index] : sinTable[size / 2 - index];
+}
+
+void TeensyPovFft::analyze(const int16_t *samples) {
+	/*
+	 * Window 256 samples and work out the band levels.
+	 * Parameters:
+	 * 	const int16_t *samples -- 256 signed samples, oldest first. Any DC offset is removed.
+	 */
+	int32_t sum = 0, sample;
+	uint32_t peak = 0, magnitude, bandPeak, absRe, absIm;
+	uint16_t index, bin, first, last;
+	uint8_t band, step = maxBands / numBands;
+
+	for (index = 0; index < size; index++) {
+		sum += samples[index];
+	}
+	sum >>= logSize;
+	for (index = 0; index < size; index++) {
+		sample = samples[index] - sum;
+		if (sample > 32767) {
+			sample = 32767;
+		} else if (sample < -32767) {
+			sample = -32767;
+		}
+		if ((uint32_t) (sample < 0 ? -sample : sample) > peak) {
+			peak = (sample < 0) ? -sample : sample;
+		}
+		re[index] = (sample
+				* hannTable[(index <= size / 2) ? index : size - index]) >> 15;
+		im[index] = 0;
+	}
+	level = logLevel(peak);
+
+	transform();
+
+	// Band level from its loudest bin; |z| ~ max + 3/8 min (within 7%)
+	for (band = 0; band < numBands; band++) {
+		first = bandEdges[band * step];
+		last = bandEdges[(band + 1) * step];
+		bandPeak = 0;
+		for (bin = first; bin < last; bin++) {
+			absRe = (re[bin] < 0) ? -re[bin] : re[bin];
+			absIm = (im[bin] < 0) ? -im[bin] : im[bin];
+			magnitude = (absRe > absIm) ?
+					absRe + ((3 * absIm) >> 3) : absIm + ((3 * absRe) >> 3);
+			if (magnitude > bandPeak) {
+				bandPeak = magnitude;
+			}
+		}
+		levels[band] = logLevel(bandPeak);
+	}
+}
+
+void TeensyPovFft::transform() {
+	// In place radix 2 decimation in time, halving at each stage
+	uint16_t index, reversed, half, span, k, twiddle, top, bottom;
+	int32_t cosW, sinW, tRe, tIm, uRe, uIm;
+	int16_t swap;
+
+	for (index = 0; index < size; index++) {
+		reversed = 0;
+		for (k = 0; k < logSize; k++) {
+			reversed |= ((index >> k) & 1) << (logSize - 1 - k);
+		}
+		if (reversed > index) {
+			swap = re[index];
+			re[index] = re[reversed];
+			re[reversed] = swap;
+		}
+	}
+
+	for (span = 2; span <= size; span <<= 1) {
+		half = span >> 1;
+		for (k = 0; k < half; k++) {
+			twiddle = k * (size / span);					// 0 - 127
+			sinW = sine(twiddle);
+			cosW = (twiddle <= size / 4) ?
+					sine(size / 4 - twiddle) : -sine(twiddle - size / 4);
+			for (top = k; top < size; top += span) {
+				bottom = top + half;
+				// bottom * (cos - j sin)
+				tRe = (re[bottom] * cosW + im[bottom] * sinW) >> 15;
+				tIm = (im[bottom] * cosW - re[bottom] * sinW) >> 15;
+				uRe = re[top];
+				uIm = im[top];
+				re[top] = (uRe + tRe) >> 1;
+				im[top] = (uIm + tIm) >> 1;
+				re[bottom] = (uRe - tRe) >> 1;
+				im[bottom] = (uIm - tIm) >> 1;
+			}
+		}
+	}
+}
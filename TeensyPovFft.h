@@ -0,0 +1,39 @@
+/*
+ * TeensyPovFft.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVFFT_H_
+#define TEENSYPOVFFT_H_
+
+// No Arduino dependencies, so the host tools (extras/host/povaudio.cpp) run the same analysis
+#include <stdint.h>
+
+class TeensyPovFft {
+public:
+	static const uint8_t logSize = 8;
+	static const uint16_t size = 1 << logSize;			// Samples per analysis
+	static const uint8_t maxBands = 16;
+	TeensyPovFft(uint8_t = maxBands);
+	bool setBands(uint8_t);
+	uint8_t getNumBands(void);
+	void analyze(const int16_t *);
+	const uint8_t *getLevels(void);
+	uint8_t getLevel(void);
+	static uint8_t logLevel(uint32_t);
+
+private:
+	static const int16_t sinTable[size / 4 + 1];
+	static const int16_t hannTable[size / 2 + 1];
+	static const uint8_t bandEdges[maxBands + 1];
+	int16_t re[size], im[size];
+	uint8_t numBands;
+	uint8_t levels[maxBands];
+	uint8_t level = 0;
+	static int16_t sine(uint16_t);
+	void transform(void);
+};
+
+#endif /* TEENSYPOVFFT_H_ */
@@ -0,0 +1,393 @@
+/*
+ * TeensyPovLayer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovLayer.h"
+
+/*
+ * Layers hold segment data in the same packed format as the display (one row of TeensyPOV::maxColumns words
+ * per segment), so the usual drawing functions can draw into them between beginDraw() and endDraw().
+ * Each layer remembers which segments it changed. The compositor merges the layers, lowest z first, into the
+ * draw buffer for those segments only, a whole word of pixels at a time. A layer also remembers the number of
+ * segments it was drawn for: when the governor changes it the rows are resampled with the display's, and a
+ * layer that can't follow (too small, or drawn for another configuration) isn't composited until redrawn.
+ */
+
+TeensyPovLayer::TeensyPovLayer(uint32_t *buffer, uint32_t words, int8_t zOrder,
+		int16_t transparentColor) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	uint32_t *buffer -- Segment data, at least bufferWords(log number of segments) words. The array pointed
+	 * 		to must be static or global.
+	 *
+	 * 	uint32_t words -- Size of buffer.
+	 *
+	 * 	int8_t zOrder -- Layers with higher z are drawn over those with lower z.
+	 *
+	 * 	int16_t transparentColor -- Palette index that lets the layers below show through, -1 for an opaque layer.
+	 */
+	rows = (TeensyPOV::SegmentRow *) buffer;
+	capacity = words;
+	z = zOrder;
+	transparent = transparentColor;
+	memset(dirty, 0xFF, sizeof(dirty));
+}
+
+bool TeensyPovLayer::fits() {
+	return capacity
+			>= TeensyPOV::currentNumSegments * (uint32_t) TeensyPOV::maxColumns;
+}
+
+bool TeensyPovLayer::prepare() {
+	// Ready the rows for drawing at the current number of segments, clearing them if drawn for another
+	uint32_t pattern, segment, column;
+
+	if (!fits()) {
+		return false;
+	}
+	if (logNumSegments != TeensyPOV::currentLogNumSegments) {
+		pattern = (transparent < 0) ? 0 : (transparent & TeensyPOV::currentColorMask)
+				* (0xFFFFFFFFUL / TeensyPOV::currentColorMask);
+		for (segment = 0; segment < TeensyPOV::currentNumSegments; segment++) {
+			for (column = 0; column < TeensyPOV::maxColumns; column++) {
+				rows[segment][column] = pattern;
+			}
+		}
+		logNumSegments = TeensyPOV::currentLogNumSegments;
+		touch(0, TeensyPOV::currentNumSegments);
+	}
+	return true;
+}
+
+void TeensyPovLayer::resample(uint8_t fromLog, uint8_t toLog) {
+	// Follow the display from fromLog to toLog segments, as TeensyPOV::resample()
+	if (logNumSegments != fromLog
+			|| capacity < (1UL << toLog) * TeensyPOV::maxColumns) {
+		return;
+	}
+	TeensyPOV::resampleRows(rows, rows, fromLog, toLog, TeensyPOV::maxColumns);
+	logNumSegments = toLog;
+	touch(0, TeensyPOV::currentNumSegments);
+}
+
+bool TeensyPovLayer::needsRedraw() {
+	/*
+	 * Returns:
+	 * 	true if the layer was drawn for another number of segments (or not at all) and couldn't be resampled,
+	 * 	e.g. after the governor raised the resolution beyond the layer buffer. It isn't composited until drawn
+	 * 	again; the first drawing function called clears it.
+	 */
+	return logNumSegments != TeensyPOV::currentLogNumSegments;
+}
+
+void TeensyPovLayer::setTransparent(int16_t color) {
+	transparent = color;
+	touch(0, TeensyPOV::currentNumSegments);
+}
+
+void TeensyPovLayer::setVisible(bool show) {
+	if (show != visible) {
+		visible = show;
+		touch(0, TeensyPOV::currentNumSegments);
+	}
+}
+
+bool TeensyPovLayer::isVisible() {
+	return visible;
+}
+
+void TeensyPovLayer::setZ(int8_t zOrder) {
+	z = zOrder;
+	touch(0, TeensyPOV::currentNumSegments);
+}
+
+int8_t TeensyPovLayer::getZ() {
+	return z;
+}
+
+void TeensyPovLayer::fill(uint8_t color) {
+	/*
+	 * Set every pixel of the layer.
+	 * Parameters:
+	 * 	uint8_t color -- Color expressed as index into current Palette.
+	 */
+	uint32_t pattern, segment, column;
+
+	if (!fits()) {
+		return;
+	}
+	pattern = (color & TeensyPOV::currentColorMask)
+			* (0xFFFFFFFFUL / TeensyPOV::currentColorMask);
+	for (segment = 0; segment < TeensyPOV::currentNumSegments; segment++) {
+		for (column = 0; column < TeensyPOV::maxColumns; column++) {
+			rows[segment][column] = pattern;
+		}
+	}
+	logNumSegments = TeensyPOV::currentLogNumSegments;
+	touch(0, TeensyPOV::currentNumSegments);
+}
+
+void TeensyPovLayer::clear() {
+	/*
+	 * Fill with the transparent color (or color 0 for an opaque layer).
+	 */
+	fill((transparent < 0) ? 0 : transparent);
+}
+
+void TeensyPovLayer::setPixel(uint16_t segment, uint16_t led, uint8_t color) {
+	/*
+	 * As TeensyPOV::setPixel(), in this layer.
+	 */
+	uint8_t pixelWord, pixelShift;
+	uint32_t pixelMask;
+
+	if (segment >= TeensyPOV::currentNumSegments || led >= TeensyPOV::numLeds
+			|| !prepare()) {
+		return;
+	}
+	pixelWord = led / TeensyPOV::pixelsPerWord;
+	pixelShift = (led % TeensyPOV::pixelsPerWord) * TeensyPOV::currentNumColorBits;
+	pixelMask = TeensyPOV::currentColorMask << pixelShift;
+	rows[segment][pixelWord] = (rows[segment][pixelWord] & ~pixelMask)
+			| (((uint32_t) color << pixelShift) & pixelMask);
+	dirty[segment >> 5] |= 1UL << (segment & 31);
+}
+
+void TeensyPovLayer::loadPattern(const LedArrayStruct *pattern) {
+	/*
+	 * Draw a bit map image over the whole layer, e.g. as a background.
+	 */
+	if (beginDraw()) {
+		TeensyPOV::loadPattern(pattern);
+		endDraw();
+	}
+}
+
+void TeensyPovLayer::drawString(const DisplayStringSpec *spec) {
+	/*
+	 * Draw text as TeensyPovDisplay does. Only the segments under the text are marked as changed.
+	 */
+	uint8_t columns[TeensyPOV::maxTextChars * TeensyPOV::charColumns + 1];
+	TextLayout layout;
+
+	if (!TeensyPOV::compileString(spec, &layout, columns, sizeof(columns))
+			|| !beginDraw()) {
+		return;
+	}
+	TeensyPOV::drawLayout(&layout, columns, spec->textColor,
+			spec->backgroundColor);
+	endDraw(layout.firstSegment, layout.numColumns);
+}
+
+bool TeensyPovLayer::beginDraw() {
+	/*
+	 * Point the drawing functions (TeensyPOV::setPixel(), TeensyPovDraw, etc.) at this layer until endDraw().
+	 * Don't use functions that call TeensyPOV::beginFrame() (TeensyPovCanvas, TeensyPovMarquee) in between.
+	 * Returns:
+	 * 	false if the layer buffer is too small for the current number of segments.
+	 */
+	if (savedDrawArray || !prepare()) {
+		return false;
+	}
+	noInterrupts();
+	// A swap still waiting for Top Dead Center would show the layer, hold it until endDraw()
+	savedSwapPending = TeensyPOV::bufferSwapPending;
+	TeensyPOV::bufferSwapPending = false;
+	savedDrawArray = TeensyPOV::drawArray;
+	TeensyPOV::drawArray = rows;
+	interrupts();
+	return true;
+}
+
+void TeensyPovLayer::endDraw() {
+	/*
+	 * Finish drawing started by beginDraw(), marking the whole layer as changed.
+	 */
+	endDraw(0, TeensyPOV::currentNumSegments);
+}
+
+void TeensyPovLayer::endDraw(uint16_t firstSegment, uint16_t numSegments) {
+	/*
+	 * Finish drawing started by beginDraw().
+	 * Parameters:
+	 * 	uint16_t firstSegment, numSegments -- The segments drawn (wrapping past the last segment), so only they
+	 * 		are composited.
+	 */
+	if (!savedDrawArray) {
+		return;
+	}
+	noInterrupts();
+	TeensyPOV::drawArray = savedDrawArray;
+	TeensyPOV::bufferSwapPending = savedSwapPending;
+	interrupts();
+	savedDrawArray = nullptr;
+	touch(firstSegment, numSegments);
+}
+
+void TeensyPovLayer::touch(uint16_t firstSegment, uint16_t numSegments) {
+	/*
+	 * Mark segments as changed, e.g. after writing the layer buffer directly.
+	 */
+	uint16_t segment;
+
+	if (numSegments >= TeensyPOV::currentNumSegments) {
+		memset(dirty, 0xFF, sizeof(dirty));
+		return;
+	}
+	while (numSegments--) {
+		segment = firstSegment++ & TeensyPOV::currentSegmentMask;
+		dirty[segment >> 5] |= 1UL << (segment & 31);
+	}
+}
+
+bool TeensyPovCompositor::add(TeensyPovLayer *layer) {
+	/*
+	 * Add a layer. The layer object must be static or global.
+	 * Returns:
+	 * 	false if there are already 8 layers.
+	 */
+	if (numLayers >= maxLayers) {
+		return false;
+	}
+	layers[numLayers++] = layer;
+	layer->touch(0, TeensyPOV::currentNumSegments);
+	return true;
+}
+
+void TeensyPovCompositor::remove(TeensyPovLayer *layer) {
+	uint8_t index;
+
+	for (index = 0; index < numLayers; index++) {
+		if (layers[index] == layer) {
+			memmove(layers + index, layers + index + 1,
+					(numLayers - index - 1) * sizeof(layers[0]));
+			numLayers--;
+			allDirty = true;
+			return;
+		}
+	}
+}
+
+void TeensyPovCompositor::invalidate() {
+	/*
+	 * Composite every segment next time, e.g. after something else has drawn into the display.
+	 */
+	allDirty = true;
+}
+
+void TeensyPovCompositor::resample(uint8_t fromLog, uint8_t toLog) {
+	// Called by TeensyPovDisplay when its governor has resampled the display, before compositing again
+	uint8_t index;
+
+	for (index = 0; index < numLayers; index++) {
+		layers[index]->resample(fromLog, toLog);
+	}
+	allDirty = true;
+}
+
+bool TeensyPovCompositor::composite() {
+	/*
+	 * Merge the segments changed in any layer into the display, wrapped in beginFrame() / endFrame().
+	 * Returns:
+	 * 	false if nothing had changed.
+	 */
+	uint8_t index;
+	uint32_t word;
+	bool changed = allDirty;
+
+	for (index = 0; index < numLayers && !changed; index++) {
+		for (word = 0; word < TeensyPovLayer::dirtyWords && !changed; word++) {
+			changed = layers[index]->dirty[word] != 0;
+		}
+	}
+	if (!changed) {
+		return false;
+	}
+	TeensyPOV::beginFrame();
+	compositeSegments();
+	TeensyPOV::endFrame();
+	return true;
+}
+
+static inline uint32_t opaqueMask(uint32_t difference, uint8_t bits) {
+	// All ones over each pixel of difference that isn't zero (SWAR: fold each pixel onto its lowest bit, then spread)
+	switch (bits) {
+	case 1:
+		return difference;
+	case 2:
+		difference |= difference >> 1;
+		return (difference & 0x55555555UL) * 0x3;
+	case 4:
+		difference |= difference >> 1;
+		difference |= difference >> 2;
+		return (difference & 0x11111111UL) * 0xF;
+	default:
+		difference |= difference >> 1;
+		difference |= difference >> 2;
+		difference |= difference >> 4;
+		return (difference & 0x01010101UL) * 0xFF;
+	}
+}
+
+void TeensyPovCompositor::compositeSegments() {
+	TeensyPovLayer *active[maxLayers], *layer;
+	uint32_t transparentPattern[maxLayers];
+	uint32_t pending[TeensyPovLayer::dirtyWords];
+	uint32_t replicate = 0xFFFFFFFFUL / TeensyPOV::currentColorMask;
+	uint32_t words = (TeensyPOV::currentNumSegments + 31) / 32;
+	uint32_t columns = (TeensyPOV::numLeds * TeensyPOV::currentNumColorBits + 31)
+			/ 32;
+	uint32_t word, bit, pixels, mask, out, segment, column;
+	uint8_t bits = TeensyPOV::currentNumColorBits, index, numActive = 0;
+	int8_t slot;
+
+	// Visible layers in z order; the dirty segments of hidden ones still need compositing
+	memset(pending, allDirty ? 0xFF : 0, sizeof(pending));
+	for (index = 0; index < numLayers; index++) {
+		layer = layers[index];
+		for (word = 0; word < words; word++) {
+			pending[word] |= layer->dirty[word];
+		}
+		memset(layer->dirty, 0, sizeof(layer->dirty));
+		if (!layer->visible || layer->needsRedraw()) {
+			continue;
+		}
+		for (slot = numActive - 1; slot >= 0 && active[slot]->z > layer->z; slot--) {
+			active[slot + 1] = active[slot];
+			transparentPattern[slot + 1] = transparentPattern[slot];
+		}
+		active[slot + 1] = layer;
+		transparentPattern[slot + 1] = (layer->transparent < 0) ? 0 :
+				(layer->transparent & TeensyPOV::currentColorMask) * replicate;
+		numActive++;
+	}
+	allDirty = false;
+	if (TeensyPOV::currentNumSegments < 32) {
+		pending[0] &= (1UL << TeensyPOV::currentNumSegments) - 1;
+	}
+
+	for (word = 0; word < words; word++) {
+		while (pending[word]) {
+			bit = __builtin_ctz(pending[word]);
+			pending[word] &= pending[word] - 1;
+			segment = word * 32 + bit;
+			for (column = 0; column < columns; column++) {
+				out = 0;
+				for (index = 0; index < numActive; index++) {
+					pixels = active[index]->rows[segment][column];
+					if (active[index]->transparent < 0) {
+						out = pixels;
+					} else {
+						mask = opaqueMask(pixels ^ transparentPattern[index], bits);
+						out = (out & ~mask) | (pixels & mask);
+					}
+				}
+				TeensyPOV::drawArray[segment][column] = out;
+			}
+		}
+	}
+}
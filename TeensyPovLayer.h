@@ -0,0 +1,71 @@
+/*
+ * TeensyPovLayer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVLAYER_H_
+#define TEENSYPOVLAYER_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+
+class TeensyPovLayer {
+	friend class TeensyPovCompositor;
+private:
+	static const uint32_t dirtyWords = (TeensyPOV::maxNumSegments + 31) / 32;
+	TeensyPOV::SegmentRow *rows;
+	uint32_t capacity;
+	int8_t z;
+	int16_t transparent;
+	bool visible = true;
+	uint8_t logNumSegments = 0;						// Number of segments the rows were drawn for, 0 = not drawn
+	uint32_t dirty[dirtyWords];						// One bit per segment drawn since the last composite
+	TeensyPOV::SegmentRow *savedDrawArray = nullptr;
+	bool savedSwapPending = false;
+	bool fits(void);
+	bool prepare(void);
+	void resample(uint8_t, uint8_t);
+
+public:
+	// Words of layer buffer needed for a number of segments
+	static constexpr uint32_t bufferWords(uint8_t logNumSegments) {
+		return (1UL << logNumSegments) * TeensyPOV::maxColumns;
+	}
+	TeensyPovLayer(uint32_t *, uint32_t, int8_t = 0, int16_t = 0);
+	void setTransparent(int16_t);
+	void setVisible(bool);
+	bool isVisible(void);
+	void setZ(int8_t);
+	int8_t getZ(void);
+	void fill(uint8_t);
+	void clear(void);
+	void setPixel(uint16_t, uint16_t, uint8_t);
+	void loadPattern(const LedArrayStruct *);
+	void drawString(const DisplayStringSpec *);
+	bool beginDraw(void);
+	void endDraw(void);
+	void endDraw(uint16_t, uint16_t);
+	void touch(uint16_t, uint16_t);
+	bool needsRedraw(void);
+};
+
+class TeensyPovCompositor {
+	friend class TeensyPovDisplay;
+private:
+	static const uint8_t maxLayers = 8;
+	TeensyPovLayer *layers[maxLayers];
+	uint8_t numLayers = 0;
+	bool allDirty = true;
+	void compositeSegments(void);
+	void resample(uint8_t, uint8_t);
+
+public:
+	bool add(TeensyPovLayer *);
+	void remove(TeensyPovLayer *);
+	void invalidate(void);
+	bool composite(void);
+};
+
+#endif /* TEENSYPOVLAYER_H_ */
@@ -0,0 +1,273 @@
+/*
+ * TeensyPovMarquee.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovMarquee.h"
+
+/*
+ * The window is a ring buffer of font columns (bit 0 = innermost LED of the band). Each scroll step
+ * renders just the one column entering at the right and moves the ring's head, so the cost follows the
+ * scroll speed, not the length of the text. Window positions whose column didn't change aren't redrawn.
+ */
+
+TeensyPovMarquee::TeensyPovMarquee(TextPosition pos, uint8_t top,
+		uint16_t windowSegments, bool inv) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	TextPosition pos -- Center the window at the TOP or BOTTOM of the display, as loadString().
+	 *
+	 * 	uint8_t top -- Outermost LED of the 7 LED high band, at least 6.
+	 *
+	 * 	uint16_t windowSegments -- Width of the window in segments (7 per character). Limited to half the
+	 * 		current number of segments.
+	 *
+	 * 	bool inv -- Turn the characters over, e.g. so BOTTOM text reads left to right.
+	 */
+	position = pos;
+	topLed = top;
+	width = (windowSegments > maxWindow) ? maxWindow : windowSegments;
+	invert = inv;
+	memset(ring, 0, sizeof(ring));
+	memset(shown, unshown, sizeof(shown));
+}
+
+void TeensyPovMarquee::setColors(uint8_t color, uint8_t background) {
+	/*
+	 * Parameters:
+	 * 	uint8_t color, background -- Colors expressed as index into current Palette.
+	 */
+	textColor = color;
+	backgroundColor = background;
+	redraw();
+}
+
+void TeensyPovMarquee::setSpeed(uint16_t columnsPerSecond) {
+	/*
+	 * Set the scroll speed used by update(). Zero stops the marquee (step() still works).
+	 */
+	speed = columnsPerSecond;
+	stepTimer = millis();
+	stepRemainder = 0;
+}
+
+void TeensyPovMarquee::setText(const char *string, bool repeat) {
+	/*
+	 * Scroll a string of any length. Characters from append() follow it unless it repeats.
+	 * Parameters:
+	 * 	const char *string -- Text, not copied. The string pointed to must be static or global.
+	 *
+	 * 	bool repeat -- Start again after the last character.
+	 */
+	noInterrupts();
+	text = string;
+	nextChar = string;
+	loop = repeat;
+	blankColumns = 0;
+	interrupts();
+}
+
+bool TeensyPovMarquee::append(char character) {
+	/*
+	 * Queue a character to scroll after the current text, e.g. as it is received. May be called from an interrupt.
+	 * Returns:
+	 * 	false if the queue is full.
+	 */
+	uint8_t next = (fifoHead + 1) & (fifoSize - 1);
+
+	if (next == fifoTail) {
+		return false;
+	}
+	fifo[fifoHead] = character;
+	fifoHead = next;
+	blankColumns = 0;
+	return true;
+}
+
+uint16_t TeensyPovMarquee::append(const char *string) {
+	/*
+	 * Returns:
+	 * 	Number of characters queued.
+	 */
+	uint16_t count = 0;
+
+	while (string[count] != '\0' && append(string[count])) {
+		count++;
+	}
+	return count;
+}
+
+void TeensyPovMarquee::clear() {
+	/*
+	 * Drop the text and any queued characters and blank the window.
+	 */
+	noInterrupts();
+	text = nullptr;
+	nextChar = nullptr;
+	fifoTail = fifoHead;
+	interrupts();
+	charColumn = charColumns;
+	blankColumns = maxWindow;
+	memset(ring, 0, sizeof(ring));
+	redraw();
+}
+
+void TeensyPovMarquee::redraw() {
+	/*
+	 * Draw the whole window again, e.g. after something else has drawn over its band.
+	 */
+	memset(shown, unshown, sizeof(shown));
+	if (layoutLogNumSegments != TeensyPOV::currentLogNumSegments) {
+		layout();
+	}
+	drawWindow();
+}
+
+bool TeensyPovMarquee::idle() {
+	/*
+	 * Returns:
+	 * 	true once all the text has scrolled out of the window.
+	 */
+	return blankColumns >= windowWidth;
+}
+
+void TeensyPovMarquee::step(uint16_t columns) {
+	/*
+	 * Scroll left by a number of columns (segments), e.g. once per revolution from a frame callback.
+	 */
+	if (layoutLogNumSegments != TeensyPOV::currentLogNumSegments) {
+		layout();
+	}
+	if (columns == 0 || windowWidth == 0) {
+		return;
+	}
+	while (columns--) {
+		ring[ringHead] = nextColumn();
+		if (++ringHead == windowWidth) {
+			ringHead = 0;
+		}
+	}
+	drawWindow();
+}
+
+bool TeensyPovMarquee::update() {
+	/*
+	 * Scroll at the speed set by setSpeed(). Call from loop().
+	 * Returns:
+	 * 	true once all the text has scrolled out of the window.
+	 */
+	uint32_t currentMillis = millis(), elapsed;
+
+	if (speed > 0) {
+		elapsed = (currentMillis - stepTimer) * speed + stepRemainder;
+		stepRemainder = elapsed % 1000;
+		step(elapsed / 1000);
+	}
+	stepTimer = currentMillis;
+	return idle();
+}
+
+bool TeensyPovMarquee::nextCharacter() {
+	char character;
+
+	if (nextChar && *nextChar == '\0' && loop) {
+		nextChar = text;
+	}
+	if (nextChar && *nextChar != '\0') {
+		character = *nextChar++;
+	} else if (fifoTail != fifoHead) {
+		character = fifo[fifoTail];
+		fifoTail = (fifoTail + 1) & (fifoSize - 1);
+	} else {
+		return false;
+	}
+	textCharacters::getMatrix(character, charMatrix, invert);
+	return true;
+}
+
+uint8_t TeensyPovMarquee::nextColumn() {
+	uint8_t column;
+
+	if (charColumn >= charColumns) {
+		if (!nextCharacter()) {
+			if (blankColumns < maxWindow) {
+				blankColumns++;
+			}
+			return 0;
+		}
+		charColumn = 0;
+		blankColumns = 0;
+	}
+	column = charColumn++;
+	if (column == 0 || column == charColumns - 1) {
+		return 0;
+	}
+	// getMatrix() reverses the columns when inverting; the window is then drawn right to left
+	return invert ? charMatrix[5 - column] : charMatrix[column - 1];
+}
+
+void TeensyPovMarquee::layout() {
+	// Fit the window to the number of segments, keeping its newest (rightmost) columns
+	uint8_t ordered[maxWindow];
+	uint16_t numSegments = TeensyPOV::currentNumSegments;
+	uint16_t newWidth = min(width, (uint16_t) (numSegments / 2));
+	uint16_t index, oldWidth = windowWidth;
+
+	for (index = 0; index < oldWidth; index++) {
+		ordered[index] = ring[(ringHead + index) % oldWidth];
+	}
+	for (index = 0; index < newWidth; index++) {
+		ring[index] = (index + oldWidth >= newWidth) ?
+				ordered[index + oldWidth - newWidth] : 0;
+	}
+	ringHead = 0;
+	windowWidth = newWidth;
+	firstSegment = ((position == TOP) ? 3 * numSegments / 4 : numSegments / 4)
+			+ 1 + (numSegments / 2 - newWidth) / 2;
+	layoutLogNumSegments = TeensyPOV::currentLogNumSegments;
+	memset(shown, unshown, sizeof(shown));
+}
+
+void TeensyPovMarquee::drawWindow() {
+	uint8_t bits = TeensyPOV::currentNumColorBits;
+	uint32_t colorMask = TeensyPOV::currentColorMask;
+	uint8_t wordIndex[7], shift[7], led, column;
+	uint32_t mask[7];
+	uint16_t window, index, segment;
+	bool reversed = (position == BOTTOM) && invert;
+	volatile uint32_t *row;
+
+	if (topLed >= TeensyPOV::numLeds || topLed < 6 || windowWidth == 0) {
+		return;
+	}
+	for (led = 0; led < 7; led++) {
+		wordIndex[led] = (topLed - 6 + led) * bits / 32;
+		shift[led] = (topLed - 6 + led) * bits % 32;
+		mask[led] = colorMask << shift[led];
+	}
+
+	TeensyPOV::beginFrame();
+	index = ringHead;
+	for (window = 0; window < windowWidth; window++) {
+		column = ring[index];
+		if (++index == windowWidth) {
+			index = 0;
+		}
+		if (column == shown[window]) {
+			continue;
+		}
+		shown[window] = column;
+		segment = (firstSegment + (reversed ? windowWidth - 1 - window : window))
+				& TeensyPOV::currentSegmentMask;
+		row = TeensyPOV::drawArray[segment];
+		for (led = 0; led < 7; led++) {
+			row[wordIndex[led]] = (row[wordIndex[led]] & ~mask[led])
+					| (((uint32_t) (((column >> led) & 1) ? textColor : backgroundColor)
+							<< shift[led]) & mask[led]);
+		}
+	}
+	TeensyPOV::endFrame();
+}
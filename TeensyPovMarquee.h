@@ -0,0 +1,60 @@
+/*
+ * TeensyPovMarquee.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVMARQUEE_H_
+#define TEENSYPOVMARQUEE_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+#include "textCharacters.h"
+
+class TeensyPovMarquee {
+private:
+	static const uint16_t maxWindow = 256;			// Half of the most segments
+	static const uint8_t fifoSize = 128;			// Power of 2
+	static const uint8_t charColumns = 7;			// Blank, 5 font columns, blank
+	static const uint8_t unshown = 0xFF;			// Font columns are 7 bits
+	TextPosition position;
+	uint8_t topLed;
+	uint16_t width;
+	bool invert;
+	uint8_t textColor = 1, backgroundColor = 0;
+	const char *text = nullptr, *nextChar = nullptr;
+	bool loop = false;
+	char fifo[fifoSize];
+	volatile uint8_t fifoHead = 0, fifoTail = 0;
+	uint8_t charMatrix[5];
+	uint8_t charColumn = charColumns;
+	bool charBlank = true;
+	uint16_t blankColumns = maxWindow;
+	uint8_t ring[maxWindow];						// Font columns in the window, oldest (leftmost) at ringHead
+	uint8_t shown[maxWindow];						// What each window position has drawn
+	uint16_t ringHead = 0;
+	uint16_t windowWidth = 0, firstSegment = 0;
+	uint8_t layoutLogNumSegments = 0;
+	uint16_t speed = 0;
+	uint32_t stepTimer = 0, stepRemainder = 0;
+	bool nextCharacter(void);
+	uint8_t nextColumn(void);
+	void layout(void);
+	void drawWindow(void);
+
+public:
+	TeensyPovMarquee(TextPosition, uint8_t, uint16_t, bool = false);
+	void setColors(uint8_t, uint8_t);
+	void setSpeed(uint16_t);
+	void setText(const char *, bool = false);
+	bool append(char);
+	uint16_t append(const char *);
+	void clear(void);
+	void redraw(void);
+	void step(uint16_t);
+	bool update(void);
+	bool idle(void);
+};
+
+#endif /* TEENSYPOVMARQUEE_H_ */
@@ -0,0 +1,210 @@
+/*
+ * TeensyPovPack.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Content packs: displays and animations in one file, read from an SD card by TeensyPovContent (regular
+ * files on the host) and built by extras/host/povpack. Shared with the host tools, so it must not depend
+ * on Arduino headers. Multi-byte values are little endian.
+ *
+ * 	Header (32 bytes):   "POVP", version (2), number of entries (2), directory offset (4), file size (4),
+ * 	                     log2 of the payload alignment (1), reserved (1), Fletcher-16 of the directory (2),
+ * 	                     reserved (12)
+ * 	Directory:           one povPackEntryLength entry per display, see PovPackEntry
+ * 	Palettes:            numPaletteEntries 0x00RRGGBB words (4) per display
+ * 	Frame tables:        numFrames povPackFrameLength entries per display, see PovPackFrame
+ * 	Payloads:            one per frame, each starting on a multiple of the payload alignment
+ *
+ * A raw payload is the frame's 2 ^ logNumSegments segments of wordsPerSegment words, packed as in the
+ * Bit Map Array (LED 0 in the low bits of the first word), exactly as TeensyPOV holds them: it is read
+ * straight into the segment buffer, or used in place from a memory mapped file. With POV_PACK_RLE the
+ * same words are run length coded, each run headed by a control word:
+ * 	bit 31 set    (bits 0 - 30) + 1 copies of the word that follows
+ * 	bit 31 clear  (bits 0 - 30) + 1 words that follow as they are
+ * Everything stays word aligned, so literal runs are read straight into the segment buffer too.
+ */
+
+#ifndef TEENSYPOVPACK_H_
+#define TEENSYPOVPACK_H_
+
+#include <stdint.h>
+#include "TeensyPovProtocol.h"
+
+static const uint16_t povPackVersion = 2;
+static const uint8_t povPackHeaderLength = 32;
+static const uint8_t povPackEntryLength = 32;
+static const uint8_t povPackFrameLength = 12;
+static const uint8_t povPackDefaultAlignment = 9;		// SD card sector
+
+static const uint16_t POV_PACK_RLE = 0x0001;			// PovPackFrame flags
+static const uint32_t povPackRunFlag = 0x80000000;
+
+struct PovPackHeader {
+	uint16_t numEntries;
+	uint32_t directoryOffset;
+	uint32_t fileSize;
+	uint8_t logAlignment;
+	uint16_t directoryChecksum;
+};
+
+struct PovPackEntry {
+	uint8_t logNumSegments;
+	uint8_t numColorBits;
+	uint8_t numLeds;
+	uint8_t wordsPerSegment;
+	uint16_t tdcSegment;
+	uint16_t numPaletteEntries;
+	uint16_t numFrames;
+	uint16_t frameInterval;			// ms between frames, 0 for a still
+	uint32_t duration;				// ms shown before the next entry, 0 for one pass (stills: until told)
+	uint32_t paletteOffset;
+	uint32_t frameTableOffset;
+	uint16_t flags;					// None defined, must be 0
+
+	uint32_t segmentBytes() const {
+		return (uint32_t) wordsPerSegment * 4;
+	}
+
+	uint32_t frameBytes() const {
+		return segmentBytes() << logNumSegments;
+	}
+};
+
+struct PovPackFrame {
+	uint32_t offset;
+	uint32_t length;				// Stored bytes
+	uint16_t checksum;				// Fletcher-16 of the stored bytes
+	uint16_t flags;
+};
+
+inline uint32_t povPackGet(const uint8_t *in, int bytes) {
+	uint32_t value = 0;
+
+	while (bytes--) {
+		value = (value << 8) | in[bytes];
+	}
+	return value;
+}
+
+inline void povPackPut(uint8_t *out, uint32_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out[i] = value >> (8 * i);
+	}
+}
+
+inline bool povPackParseHeader(const uint8_t *in, PovPackHeader *header) {
+	if (in[0] != 'P' || in[1] != 'O' || in[2] != 'V' || in[3] != 'P'
+			|| povPackGet(in + 4, 2) != povPackVersion) {
+		return false;
+	}
+	header->numEntries = povPackGet(in + 6, 2);
+	header->directoryOffset = povPackGet(in + 8, 4);
+	header->fileSize = povPackGet(in + 12, 4);
+	header->logAlignment = in[16];
+	header->directoryChecksum = povPackGet(in + 18, 2);
+	return true;
+}
+
+inline void povPackParseEntry(const uint8_t *in, PovPackEntry *entry) {
+	entry->logNumSegments = in[0];
+	entry->numColorBits = in[1];
+	entry->numLeds = in[2];
+	entry->wordsPerSegment = in[3];
+	entry->tdcSegment = povPackGet(in + 4, 2);
+	entry->numPaletteEntries = povPackGet(in + 6, 2);
+	entry->numFrames = povPackGet(in + 8, 2);
+	entry->frameInterval = povPackGet(in + 10, 2);
+	entry->duration = povPackGet(in + 12, 4);
+	entry->paletteOffset = povPackGet(in + 16, 4);
+	entry->frameTableOffset = povPackGet(in + 20, 4);
+	entry->flags = povPackGet(in + 24, 2);
+}
+
+inline void povPackParseFrame(const uint8_t *in, PovPackFrame *frame) {
+	frame->offset = povPackGet(in, 4);
+	frame->length = povPackGet(in + 4, 4);
+	frame->checksum = povPackGet(in + 8, 2);
+	frame->flags = povPackGet(in + 10, 2);
+}
+
+inline void povPackFormatHeader(uint8_t *out, const PovPackHeader *header) {
+	uint8_t index;
+
+	for (index = 0; index < povPackHeaderLength; index++) {
+		out[index] = 0;
+	}
+	out[0] = 'P';
+	out[1] = 'O';
+	out[2] = 'V';
+	out[3] = 'P';
+	povPackPut(out + 4, povPackVersion, 2);
+	povPackPut(out + 6, header->numEntries, 2);
+	povPackPut(out + 8, header->directoryOffset, 4);
+	povPackPut(out + 12, header->fileSize, 4);
+	out[16] = header->logAlignment;
+	povPackPut(out + 18, header->directoryChecksum, 2);
+}
+
+inline void povPackFormatEntry(uint8_t *out, const PovPackEntry *entry) {
+	uint8_t index;
+
+	for (index = 0; index < povPackEntryLength; index++) {
+		out[index] = 0;
+	}
+	out[0] = entry->logNumSegments;
+	out[1] = entry->numColorBits;
+	out[2] = entry->numLeds;
+	out[3] = entry->wordsPerSegment;
+	povPackPut(out + 4, entry->tdcSegment, 2);
+	povPackPut(out + 6, entry->numPaletteEntries, 2);
+	povPackPut(out + 8, entry->numFrames, 2);
+	povPackPut(out + 10, entry->frameInterval, 2);
+	povPackPut(out + 12, entry->duration, 4);
+	povPackPut(out + 16, entry->paletteOffset, 4);
+	povPackPut(out + 20, entry->frameTableOffset, 4);
+	povPackPut(out + 24, entry->flags, 2);
+}
+
+inline void povPackFormatFrame(uint8_t *out, const PovPackFrame *frame) {
+	povPackPut(out, frame->offset, 4);
+	povPackPut(out + 4, frame->length, 4);
+	povPackPut(out + 8, frame->checksum, 2);
+	povPackPut(out + 10, frame->flags, 2);
+}
+
+inline bool povPackDecodeRle(const uint8_t *in, uint32_t length, uint32_t *out, uint32_t numWords) {
+	// Whole payload at once. Returns false unless it decodes to exactly numWords words.
+	uint32_t control, count, value, done = 0;
+	const uint8_t *end = in + length;
+
+	while (in + 4 <= end) {
+		control = povPackGet(in, 4);
+		in += 4;
+		count = (control & ~povPackRunFlag) + 1;
+		if (count > numWords - done) {
+			return false;
+		}
+		if (control & povPackRunFlag) {
+			if (in + 4 > end) {
+				return false;
+			}
+			value = povPackGet(in, 4);
+			in += 4;
+			while (count--) {
+				out[done++] = value;
+			}
+		} else {
+			if (in + 4 * count > end) {
+				return false;
+			}
+			while (count--) {
+				out[done++] = povPackGet(in, 4);
+				in += 4;
+			}
+		}
+	}
+	return in == end && done == numWords;
+}
+
+#endif /* TEENSYPOVPACK_H_ */
@@ -0,0 +1,220 @@
+/*
+ * TeensyPovPalette.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovPalette.h"
+
+void TeensyPovPalette::cycle(const uint32_t *colors, uint8_t first,
+		uint8_t last, int8_t step, uint16_t revs) {
+	/*
+	 * Rotate a range of palette entries, e.g. for rainbow sweeps.
+	 * Parameters:
+	 * 	const uint32_t *colors -- Base palette. The array pointed to must be static or global.
+	 *
+	 * 	uint8_t first, last -- Range of palette indexes to rotate (inclusive). Other entries are copied unchanged.
+	 *
+	 * 	int8_t step -- Number of entries to rotate by each time.
+	 *
+	 * 	uint16_t revs -- Number of revolutions between steps.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (last < first || revs == 0) {
+		return;
+	}
+	fromColors = colors;
+	firstColor = first;
+	lastColor = last;
+	cycleStep = step;
+	revolutions = revs;
+	start(CYCLE);
+}
+
+void TeensyPovPalette::fade(const uint32_t *from, const uint32_t *to,
+		uint16_t revs) {
+	/*
+	 * Fade from one palette to another.
+	 * Parameters:
+	 * 	const uint32_t *from, *to -- Start and end palettes. The arrays pointed to must be static or global.
+	 *
+	 * 	uint16_t revs -- Length of the fade in revolutions.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (revs == 0) {
+		revs = 1;
+	}
+	fromColors = from;
+	toColors = to;
+	revolutions = revs;
+	start(FADE);
+}
+
+void TeensyPovPalette::sequence(const PaletteKeyframe *frames, uint8_t n,
+		bool repeat) {
+	/*
+	 * Fade through a sequence of palettes.
+	 * Parameters:
+	 * 	const PaletteKeyframe *frames -- Array of keyframes. Each one's 'revolutions' is the time taken to fade to the
+	 * 		next keyframe (zero for a cut). The array pointed to must be static or global.
+	 *
+	 * 	uint8_t n -- Number of keyframes in the array.
+	 *
+	 * 	bool repeat -- true to fade from the last keyframe back to the first and start over.
+	 *
+	 * Returns:
+	 * 	N/A
+	 */
+	if (n == 0) {
+		return;
+	}
+	keyframes = frames;
+	numKeyframes = n;
+	loop = repeat;
+	start(SEQUENCE);
+}
+
+void TeensyPovPalette::stop() {
+	mode = IDLE;
+}
+
+bool TeensyPovPalette::active() {
+	return mode != IDLE;
+}
+
+bool TeensyPovPalette::update() {
+	/*
+	 * Stage the next palette if a revolution has passed since the last call. Call from loop(),
+	 * TeensyPovDisplay::update() does this for an attached animation.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	true -- if the animation has finished (or none is running).
+	 * 	false -- otherwise.
+	 */
+	uint32_t revolution, elapsed;
+
+	if (mode == IDLE) {
+		return true;
+	}
+	revolution = TeensyPOV::getRevolutionCount();
+	if (revolution == lastRevolution) {
+		return false;
+	}
+	lastRevolution = revolution;
+	elapsed = revolution - startRevolution;
+
+	switch (mode) {
+	case CYCLE:
+		stageCycle(elapsed);
+		break;
+
+	case FADE:
+		if (elapsed >= revolutions) {
+			elapsed = revolutions;
+			mode = IDLE;
+		}
+		stageFade(fromColors, toColors, elapsed, revolutions);
+		break;
+
+	case SEQUENCE:
+		if (stageSequence(elapsed)) {
+			mode = IDLE;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return mode == IDLE;
+}
+
+void TeensyPovPalette::start(AnimationMode newMode) {
+	mode = newMode;
+	startRevolution = TeensyPOV::getRevolutionCount();
+	lastRevolution = startRevolution - 1;
+	lastCycleOffset = -1;
+}
+
+void TeensyPovPalette::stageCycle(uint32_t elapsed) {
+	volatile uint32_t *colors;
+	uint16_t numColors, length, index, offset;
+
+	length = lastColor - firstColor + 1;
+	offset = ((elapsed / revolutions) * (cycleStep % length + length)) % length;
+	if (offset == lastCycleOffset) {
+		return;
+	}
+	lastCycleOffset = offset;
+
+	numColors = TeensyPOV::getNumPaletteEntries();
+	colors = TeensyPOV::beginPalette();
+	for (index = 0; index < numColors; index++) {
+		if (index >= firstColor && index <= lastColor) {
+			colors[index] = fromColors[firstColor
+					+ (index - firstColor + offset) % length];
+		} else {
+			colors[index] = fromColors[index];
+		}
+	}
+	TeensyPOV::commitPalette();
+}
+
+void TeensyPovPalette::stageFade(const uint32_t *from, const uint32_t *to,
+		uint32_t elapsed, uint32_t length) {
+	volatile uint32_t *colors;
+	uint16_t numColors, index, weight;
+
+	weight = (elapsed << 8) / length;
+	numColors = TeensyPOV::getNumPaletteEntries();
+	colors = TeensyPOV::beginPalette();
+	for (index = 0; index < numColors; index++) {
+		colors[index] = blend(from[index], to[index], weight);
+	}
+	TeensyPOV::commitPalette();
+}
+
+bool TeensyPovPalette::stageSequence(uint32_t elapsed) {
+	const PaletteKeyframe *current, *next;
+	uint32_t total = 0;
+	uint8_t index;
+
+	for (index = 0; index < numKeyframes; index++) {
+		total += keyframes[index].revolutions;
+	}
+	if (!loop) {
+		total -= keyframes[numKeyframes - 1].revolutions;
+	}
+	if (total == 0 || (!loop && elapsed >= total)) {
+		stageFade(keyframes[numKeyframes - 1].colors,
+				keyframes[numKeyframes - 1].colors, 0, 1);
+		return true;
+	}
+
+	elapsed %= total;
+	for (index = 0; elapsed >= keyframes[index].revolutions; index++) {
+		elapsed -= keyframes[index].revolutions;
+	}
+	current = keyframes + index;
+	next = (index + 1 < numKeyframes) ? current + 1 : keyframes;
+	stageFade(current->colors, next->colors, elapsed, current->revolutions);
+	return false;
+}
+
+uint32_t TeensyPovPalette::blend(uint32_t from, uint32_t to, uint16_t weight) {
+	// weight 0 -> from, 256 -> to
+	uint32_t result = 0, shift, a, b;
+
+	for (shift = 0; shift < 24; shift += 8) {
+		a = (from >> shift) & 0xFF;
+		b = (to >> shift) & 0xFF;
+		result |= ((a * (256 - weight) + b * weight) >> 8) << shift;
+	}
+	return result;
+}
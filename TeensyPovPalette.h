@@ -0,0 +1,50 @@
+/*
+ * TeensyPovPalette.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVPALETTE_H_
+#define TEENSYPOVPALETTE_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+
+struct PaletteKeyframe {
+	const uint32_t *colors;
+	uint16_t revolutions;
+};
+
+class TeensyPovPalette {
+private:
+	enum AnimationMode {
+		IDLE, CYCLE, FADE, SEQUENCE
+	};
+	AnimationMode mode = IDLE;
+	const uint32_t *fromColors = nullptr;
+	const uint32_t *toColors = nullptr;
+	const PaletteKeyframe *keyframes = nullptr;
+	uint8_t numKeyframes = 0;
+	bool loop = false;
+	uint8_t firstColor = 0, lastColor = 0;
+	int8_t cycleStep = 0;
+	uint16_t revolutions = 0;
+	uint32_t startRevolution = 0, lastRevolution = 0;
+	int16_t lastCycleOffset = -1;
+	void start(AnimationMode);
+	void stageCycle(uint32_t);
+	void stageFade(const uint32_t *, const uint32_t *, uint32_t, uint32_t);
+	bool stageSequence(uint32_t);
+	static uint32_t blend(uint32_t, uint32_t, uint16_t);
+
+public:
+	void cycle(const uint32_t *, uint8_t, uint8_t, int8_t, uint16_t);
+	void fade(const uint32_t *, const uint32_t *, uint16_t);
+	void sequence(const PaletteKeyframe *, uint8_t, bool);
+	void stop(void);
+	bool active(void);
+	bool update(void);
+};
+
+#endif /* TEENSYPOVPALETTE_H_ */
@@ -0,0 +1,84 @@
+/*
+ * TeensyPovProtocol.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Binary framing for streaming content to a TeensyPOV over USB serial. Shared by TeensyPovStream
+ * (on the Teensy) and the host tools in extras/host, so it must not depend on Arduino headers.
+ *
+ * Every message:  0xA5  0x5A  type  length (2 bytes)  payload (length bytes)  checksum (2 bytes)
+ * Multi-byte values are little endian. The checksum is Fletcher-16 over type, length and payload.
+ *
+ * Payloads (host -> Teensy):
+ * 	POV_CMD_CONFIG    logNumSegments (1), numColorBits (1), tdcSegment (2)
+ * 	POV_CMD_PALETTE   first index (1), then one 0x00RRGGBB word (4) per palette entry
+ * 	POV_CMD_FRAME     first segment (2) = 0, segment count (2) = number of segments, words per segment (1), segment words
+ * 	POV_CMD_SEGMENTS  first segment (2), segment count (2), words per segment (1), segment words
+ * 	POV_CMD_SWAP      (none) -- show palette and segments received since the last swap from the next Top Dead Center
+ *
+ * Every message is answered (Teensy -> host) with POV_CMD_ACK: command type (1), status (1).
+ */
+
+#ifndef TEENSYPOVPROTOCOL_H_
+#define TEENSYPOVPROTOCOL_H_
+
+#include <stdint.h>
+
+// Segment buffer size: 2 ^ POV_MAX_LOG_SEGMENTS segments x POV_MAX_LEDS bytes (x2 with POV_DOUBLE_BUFFER).
+// E.g. 144 LEDs at up to 256 segments: 36KB. Build the host tools with the same values as the library.
+#ifndef POV_MAX_LEDS
+#define POV_MAX_LEDS 48
+#endif
+#ifndef POV_MAX_LOG_SEGMENTS
+#define POV_MAX_LOG_SEGMENTS 9
+#endif
+
+static const uint8_t povMaxLogNumSegments = POV_MAX_LOG_SEGMENTS;
+static const uint32_t povMaxNumSegments = 1UL << POV_MAX_LOG_SEGMENTS;
+static const uint32_t povMaxColumns = (POV_MAX_LEDS * 8 + 31) / 32;	// Words per segment at 8 color bits
+
+static const uint8_t POV_SYNC_1 = 0xA5;
+static const uint8_t POV_SYNC_2 = 0x5A;
+
+static const uint8_t POV_CMD_CONFIG = 0x01;
+static const uint8_t POV_CMD_PALETTE = 0x02;
+static const uint8_t POV_CMD_FRAME = 0x03;
+static const uint8_t POV_CMD_SEGMENTS = 0x04;
+static const uint8_t POV_CMD_SWAP = 0x05;
+static const uint8_t POV_CMD_ACK = 0x80;
+
+static const uint8_t POV_STATUS_OK = 0;
+static const uint8_t POV_STATUS_CHECKSUM = 1;
+static const uint8_t POV_STATUS_RANGE = 2;
+static const uint8_t POV_STATUS_UNKNOWN = 3;
+
+static const uint8_t povHeaderLength = 5;		// Sync, type, length
+static const uint8_t povChecksumLength = 2;
+static const uint8_t povConfigLength = 4;
+static const uint8_t povSegmentsHeaderLength = 5;
+static const uint8_t povAckLength = 2;
+
+struct PovChecksum {
+	// Fletcher-16, modulo deferred so the per-byte cost is two adds
+	uint32_t sum1 = 0, sum2 = 0;
+	uint16_t pending = 0;
+
+	void add(const uint8_t *data, uint32_t len) {
+		while (len--) {
+			sum1 += *data++;
+			sum2 += sum1;
+			if (++pending == 360) {	// Largest run that can't overflow sum2
+				sum1 %= 255;
+				sum2 %= 255;
+				pending = 0;
+			}
+		}
+	}
+
+	uint16_t value() {
+		return (uint16_t) ((sum2 % 255) << 8 | (sum1 % 255));
+	}
+};
+
+#endif /* TEENSYPOVPROTOCOL_H_ */
@@ -0,0 +1,291 @@
+/*
+ * TeensyPovSprite.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovSprite.h"
+
+/*
+ * Each sprite column is compiled once into a packed value and mask at the current number of color bits.
+ * Drawing shifts them to the sprite's LED and merges at most 3 words per segment, saving the pixels it
+ * covers first. Sprites are restored in the reverse of the order they were drawn, so overlapping sprites
+ * put back the right background, and only sprites from the lowest changed one up are touched.
+ */
+
+bool TeensyPovSprite::setImage(const SpriteImage *img) {
+	/*
+	 * Parameters:
+	 * 	const SpriteImage *img -- Image, not copied. The structure and pixels pointed to must be static or global.
+	 *
+	 * Returns:
+	 * 	false if the image is wider than 16 segments or taller than 64 bits of pixels (64 / color bits LEDs).
+	 */
+	if (img->width > maxWidth || img->height * TeensyPOV::currentNumColorBits > 64) {
+		return false;
+	}
+	image = img;
+	dirty = true;
+	return true;
+}
+
+void TeensyPovSprite::moveTo(uint16_t segment, int16_t led) {
+	/*
+	 * Parameters:
+	 * 	uint16_t segment -- Segment of the sprite's first column, wrapping around the display.
+	 *
+	 * 	int16_t led -- LED of the sprite's innermost row, 0 = innermost LED. Rows off either end aren't drawn.
+	 */
+	segmentPosition = (uint32_t) segment << 8;
+	ledPosition = (int32_t) led << 8;
+	dirty = true;
+}
+
+void TeensyPovSprite::moveBy(int16_t segments, int16_t leds) {
+	segmentPosition += (int32_t) segments << 8;
+	ledPosition += (int32_t) leds << 8;
+	dirty = true;
+}
+
+void TeensyPovSprite::setVelocity(int16_t segmentsPerStep, int16_t ledsPerStep) {
+	/*
+	 * Set the motion applied by TeensyPovSpriteSet::step().
+	 * Parameters:
+	 * 	int16_t segmentsPerStep, ledsPerStep -- 1/256 segment and 1/256 LED units.
+	 */
+	segmentVelocity = segmentsPerStep;
+	ledVelocity = ledsPerStep;
+}
+
+uint16_t TeensyPovSprite::getSegment() {
+	return (segmentPosition >> 8) & TeensyPOV::currentSegmentMask;
+}
+
+int16_t TeensyPovSprite::getLed() {
+	return ledPosition >> 8;
+}
+
+void TeensyPovSprite::setVisible(bool show) {
+	if (show != visible) {
+		visible = show;
+		dirty = true;
+	}
+}
+
+bool TeensyPovSprite::isVisible() {
+	return visible;
+}
+
+void TeensyPovSprite::compile() {
+	uint8_t bits = TeensyPOV::currentNumColorBits, column, led, pixel;
+	uint64_t value, mask;
+
+	compiledImage = image;
+	compiledBits = bits;
+	if (!image || image->height * bits > 64) {
+		compiledImage = nullptr;
+		return;
+	}
+	for (column = 0; column < image->width; column++) {
+		value = 0;
+		mask = 0;
+		for (led = 0; led < image->height; led++) {
+			pixel = image->pixels[column * image->height + led];
+			if (pixel != image->transparent) {
+				value |= (uint64_t) (pixel & TeensyPOV::currentColorMask) << (led * bits);
+				mask |= (uint64_t) TeensyPOV::currentColorMask << (led * bits);
+			}
+		}
+		columnValue[column] = value;
+		columnMask[column] = mask;
+	}
+}
+
+void TeensyPovSprite::blit(uint16_t segment, int16_t led, bool restoring) {
+	/*
+	 * Draw the compiled image at segment, led after saving what it covers, or put back the saved pixels.
+	 */
+	uint8_t bits = TeensyPOV::currentNumColorBits, rightShift = 0, shift, first;
+	uint8_t step, column, word, index;
+	uint64_t limit = ~0ULL, value, mask;
+	uint32_t valueWords[columnWords], maskWords[columnWords];
+	int16_t visibleLeds;
+	volatile uint32_t *row;
+
+	if (!compiledImage) {
+		return;
+	}
+	// Clip rows inside LED 0 and outside the last LED
+	if (led < 0) {
+		if (-led * bits >= 64) {
+			return;
+		}
+		rightShift = -led * bits;
+		led = 0;
+	}
+	visibleLeds = TeensyPOV::numLeds - led;
+	if (visibleLeds <= 0) {
+		return;
+	}
+	if (visibleLeds * bits < 64) {
+		limit = (1ULL << (visibleLeds * bits)) - 1;
+	}
+	first = led * bits / 32;
+	shift = led * bits % 32;
+
+	for (step = 0; step < compiledImage->width; step++) {
+		// Restore in reverse, in case a sprite wider than the display covers a segment twice
+		column = restoring ? compiledImage->width - 1 - step : step;
+		mask = (columnMask[column] >> rightShift) & limit;
+		if (!mask) {
+			continue;
+		}
+		value = columnValue[column] >> rightShift;
+		maskWords[0] = (uint32_t) (mask << shift);
+		maskWords[1] = (uint32_t) ((mask << shift) >> 32);
+		maskWords[2] = shift ? (uint32_t) (mask >> (64 - shift)) : 0;
+		valueWords[0] = (uint32_t) (value << shift);
+		valueWords[1] = (uint32_t) ((value << shift) >> 32);
+		valueWords[2] = shift ? (uint32_t) (value >> (64 - shift)) : 0;
+		row = TeensyPOV::drawArray[(segment + column) & TeensyPOV::currentSegmentMask];
+		for (word = 0; word < columnWords; word++) {
+			if (!maskWords[word]) {
+				continue;
+			}
+			index = column * columnWords + word;
+			if (restoring) {
+				row[first + word] = (row[first + word] & ~maskWords[word]) | saved[index];
+			} else {
+				saved[index] = row[first + word] & maskWords[word];
+				row[first + word] = (row[first + word] & ~maskWords[word])
+						| (valueWords[word] & maskWords[word]);
+			}
+		}
+	}
+}
+
+bool TeensyPovSpriteSet::add(TeensyPovSprite *sprite) {
+	/*
+	 * Add a sprite over those already added. The sprite object must be static or global.
+	 * Returns:
+	 * 	false if there are already 32 sprites.
+	 */
+	if (numSprites >= maxSprites) {
+		return false;
+	}
+	sprite->drawn = false;
+	sprite->dirty = true;
+	sprites[numSprites++] = sprite;
+	return true;
+}
+
+void TeensyPovSpriteSet::remove(TeensyPovSprite *sprite) {
+	/*
+	 * Remove a sprite, putting back the background under it. Sprites over it are redrawn by the next update().
+	 */
+	uint8_t index, top;
+
+	for (index = 0; index < numSprites; index++) {
+		if (sprites[index] == sprite) {
+			break;
+		}
+	}
+	if (index == numSprites) {
+		return;
+	}
+	TeensyPOV::beginFrame();
+	for (top = numSprites; top-- > index;) {
+		if (sprites[top]->drawn) {
+			sprites[top]->blit(sprites[top]->drawnSegment, sprites[top]->drawnLed, true);
+			sprites[top]->drawn = false;
+		}
+	}
+	TeensyPOV::endFrame();
+	memmove(sprites + index, sprites + index + 1,
+			(numSprites - index - 1) * sizeof(sprites[0]));
+	numSprites--;
+}
+
+void TeensyPovSpriteSet::invalidate() {
+	/*
+	 * Forget the saved backgrounds, e.g. after drawing a new background. The next update() draws every sprite
+	 * without restoring anything.
+	 */
+	uint8_t index;
+
+	for (index = 0; index < numSprites; index++) {
+		sprites[index]->drawn = false;
+	}
+}
+
+bool TeensyPovSpriteSet::update() {
+	/*
+	 * Show the sprites' changes since the last update, wrapped in beginFrame() / endFrame().
+	 * Returns:
+	 * 	false if nothing had changed.
+	 */
+	TeensyPovSprite *sprite;
+	uint8_t index, lowest;
+
+	if (drawnLogNumSegments != TeensyPOV::currentLogNumSegments
+			|| drawnNumColorBits != TeensyPOV::currentNumColorBits) {
+		// The display was reconfigured, so the saved backgrounds are meaningless
+		invalidate();
+		drawnLogNumSegments = TeensyPOV::currentLogNumSegments;
+		drawnNumColorBits = TeensyPOV::currentNumColorBits;
+	}
+	for (lowest = 0; lowest < numSprites; lowest++) {
+		sprite = sprites[lowest];
+		if (sprite->dirty || (sprite->visible && sprite->image && !sprite->drawn)) {
+			break;
+		}
+	}
+	if (lowest == numSprites) {
+		return false;
+	}
+
+	TeensyPOV::beginFrame();
+	for (index = numSprites; index-- > lowest;) {
+		sprite = sprites[index];
+		if (sprite->drawn) {
+			sprite->blit(sprite->drawnSegment, sprite->drawnLed, true);
+			sprite->drawn = false;
+		}
+	}
+	for (index = lowest; index < numSprites; index++) {
+		sprite = sprites[index];
+		sprite->dirty = false;
+		if (sprite->compiledImage != sprite->image
+				|| sprite->compiledBits != TeensyPOV::currentNumColorBits) {
+			sprite->compile();
+		}
+		if (sprite->visible && sprite->compiledImage) {
+			sprite->drawnSegment = sprite->getSegment();
+			sprite->drawnLed = sprite->getLed();
+			sprite->blit(sprite->drawnSegment, sprite->drawnLed, false);
+			sprite->drawn = true;
+		}
+	}
+	TeensyPOV::endFrame();
+	return true;
+}
+
+bool TeensyPovSpriteSet::step() {
+	/*
+	 * Move every sprite by its velocity, then update(). Call once per revolution, e.g. from a frame callback,
+	 * for smooth motion.
+	 */
+	TeensyPovSprite *sprite;
+	uint8_t index;
+
+	for (index = 0; index < numSprites; index++) {
+		sprite = sprites[index];
+		if (sprite->segmentVelocity || sprite->ledVelocity) {
+			sprite->segmentPosition += sprite->segmentVelocity;
+			sprite->ledPosition += sprite->ledVelocity;
+			sprite->dirty = true;
+		}
+	}
+	return update();
+}
@@ -0,0 +1,69 @@
+/*
+ * TeensyPovSprite.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVSPRITE_H_
+#define TEENSYPOVSPRITE_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+
+struct SpriteImage {
+	uint8_t width;					// Segments
+	uint8_t height;					// LEDs
+	int16_t transparent;			// Palette index not drawn, -1 for none
+	const uint8_t *pixels;			// Palette indexes, width columns of height LEDs, innermost LED first
+};
+
+class TeensyPovSprite {
+	friend class TeensyPovSpriteSet;
+private:
+	static const uint8_t maxWidth = 16;
+	static const uint8_t columnWords = 3;		// 64 bits of column span at most 3 words
+	const SpriteImage *image = nullptr;
+	const SpriteImage *compiledImage = nullptr;
+	uint8_t compiledBits = 0;
+	uint64_t columnValue[maxWidth];				// Packed column pixels, LED 0 at bit 0
+	uint64_t columnMask[maxWidth];				// Ones over the pixels that aren't transparent
+	uint32_t segmentPosition = 0;				// 1/256 segment
+	int32_t ledPosition = 0;					// 1/256 LED
+	int16_t segmentVelocity = 0, ledVelocity = 0;
+	bool visible = true;
+	bool dirty = true;
+	bool drawn = false;
+	uint16_t drawnSegment = 0;
+	int16_t drawnLed = 0;
+	uint32_t saved[maxWidth * columnWords];		// Background under the sprite
+	void compile(void);
+	void blit(uint16_t, int16_t, bool);
+
+public:
+	bool setImage(const SpriteImage *);
+	void moveTo(uint16_t, int16_t);
+	void moveBy(int16_t, int16_t);
+	void setVelocity(int16_t, int16_t);
+	uint16_t getSegment(void);
+	int16_t getLed(void);
+	void setVisible(bool);
+	bool isVisible(void);
+};
+
+class TeensyPovSpriteSet {
+private:
+	static const uint8_t maxSprites = 32;
+	TeensyPovSprite *sprites[maxSprites];
+	uint8_t numSprites = 0;
+	uint8_t drawnLogNumSegments = 0, drawnNumColorBits = 0;
+
+public:
+	bool add(TeensyPovSprite *);
+	void remove(TeensyPovSprite *);
+	void invalidate(void);
+	bool update(void);
+	bool step(void);
+};
+
+#endif /* TEENSYPOVSPRITE_H_ */
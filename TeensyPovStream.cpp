@@ -0,0 +1,292 @@
+/*
+ * TeensyPovStream.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#include "TeensyPovStream.h"
+
+TeensyPovStream::TeensyPovStream(Stream &stream) {
+	/*
+	 * Constructor
+	 * Parameters:
+	 * 	Stream &stream -- Port to receive TeensyPovProtocol messages on, normally Serial (USB).
+	 */
+	port = &stream;
+}
+
+uint8_t TeensyPovStream::poll() {
+	/*
+	 * Receive whatever has arrived without blocking. Call often from loop().
+	 * Segment words and palette entries are read straight into the back buffer / staging palette, with no
+	 * intermediate copy. Needs POV_DOUBLE_BUFFER in TeensyPOV.h so frames are only shown after POV_CMD_SWAP.
+	 * Parameters:
+	 * 	N/A
+	 *
+	 * Returns:
+	 * 	Type of the message completed by this call (POV_CMD_xxx), or zero
+	 */
+	uint8_t byte, completed = 0;
+
+	while (completed == 0 && port->available() > 0) {
+		switch (state) {
+		case WAIT_SYNC_1:
+			if (port->read() == POV_SYNC_1) {
+				state = WAIT_SYNC_2;
+			}
+			break;
+
+		case WAIT_SYNC_2:
+			byte = port->read();
+			if (byte == POV_SYNC_2) {
+				checksum = PovChecksum();
+				headerCount = 0;
+				state = HEADER;
+			} else if (byte != POV_SYNC_1) {
+				state = WAIT_SYNC_1;
+			}
+			break;
+
+		case HEADER:
+			header[headerCount++] = port->read();
+			if (headerCount == 3) {
+				checksum.add(header, 3);
+				type = header[0];
+				remaining = header[1] | (header[2] << 8);
+				startPayload();
+			}
+			break;
+
+		case SUB_HEADER:
+			header[headerCount++] = port->read();
+			remaining--;
+			if (headerCount == headerLength) {
+				checksum.add(header, headerLength);
+				readPayload();
+			}
+			break;
+
+		case PAYLOAD:
+			readPayload();
+			break;
+
+		case CHECKSUM:
+			received[headerCount++] = port->read();
+			if (headerCount == povChecksumLength) {
+				if ((received[0] | (received[1] << 8)) != checksum.value()) {
+					status = POV_STATUS_CHECKSUM;
+					if (destination != nullptr) {
+						// The bad payload went into the back buffer / staging palette: drop what
+						// was received since the last swap rather than show it
+						frameStarted = false;
+						paletteStarted = false;
+					}
+				}
+				finish();
+				completed = type;
+				state = WAIT_SYNC_1;
+			}
+			break;
+		}
+	}
+	return completed;
+}
+
+void TeensyPovStream::startPayload() {
+	status = POV_STATUS_OK;
+	headerCount = 0;
+	destination = nullptr;
+	switch (type) {
+	case POV_CMD_CONFIG:
+		headerLength = povConfigLength;
+		break;
+
+	case POV_CMD_PALETTE:
+		headerLength = 1;
+		break;
+
+	case POV_CMD_FRAME:
+	case POV_CMD_SEGMENTS:
+		headerLength = povSegmentsHeaderLength;
+		break;
+
+	case POV_CMD_SWAP:
+		headerLength = 0;
+		break;
+
+	default:
+		headerLength = 0;
+		status = POV_STATUS_UNKNOWN;
+		break;
+	}
+	if (remaining < headerLength) {
+		headerLength = remaining;
+		status = POV_STATUS_RANGE;
+	}
+	state = (headerLength > 0) ? SUB_HEADER : PAYLOAD;
+	if (headerLength == 0) {
+		readPayload();
+	}
+}
+
+void TeensyPovStream::readPayload() {
+	// Reads as much of the payload as is available, straight to its destination
+	uint32_t count;
+	uint16_t index;
+	uint8_t scratch[32];
+	volatile uint32_t *colors;
+
+	if (state == SUB_HEADER) {
+		// Sub-header complete, set up destination
+		state = PAYLOAD;
+		if (status != POV_STATUS_OK) {
+			destination = nullptr;
+		} else if (type == POV_CMD_CONFIG) {
+			if (header[0] < 1 || header[0] > TeensyPOV::maxLogNumSegments
+					|| (header[1] != TeensyPOV::COLOR_BITS_1
+							&& header[1] != TeensyPOV::COLOR_BITS_2
+							&& header[1] != TeensyPOV::COLOR_BITS_4
+							&& header[1] != TeensyPOV::COLOR_BITS_8)
+					|| (header[2] | (header[3] << 8)) >= (1 << header[0])) {
+				status = POV_STATUS_RANGE;
+			}
+		} else if (type == POV_CMD_PALETTE) {
+			if (header[0] + remaining / 4 > TeensyPOV::currentNumPaletteEntries
+					|| (remaining & 3)) {
+				status = POV_STATUS_RANGE;
+			} else {
+				if (!paletteStarted) {
+					// Entries not sent keep their current colors
+					colors = TeensyPOV::beginPalette();
+					for (index = 0; index < TeensyPOV::currentNumPaletteEntries;
+							index++) {
+						colors[index] = TeensyPOV::currentColors[index];
+					}
+					paletteStarted = true;
+				}
+				destination = (uint8_t *) (TeensyPOV::stagedColors + header[0]);
+				rowBytes = 0;
+			}
+		} else if (type == POV_CMD_FRAME || type == POV_CMD_SEGMENTS) {
+			segment = header[0] | (header[1] << 8);
+			lastSegment = segment + (header[2] | (header[3] << 8));
+			rowBytes = header[4] * sizeof(uint32_t);
+			if (lastSegment > TeensyPOV::currentNumSegments
+					|| lastSegment < segment
+					|| header[4] > TeensyPOV::maxColumns
+					|| remaining != (uint32_t) (lastSegment - segment) * rowBytes
+					|| (type == POV_CMD_FRAME
+							&& (segment != 0
+									|| lastSegment != TeensyPOV::currentNumSegments))) {
+				status = POV_STATUS_RANGE;
+			} else {
+				if (!frameStarted) {
+					TeensyPOV::beginFrame();
+					frameStarted = true;
+				}
+				destination = (uint8_t *) TeensyPOV::drawArray[segment];
+				rowCount = 0;
+			}
+		}
+	}
+
+	while (remaining > 0 && port->available() > 0) {
+		if (destination == nullptr) {
+			// Bad message, consume it
+			count = port->available();
+			count = (count > sizeof(scratch)) ? sizeof(scratch) : count;
+			count = (count > remaining) ? remaining : count;
+			port->readBytes(scratch, count);
+			checksum.add(scratch, count);
+			remaining -= count;
+			continue;
+		}
+
+		count = port->available();
+		if (rowBytes > 0 && count > (uint32_t) (rowBytes - rowCount)) {
+			count = rowBytes - rowCount;		// Don't run past this segment's row
+		}
+		if (count > remaining) {
+			count = remaining;
+		}
+		port->readBytes(destination, count);
+		checksum.add(destination, count);
+		destination += count;
+		remaining -= count;
+		if (rowBytes > 0) {
+			rowCount += count;
+			if (rowCount == rowBytes && remaining > 0) {
+				rowCount = 0;
+				destination = (uint8_t *) TeensyPOV::drawArray[++segment];
+			}
+		}
+	}
+
+	if (remaining == 0) {
+		headerCount = 0;
+		state = CHECKSUM;
+	}
+}
+
+void TeensyPovStream::finish() {
+	if (status == POV_STATUS_OK) {
+		switch (type) {
+		case POV_CMD_CONFIG:
+			TeensyPOV::setParameters(header[0], header[1],
+					header[2] | (header[3] << 8));
+			frameStarted = false;
+			paletteStarted = false;
+			break;
+
+		case POV_CMD_SWAP:
+#ifdef POV_APA102_HDR
+			if (paletteStarted) {
+				TeensyPOV::encodePalette(TeensyPOV::stagedColors);
+			}
+#endif  // POV_APA102_HDR
+			TeensyPOV::requestSwap(frameStarted, paletteStarted);
+			frameStarted = false;
+			paletteStarted = false;
+			framesReceived++;
+			break;
+
+		default:
+			break;
+		}
+	} else {
+		errors++;
+	}
+	sendAck(type, status);
+}
+
+void TeensyPovStream::sendAck(uint8_t command, uint8_t result) {
+	uint8_t message[povHeaderLength + povAckLength + povChecksumLength];
+	PovChecksum sum;
+	uint16_t value;
+
+	message[0] = POV_SYNC_1;
+	message[1] = POV_SYNC_2;
+	message[2] = POV_CMD_ACK;
+	message[3] = povAckLength;
+	message[4] = 0;
+	message[5] = command;
+	message[6] = result;
+	sum.add(message + 2, 5);
+	value = sum.value();
+	message[7] = value & 0xFF;
+	message[8] = value >> 8;
+	port->write(message, sizeof(message));
+}
+
+uint32_t TeensyPovStream::getFramesReceived() {
+	return framesReceived;
+}
+
+uint32_t TeensyPovStream::getErrors() {
+	/*
+	 * Returns:
+	 * 	Number of messages rejected (bad checksum, out of range, unknown type)
+	 */
+	return errors;
+}
@@ -0,0 +1,45 @@
+/*
+ * TeensyPovStream.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ */
+
+#ifndef TEENSYPOVSTREAM_H_
+#define TEENSYPOVSTREAM_H_
+
+#include <Arduino.h>
+#include "TeensyPOV.h"
+#include "TeensyPovProtocol.h"
+
+class TeensyPovStream {
+private:
+	enum ReceiveState {
+		WAIT_SYNC_1, WAIT_SYNC_2, HEADER, SUB_HEADER, PAYLOAD, CHECKSUM
+	};
+	Stream *port;
+	ReceiveState state = WAIT_SYNC_1;
+	uint8_t header[povSegmentsHeaderLength];
+	uint8_t received[povChecksumLength];
+	uint8_t headerCount = 0, headerLength = 0;
+	uint8_t type = 0, status = POV_STATUS_OK;
+	uint32_t remaining = 0;
+	uint16_t segment = 0, lastSegment = 0;
+	uint16_t rowBytes = 0, rowCount = 0;
+	uint8_t *destination = nullptr;
+	bool frameStarted = false, paletteStarted = false;
+	PovChecksum checksum;
+	uint32_t framesReceived = 0, errors = 0;
+	void startPayload(void);
+	void readPayload(void);
+	void finish(void);
+	void sendAck(uint8_t, uint8_t);
+
+public:
+	TeensyPovStream(Stream &);
+	uint8_t poll(void);
+	uint32_t getFramesReceived(void);
+	uint32_t getErrors(void);
+};
+
+#endif /* TEENSYPOVSTREAM_H_ */
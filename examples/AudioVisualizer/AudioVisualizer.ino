@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovAudio.h"
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t audioPin = A2;		// Line level audio, AC coupled and biased to 1.65 V
+const uint32_t sampleRate = 8000;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_2;
+const uint8_t logNumSegments = TeensyPOV::LOG_128_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint16_t numLeds = 36;
+
+CRGB leds[numLeds];
+
+const uint32_t palette[] = { CRGB::Black, CRGB::Green, CRGB::Red, CRGB::Blue };
+
+const DisplayStringSpec title[] = { { "LIVE", BOTTOM, 6, 3, 0, true } };
+
+TeensyPovAudio spectrum(16, TeensyPovAudio::BARS);
+TeensyPovDisplay display;
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Audio Visualizer");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+	if (!spectrum.begin(audioPin, sampleRate)) {
+		Serial.println("Can't sample that pin");
+	}
+	spectrum.setLeds(8, numLeds - 1);		// Bars above the title
+	spectrum.setColors(1, 2, 0);
+
+	display.load(title, 1);
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, palette);
+	display.setAudio(&spectrum);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+}
+
+void loop() {
+	static uint32_t reportTimer = 0;
+	AudioStats stats;
+	PovTelemetry telemetry;
+
+	display.update();
+	if (millis() - reportTimer >= 2000) {
+		reportTimer = millis();
+		spectrum.getStats(&stats);
+		TeensyPOV::getTelemetry(&telemetry);
+		Serial.print("FFT cycles: ");
+		Serial.print(stats.analyzeCycles);
+		Serial.print("  draw cycles: ");
+		Serial.print(stats.drawCycles);
+		Serial.print("  max: ");
+		Serial.print(stats.maxCycles);
+		Serial.print("  revolution cycles: ");
+		Serial.print((uint64_t) TeensyPOV::getLastRotationCount() * (F_CPU / F_BUS));
+		Serial.print("  frames skipped: ");
+		Serial.println(telemetry.framesSkipped);
+	}
+}
@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovCanvas.h"
+
+#define NUM_LEDS 36
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_4;
+const uint8_t logNumSegments = TeensyPOV::LOG_128_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint32_t numLeds = NUM_LEDS;
+CRGB leds[numLeds];
+
+const uint32_t colors[] = { CRGB::Black, CRGB::Red, CRGB::Green, CRGB::Blue,
+		CRGB::Yellow, CRGB::White, CRGB::Black, CRGB::Black, CRGB::Black,
+		CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black, CRGB::Black,
+		CRGB::Black, CRGB::Black };
+
+// Canvas just covers the display's circle: 2 x (LEDs + hub radius)
+const uint8_t canvasSize = 2 * (NUM_LEDS + 1);
+uint8_t canvasPixels[canvasSize * canvasSize];
+int8_t canvasLut[TeensyPovCanvas::lutBytes(logNumSegments, NUM_LEDS)];
+TeensyPovCanvas canvas(canvasPixels, canvasSize, canvasLut, sizeof(canvasLut));
+
+TeensyPovDisplay display;
+int16_t boxX = 10, boxY = 20, stepX = 1, stepY = 1;
+const uint8_t boxSize = 12;
+
+void eraseBox(void);
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Canvas");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	display.load();
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, colors);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+
+	canvas.fill(0);
+	canvas.drawLine(0, 0, canvasSize - 1, canvasSize - 1, 5);
+	canvas.drawLine(0, canvasSize - 1, canvasSize - 1, 0, 5);
+	canvas.flush();
+}
+
+void loop() {
+	static uint32_t lastMove = 0;
+
+	display.update();
+	if (millis() - lastMove < 30) {
+		return;
+	}
+	lastMove = millis();
+
+	// Bouncing box, only the segments it crosses are redrawn
+	eraseBox();
+	if (boxX + stepX < 0 || boxX + stepX + boxSize > canvasSize) {
+		stepX = -stepX;
+	}
+	if (boxY + stepY < 0 || boxY + stepY + boxSize > canvasSize) {
+		stepY = -stepY;
+	}
+	boxX += stepX;
+	boxY += stepY;
+	canvas.fillRect(boxX, boxY, boxSize, boxSize, 1 + (boxX + boxY) % 4);
+	canvas.flush();
+}
+
+void eraseBox() {
+	// Restore the background (two diagonals) under the box
+	uint8_t x, y;
+
+	for (y = boxY; y < boxY + boxSize; y++) {
+		for (x = boxX; x < boxX + boxSize; x++) {
+			canvas.setPixel(x, y, (x == y || x + y == canvasSize - 1) ? 5 : 0);
+		}
+	}
+}
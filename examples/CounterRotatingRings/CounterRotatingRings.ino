@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovDraw.h"
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_2;
+const uint8_t logNumSegments = TeensyPOV::LOG_256_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint16_t numLeds = 36;
+
+CRGB leds[numLeds];
+
+const uint32_t palette[] = { CRGB::Black, CRGB::Red, CRGB::Green, CRGB::Blue };
+
+// Two text rings turning opposite ways around a fixed logo
+const DisplayStringSpec stringArray[] = {
+		{ "OUTER RING", TOP, 35, 1, 0, false },
+		{ "INNER RING", TOP, 27, 2, 0, false } };
+const uint8_t numStrings = sizeof(stringArray) / sizeof(DisplayStringSpec);
+
+const uint8_t bandStart[] = { 0, 20, 28 };
+const int32_t bandVelocity[] = { 0, -3 * 65536L / 2, 2 * 65536L };	// Segments per revolution, 16.16
+const uint8_t numBands = sizeof(bandStart) / sizeof(bandStart[0]);
+
+TeensyPovDisplay display;
+
+void drawLogo(TeensyPovDisplay *) {
+	// Called inside the display's own frame, after the strings are drawn
+	uint16_t segment;
+
+	TeensyPovDraw::ring(18, 3, 2);
+	for (segment = 0; segment < 256; segment += 64) {
+		TeensyPovDraw::spoke(segment, 4, 17, 3);
+	}
+}
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Counter Rotating Rings");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	display.load(stringArray, numStrings);
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, palette);
+	display.setRotationBands(bandStart, numBands, bandVelocity);
+	display.setActivationCallback(drawLogo);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+}
+
+void loop() {
+	display.update();
+}
@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovLayer.h"
+#include "TeensyPovDraw.h"
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_2;
+const uint8_t logNumSegments = TeensyPOV::LOG_256_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint32_t numLeds = 36;
+CRGB leds[numLeds];
+
+const uint32_t colors[] = { CRGB::Black, CRGB::Blue, CRGB::Yellow, CRGB::Red };
+
+// Opaque background of spokes, a clock hand above it and text on top, each with color 0 transparent
+uint32_t backgroundBuffer[TeensyPovLayer::bufferWords(logNumSegments)];
+uint32_t handBuffer[TeensyPovLayer::bufferWords(logNumSegments)];
+uint32_t textBuffer[TeensyPovLayer::bufferWords(logNumSegments)];
+TeensyPovLayer background(backgroundBuffer, TeensyPovLayer::bufferWords(logNumSegments), 0, -1);
+TeensyPovLayer hand(handBuffer, TeensyPovLayer::bufferWords(logNumSegments), 1);
+TeensyPovLayer text(textBuffer, TeensyPovLayer::bufferWords(logNumSegments), 2);
+TeensyPovCompositor compositor;
+TeensyPovDisplay display;
+
+char seconds[3];
+DisplayStringSpec secondsText = { seconds, TOP, 35, 2, 0, false };
+uint16_t handSegment = 0;
+
+void setup() {
+	uint16_t segment;
+
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Layers");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	display.load();
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, colors);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+
+	background.fill(0);
+	if (background.beginDraw()) {
+		for (segment = 0; segment < 256; segment += 32) {
+			TeensyPovDraw::spoke(segment, 1);
+		}
+		background.endDraw();
+	}
+	hand.clear();
+	text.clear();
+	compositor.add(&background);
+	compositor.add(&hand);
+	compositor.add(&text);
+	display.setCompositor(&compositor);
+	display.refresh();
+}
+
+void loop() {
+	static uint32_t lastSecond = 0;
+	uint32_t now = millis() / 1000;
+
+	display.update();
+	if (now != lastSecond) {
+		lastSecond = now;
+
+		// Only the old and new hand segments and the segments under the text are composited
+		if (hand.beginDraw()) {
+			TeensyPovDraw::spoke(handSegment, 0, 29, 0);
+			hand.endDraw(handSegment, 1);
+		}
+		handSegment = (handSegment + 256 - 256 / 60) & 0xFF;
+		if (hand.beginDraw()) {
+			TeensyPovDraw::spoke(handSegment, 0, 29, 3);
+			hand.endDraw(handSegment, 1);
+		}
+
+		sprintf(seconds, "%02lu", now % 60);
+		text.drawString(&secondsText);
+		compositor.composite();
+	}
+}
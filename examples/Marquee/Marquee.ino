@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovMarquee.h"
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_2;
+const uint8_t logNumSegments = TeensyPOV::LOG_256_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint32_t numLeds = 36;
+CRGB leds[numLeds];
+
+const uint32_t colors[] = { CRGB::Black, CRGB::Yellow, CRGB::Blue, CRGB::Red };
+
+const char news[] =
+		"Marquee text can be much longer than one revolution  Only the columns "
+		"entering the window are rendered so a long string costs no more than a short one     ";
+
+// Upper band reads the repeating string, lower band scrolls whatever arrives on the serial port
+TeensyPovMarquee topMarquee(TOP, 35, 112);
+TeensyPovMarquee bottomMarquee(BOTTOM, 35, 112, true);
+TeensyPovDisplay display;
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Marquee");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	display.load();
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, colors);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+
+	topMarquee.setColors(1, 0);
+	topMarquee.setText(news, true);
+	topMarquee.setSpeed(40);
+
+	bottomMarquee.setColors(2, 0);
+	bottomMarquee.append("Type to scroll text here ");
+	bottomMarquee.setSpeed(30);
+}
+
+void loop() {
+	display.update();
+	while (Serial.available()) {
+		if (!bottomMarquee.append(Serial.read())) {
+			break;
+		}
+	}
+	topMarquee.update();
+	bottomMarquee.update();
+}
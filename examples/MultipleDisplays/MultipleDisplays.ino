@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "TeensyPovDisplay.h"
+#include "TeensyPovDraw.h"
 
 #define NUM_LEDS 36
 
@@ -116,64 +117,33 @@ void switchDisplay(TeensyPovDisplay *ptr) {
 }
 
 void loadLimacons(TeensyPovDisplay *ptr) {
+	// r = a (1 - 2 sin(theta)) in 1/256 LED, integer only
 	const uint8_t colorSelect = (1 << numColorBits) - 1;
-	const float twicePi = 2.0 * 3.14159;
-	const float halfPi = 3.14159 / 2.0;
-	const float shapeFactor = 2.0;
-	const float amplitude = numLeds / (shapeFactor + 1.0) - 1;
-	float angle, radius;
-	uint8_t pixel, color;
-	uint16_t segment, displaySegment, numSegments;
+	const int32_t shapeFactor = 2;
+	const int32_t amplitude = numLeds / (shapeFactor + 1) - 1;
+	int32_t radius;
+	uint16_t segment, numSegments;
 
 	numSegments = TeensyPOV::getNumSegments();
 	for (segment = 0; segment < numSegments; segment++) {
-		angle = -(float) segment / numSegments;
-		angle *= twicePi;
-		angle += halfPi;
-		radius = amplitude * (1.0 - shapeFactor * cos(angle));
-		if (radius > 0) {
-			displaySegment = segment;
-		} else {
-			displaySegment = segment + numSegments / 2;
-			if (displaySegment >= numSegments) {
-				displaySegment -= numSegments;
-			}
-			radius = -radius;
-		}
-		pixel = radius + 0.5;
-		color = segment % colorSelect + 1;
-		TeensyPOV::setPixel(displaySegment, pixel, color);
+		radius = (amplitude
+				* (32768 - shapeFactor * TeensyPovDraw::sin16(segment))) >> 7;
+		TeensyPovDraw::plot(segment, radius, segment % colorSelect + 1);
 	}
 }
 
 void loadRose(TeensyPovDisplay *ptr) {
+	// r = a cos(4 theta) in 1/256 LED, integer only
 	const uint8_t colorSelect = (1 << numColorBits) - 1;
-	const float twicePi = 2.0 * 3.14159;
-	const float halfPi = 3.14159 / 2.0;
-	const float shapeFactor = 4.0;
-	const float amplitude = numLeds - 1;
-	float angle, radius;
-	uint8_t pixel, color;
-	uint16_t segment, displaySegment, numSegments;
+	const uint16_t shapeFactor = 4;
+	const int32_t amplitude = numLeds - 1;
+	int32_t radius;
+	uint16_t segment, numSegments;
 
 	numSegments = TeensyPOV::getNumSegments();
 	for (segment = 0; segment < numSegments; segment++) {
-		angle = -(float) segment / numSegments;
-		angle *= twicePi;
-		angle += halfPi;
-		radius = amplitude * cos(shapeFactor * angle);
-		if (radius > 0) {
-			displaySegment = segment;
-		} else {
-			displaySegment = segment + numSegments / 2;
-			if (displaySegment >= numSegments) {
-				displaySegment -= numSegments;
-			}
-			radius = -radius;
-		}
-		pixel = radius + 0.5;
-		color = segment % colorSelect + 1;
-		TeensyPOV::setPixel(displaySegment, pixel, color);
+		radius = (amplitude * TeensyPovDraw::cos16(shapeFactor * segment)) >> 7;
+		TeensyPovDraw::plot(segment, radius, segment % colorSelect + 1);
 	}
 }
 
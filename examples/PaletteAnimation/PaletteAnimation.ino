@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+
+#define NUM_LEDS 36
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_4;
+const uint16_t tdcSegment = 0;
+const uint32_t numLeds = NUM_LEDS;
+CRGB leds[numLeds];
+
+const uint32_t rainbow[] = { CRGB::Black, CRGB::Red, CRGB::OrangeRed,
+		CRGB::Orange, CRGB::Yellow, CRGB::YellowGreen, CRGB::Green,
+		CRGB::Cyan, CRGB::Blue, CRGB::Purple, CRGB::Fuchsia, CRGB::DeepPink,
+		CRGB::White, CRGB::White, CRGB::White, CRGB::White };
+
+const uint32_t dim[] = { CRGB::Black, CRGB::Maroon, CRGB::Maroon,
+		CRGB::Maroon, CRGB::Olive, CRGB::Olive, CRGB::DarkGreen,
+		CRGB::DarkCyan, CRGB::Navy, CRGB::Indigo, CRGB::DarkMagenta,
+		CRGB::DarkMagenta, CRGB::Gray, CRGB::Gray, CRGB::Gray, CRGB::Gray };
+
+const PaletteKeyframe pulse[] = { { rainbow, 40 }, { dim, 40 } };
+const uint8_t numKeyframes = sizeof(pulse) / sizeof(PaletteKeyframe);
+
+const DisplayStringSpec stringArray[] = { { "PALETTE", TOP, 35, 12, 0, false }, {
+		"ANIMATION", BOTTOM, 35, 12, 0, true } };
+const uint8_t numStrings = sizeof(stringArray) / sizeof(DisplayStringSpec);
+
+TeensyPovDisplay display[2];
+TeensyPovPalette animation;
+uint8_t currentDisplay = 0;
+
+void switchDisplay(TeensyPovDisplay *);
+void startCycle(TeensyPovDisplay *);
+void startPulse(TeensyPovDisplay *);
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Palette Animation");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	// Rainbow sweep: segment data is drawn once, only the palette moves
+	display[0].load();
+	display[0].setDisplay(TeensyPOV::LOG_128_SEGMENTS, numColorBits, tdcSegment,
+			rainbow);
+	display[0].setTiming(10000, 0, 0);
+	display[0].setActivationCallback(startCycle);
+	display[0].setExpireCallback(switchDisplay);
+
+	// Pulsing text
+	display[1].load(stringArray, numStrings);
+	display[1].setDisplay(TeensyPOV::LOG_128_SEGMENTS, numColorBits, tdcSegment,
+			rainbow);
+	display[1].setTiming(10000, 0, 0);
+	display[1].setActivationCallback(startPulse);
+	display[1].setExpireCallback(switchDisplay);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display[currentDisplay].activate();
+}
+
+void loop() {
+	display[currentDisplay].update();
+}
+
+void switchDisplay(TeensyPovDisplay *ptr) {
+	currentDisplay++;
+	currentDisplay %= 2;
+	display[currentDisplay].activate();
+}
+
+void startCycle(TeensyPovDisplay *ptr) {
+	uint16_t segment, pixel, numSegments;
+
+	numSegments = TeensyPOV::getNumSegments();
+	for (segment = 0; segment < numSegments; segment++) {
+		for (pixel = 0; pixel < numLeds; pixel++) {
+			TeensyPOV::setPixel(segment, pixel, (segment * 11) / numSegments + 1);
+		}
+	}
+	animation.cycle(rainbow, 1, 11, 1, 2);
+	ptr->setPaletteAnimation(&animation);
+}
+
+void startPulse(TeensyPovDisplay *ptr) {
+	animation.sequence(pulse, numKeyframes, true);
+	ptr->setPaletteAnimation(&animation);
+}
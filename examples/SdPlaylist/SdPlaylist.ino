@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include <SD.h>
+#include "TeensyPovContent.h"
+
+// Build with POV_DOUBLE_BUFFER defined so the next frame is read while the current one shows
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint16_t numLeds = 36;
+
+CRGB leds[numLeds];
+
+// Entries of show.pov (built by extras/host/povpack) to play, in this order, over and over
+const uint16_t playlist[] = { 0, 2, 1, 2 };
+
+TeensyPovContent content;
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - SD Playlist");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+	if (!SD.begin(BUILTIN_SDCARD) || !content.begin("show.pov")) {
+		Serial.println("Can't open show.pov");
+		return;
+	}
+	Serial.print(content.getNumEntries());
+	Serial.println(" entries");
+	content.setPlaylist(playlist, sizeof(playlist) / sizeof(playlist[0]));
+	content.play();
+}
+
+void loop() {
+	static uint32_t reportTimer = 0;
+	ContentStats stats;
+
+	content.update();
+	if (millis() - reportTimer >= 5000) {
+		reportTimer = millis();
+		content.getStats(&stats);
+		Serial.print("entry: ");
+		Serial.print(content.getPosition());
+		Serial.print("  frames: ");
+		Serial.print(stats.framesShown);
+		Serial.print("  late: ");
+		Serial.print(stats.lateFrames);
+		Serial.print("  errors: ");
+		Serial.print(stats.errors);
+		Serial.print("  longest read us: ");
+		Serial.println(stats.maxReadMicros);
+	}
+}
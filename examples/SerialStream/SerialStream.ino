@@ -0,0 +1,25 @@
+#include <Arduino.h>
+#include "TeensyPovStream.h"
+
+#define NUM_LEDS 36
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint32_t numLeds = NUM_LEDS;
+CRGB leds[numLeds];
+
+// Content arrives from extras/host/povsend (or any other TeensyPovProtocol sender)
+TeensyPovStream stream(Serial);
+
+void setup() {
+	Serial.begin(115200);
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+}
+
+void loop() {
+	stream.poll();
+}
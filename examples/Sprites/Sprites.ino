@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include "TeensyPovDisplay.h"
+#include "TeensyPovSprite.h"
+#include "TeensyPovDraw.h"
+
+const uint8_t clockPin = 13;
+const uint8_t dataPin = 11;
+const uint8_t hallPin = 21;
+const uint8_t numColorBits = TeensyPOV::COLOR_BITS_2;
+const uint8_t logNumSegments = TeensyPOV::LOG_256_SEGMENTS;
+const uint16_t tdcSegment = 0;
+const uint32_t numLeds = 36;
+CRGB leds[numLeds];
+
+const uint32_t colors[] = { CRGB::Black, CRGB::Blue, CRGB::Yellow, CRGB::Red };
+
+// 6 segment by 6 LED diamond, color 0 transparent
+const uint8_t diamondPixels[] = {
+		0, 0, 2, 2, 0, 0,
+		0, 2, 3, 3, 2, 0,
+		2, 3, 3, 3, 3, 2,
+		2, 3, 3, 3, 3, 2,
+		0, 2, 3, 3, 2, 0,
+		0, 0, 2, 2, 0, 0 };
+const SpriteImage diamond = { 6, 6, 0, diamondPixels };
+
+const uint8_t numSprites = 24;
+TeensyPovSprite sprites[numSprites];
+TeensyPovSpriteSet spriteSet;
+TeensyPovDisplay display;
+
+void frameCallback(uint32_t revolution, uint32_t period) {
+	uint8_t index;
+
+	// Bounce off the hub and the rim
+	for (index = 0; index < numSprites; index++) {
+		if (sprites[index].getLed() <= 2 || sprites[index].getLed() >= (int16_t) numLeds - 6) {
+			sprites[index].moveBy(0, (sprites[index].getLed() <= 2) ? 1 : -1);
+			sprites[index].setVelocity(64 + index * 16, (sprites[index].getLed() <= 2) ? 40 : -40);
+		}
+	}
+	spriteSet.step();
+}
+
+void setup() {
+	uint8_t index;
+	uint16_t segment;
+
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.println("Starting POV - Sprites");
+	FastLED.addLeds<APA102, dataPin, clockPin, BGR, DATA_RATE_MHZ(24)>(leds,
+			numLeds);
+
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+
+	display.load();
+	display.setDisplay(logNumSegments, numColorBits, tdcSegment, colors);
+
+	while (!TeensyPOV::rpmGood()) {
+	}
+	display.activate();
+
+	// Background of spokes the sprites fly over
+	TeensyPOV::beginFrame();
+	for (segment = 0; segment < 256; segment += 16) {
+		TeensyPovDraw::spoke(segment, 1);
+	}
+	TeensyPOV::endFrame();
+
+	for (index = 0; index < numSprites; index++) {
+		sprites[index].setImage(&diamond);
+		sprites[index].moveTo(index * (256 / numSprites), 3 + index % 26);
+		sprites[index].setVelocity(64 + index * 16, (index & 1) ? 40 : -40);
+		spriteSet.add(&sprites[index]);
+	}
+	spriteSet.update();
+	TeensyPOV::setFrameCallback(frameCallback, 1);
+}
+
+void loop() {
+	display.update();
+}
@@ -0,0 +1,275 @@
+/*
+ * PovHost.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Host (Linux / macOS) side of TeensyPovProtocol: serial port setup and message I/O shared by the tools in this folder.
+ * The LED and segment limits (povMaxColumns, povMaxNumSegments) come from TeensyPovProtocol.h, so for a library
+ * built with other limits build the tools with the same -DPOV_MAX_LEDS / -DPOV_MAX_LOG_SEGMENTS.
+ */
+
+#ifndef POVHOST_H_
+#define POVHOST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "../../TeensyPovProtocol.h"
+
+static const uint16_t povMaxPayload = 0xFFFF;
+
+struct PovConfig {
+	uint8_t logNumSegments;
+	uint8_t numColorBits;
+	uint16_t tdcSegment;
+	uint16_t numLeds;
+
+	uint32_t numSegments() const {
+		return 1UL << logNumSegments;
+	}
+	uint32_t columns() const {
+		return (numLeds * numColorBits + 31) / 32;
+	}
+	uint32_t pixelsPerWord() const {
+		return 32 / numColorBits;
+	}
+	uint32_t frameWords() const {
+		return numSegments() * columns();
+	}
+};
+
+inline void povPackPixel(const PovConfig &cfg, uint32_t *frame, uint32_t segment,
+		uint32_t pixel, uint32_t value) {
+	// Same packing as TeensyPOV::setPixel(), pixel 0 = innermost LED
+	uint32_t word = segment * cfg.columns() + pixel / cfg.pixelsPerWord();
+	uint32_t shift = (pixel % cfg.pixelsPerWord()) * cfg.numColorBits;
+	uint32_t mask = ((1UL << cfg.numColorBits) - 1) << shift;
+
+	frame[word] = (frame[word] & ~mask) | ((value << shift) & mask);
+}
+
+inline uint32_t povDefaultPalette(uint8_t numColorBits, uint32_t *colors) {
+	// Grays for 1 and 2 bits, 16 basic colors for 4 bits, RGB 3-3-2 for 8 bits. Returns number of entries.
+	static const uint32_t basic[] = { 0x000000, 0xFF0000, 0xFF8000, 0xFFFF00,
+			0x00FF00, 0x00FFFF, 0x0000FF, 0x8000FF, 0xFF00FF, 0xFFFFFF, 0x800000,
+			0x808000, 0x008000, 0x008080, 0x000080, 0x808080 };
+	uint32_t i, n = 1UL << numColorBits;
+
+	for (i = 0; i < n; i++) {
+		if (numColorBits == 4) {
+			colors[i] = basic[i];
+		} else if (numColorBits == 8) {
+			colors[i] = (((i >> 5) * 255 / 7) << 16) | ((((i >> 2) & 7) * 255 / 7) << 8)
+					| ((i & 3) * 255 / 3);
+		} else {
+			colors[i] = (i * 255 / (n - 1)) * 0x010101;
+		}
+	}
+	return n;
+}
+
+inline bool povReadPalette(const char *path, uint32_t *colors, uint32_t *n) {
+	// One RRGGBB hex value per line, up to 256
+	FILE *f = fopen(path, "r");
+	unsigned value;
+
+	if (!f) {
+		return false;
+	}
+	*n = 0;
+	while (*n < 256 && fscanf(f, " %x", &value) == 1) {
+		colors[(*n)++] = value & 0xFFFFFF;
+	}
+	fclose(f);
+	return *n > 0;
+}
+
+inline int povOpenPort(const char *path) {
+	// Raw mode if it's a tty (USB serial ignores the baud rate), plain file / FIFO otherwise
+	struct termios tio;
+	int fd;
+
+	fd = open(path, O_RDWR | O_NOCTTY);
+	if (fd < 0) {
+		return -1;
+	}
+	if (isatty(fd)) {
+		if (tcgetattr(fd, &tio) == 0) {
+			cfmakeraw(&tio);
+			cfsetispeed(&tio, B115200);
+			cfsetospeed(&tio, B115200);
+			tio.c_cc[VMIN] = 0;
+			tio.c_cc[VTIME] = 0;
+			tcsetattr(fd, TCSANOW, &tio);
+		}
+	}
+	return fd;
+}
+
+inline bool povWriteAll(int fd, const uint8_t *data, size_t len) {
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, data, len);
+		if (n < 0) {
+			if (errno == EINTR || errno == EAGAIN) {
+				continue;
+			}
+			return false;
+		}
+		data += n;
+		len -= n;
+	}
+	return true;
+}
+
+inline void povEncodeMessage(std::vector<uint8_t> &out, uint8_t type,
+		const uint8_t *payload, uint16_t len) {
+	PovChecksum sum;
+	uint16_t value;
+	size_t start;
+
+	out.push_back(POV_SYNC_1);
+	out.push_back(POV_SYNC_2);
+	start = out.size();
+	out.push_back(type);
+	out.push_back(len & 0xFF);
+	out.push_back(len >> 8);
+	out.insert(out.end(), payload, payload + len);
+	sum.add(out.data() + start, len + 3);
+	value = sum.value();
+	out.push_back(value & 0xFF);
+	out.push_back(value >> 8);
+}
+
+inline void povPutWord(std::vector<uint8_t> &out, uint32_t word) {
+	out.push_back(word & 0xFF);
+	out.push_back((word >> 8) & 0xFF);
+	out.push_back((word >> 16) & 0xFF);
+	out.push_back(word >> 24);
+}
+
+inline void povEncodeConfig(std::vector<uint8_t> &out, const PovConfig &cfg) {
+	uint8_t payload[povConfigLength] = { cfg.logNumSegments, cfg.numColorBits,
+			(uint8_t) (cfg.tdcSegment & 0xFF), (uint8_t) (cfg.tdcSegment >> 8) };
+	povEncodeMessage(out, POV_CMD_CONFIG, payload, sizeof(payload));
+}
+
+inline void povEncodePalette(std::vector<uint8_t> &out, uint8_t first,
+		const uint32_t *colors, uint16_t n) {
+	std::vector<uint8_t> payload;
+
+	payload.push_back(first);
+	for (uint16_t i = 0; i < n; i++) {
+		povPutWord(payload, colors[i]);
+	}
+	povEncodeMessage(out, POV_CMD_PALETTE, payload.data(), payload.size());
+}
+
+inline void povEncodeSegments(std::vector<uint8_t> &out, const PovConfig &cfg,
+		const uint32_t *frame, uint16_t first, uint16_t count) {
+	// Splits the range so each message fits the 16-bit length
+	std::vector<uint8_t> payload;
+	uint32_t columns = cfg.columns();
+	uint16_t maxCount = (povMaxPayload - povSegmentsHeaderLength) / (columns * 4);
+	uint16_t n;
+	uint8_t type;
+
+	while (count > 0) {
+		n = (count > maxCount) ? maxCount : count;
+		type = (first == 0 && n == cfg.numSegments()) ?
+				POV_CMD_FRAME : POV_CMD_SEGMENTS;
+		payload.clear();
+		payload.push_back(first & 0xFF);
+		payload.push_back(first >> 8);
+		payload.push_back(n & 0xFF);
+		payload.push_back(n >> 8);
+		payload.push_back(columns);
+		for (uint32_t i = first * columns; i < (uint32_t) (first + n) * columns; i++) {
+			povPutWord(payload, frame[i]);
+		}
+		povEncodeMessage(out, type, payload.data(), payload.size());
+		first += n;
+		count -= n;
+	}
+}
+
+inline uint32_t povEncodeDelta(std::vector<uint8_t> &out, const PovConfig &cfg,
+		const uint32_t *frame, const uint32_t *previous) {
+	// Messages for runs of changed segments. Returns number of segments sent.
+	uint32_t columns = cfg.columns(), numSegments = cfg.numSegments();
+	uint32_t segment = 0, start, sent = 0;
+
+	while (segment < numSegments) {
+		if (memcmp(frame + segment * columns, previous + segment * columns,
+				columns * 4) == 0) {
+			segment++;
+			continue;
+		}
+		start = segment;
+		while (segment < numSegments
+				&& memcmp(frame + segment * columns,
+						previous + segment * columns, columns * 4) != 0) {
+			segment++;
+		}
+		povEncodeSegments(out, cfg, frame, start, segment - start);
+		sent += segment - start;
+	}
+	return sent;
+}
+
+inline void povEncodeSwap(std::vector<uint8_t> &out) {
+	povEncodeMessage(out, POV_CMD_SWAP, nullptr, 0);
+}
+
+class PovAckReader {
+	// Collects POV_CMD_ACK messages from the Teensy
+public:
+	int fd;
+	uint8_t buffer[povHeaderLength + povAckLength + povChecksumLength];
+	uint8_t count = 0;
+
+	explicit PovAckReader(int f) :
+			fd(f) {
+	}
+
+	// Returns true and sets command / status when an ACK arrives within timeoutMs
+	bool wait(uint8_t *command, uint8_t *status, int timeoutMs) {
+		struct pollfd pfd = { fd, POLLIN, 0 };
+		uint8_t byte;
+		PovChecksum sum;
+
+		while (poll(&pfd, 1, timeoutMs) > 0) {
+			if (read(fd, &byte, 1) != 1) {
+				return false;
+			}
+			if ((count == 0 && byte != POV_SYNC_1)
+					|| (count == 1 && byte != POV_SYNC_2)
+					|| (count == 2 && byte != POV_CMD_ACK)) {
+				count = (byte == POV_SYNC_1) ? 1 : 0;
+				continue;
+			}
+			buffer[count++] = byte;
+			if (count == sizeof(buffer)) {
+				count = 0;
+				sum = PovChecksum();
+				sum.add(buffer + 2, 5);
+				if ((buffer[7] | (buffer[8] << 8)) == sum.value()) {
+					*command = buffer[5];
+					*status = buffer[6];
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+#endif /* POVHOST_H_ */
@@ -0,0 +1,146 @@
+/*
+ * PovPackFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Content packs (TeensyPovPack.h) memory mapped for the host tools. Nothing is copied: a raw payload is
+ * used in place as the frame's segment words, e.g. as a LedArrayStruct array or a povsend frame, and a
+ * palette as 0x00RRGGBB words. Payloads are aligned to at least 4 bytes in the file and mapped at a page
+ * boundary, so the words are aligned too. Pointers into the file assume a little endian host.
+ */
+
+#ifndef POVPACKFILE_H_
+#define POVPACKFILE_H_
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "../../TeensyPovPack.h"
+
+class PovPackFile {
+private:
+	const uint8_t *map = nullptr;
+	size_t length = 0;
+
+	bool inside(uint64_t offset, uint64_t bytes) const {
+		return offset <= length && bytes <= length - offset;
+	}
+
+public:
+	PovPackHeader header;
+
+	~PovPackFile() {
+		close();
+	}
+
+	bool open(const char *path) {
+		// Maps the whole file. False unless it is a content pack of this version, as long as its header says.
+		struct stat info;
+		void *address;
+		int fd;
+
+		close();
+		if ((fd = ::open(path, O_RDONLY)) < 0) {
+			return false;
+		}
+		if (fstat(fd, &info) || info.st_size < povPackHeaderLength) {
+			::close(fd);
+			return false;
+		}
+		address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (address == MAP_FAILED) {
+			return false;
+		}
+		map = (const uint8_t *) address;
+		length = info.st_size;
+		if (!povPackParseHeader(map, &header) || header.fileSize != length) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close() {
+		if (map) {
+			munmap((void *) map, length);
+			map = nullptr;
+			length = 0;
+		}
+	}
+
+	const uint8_t *data() const {
+		return map;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+	const uint8_t *directory() const {
+		// nullptr if the directory runs past the end of the file
+		return inside(header.directoryOffset, (uint32_t) header.numEntries * povPackEntryLength) ?
+				map + header.directoryOffset : nullptr;
+	}
+
+	bool entry(uint16_t index, PovPackEntry *entry) const {
+		const uint8_t *entries = directory();
+
+		if (!entries || index >= header.numEntries) {
+			return false;
+		}
+		povPackParseEntry(entries + (uint32_t) index * povPackEntryLength, entry);
+		return true;
+	}
+
+	bool frame(const PovPackEntry &entry, uint16_t index, PovPackFrame *frame) const {
+		uint64_t offset = entry.frameTableOffset + (uint64_t) index * povPackFrameLength;
+
+		if (index >= entry.numFrames || !inside(offset, povPackFrameLength)) {
+			return false;
+		}
+		povPackParseFrame(map + offset, frame);
+		return true;
+	}
+
+	const uint32_t *palette(const PovPackEntry &entry) const {
+		// nullptr if out of the file or misaligned
+		return (entry.paletteOffset % 4 == 0 && inside(entry.paletteOffset, entry.numPaletteEntries * 4U)) ?
+				(const uint32_t *) (map + entry.paletteOffset) : nullptr;
+	}
+
+	const uint8_t *payload(const PovPackFrame &frame) const {
+		return inside(frame.offset, frame.length) ? map + frame.offset : nullptr;
+	}
+
+	const uint32_t *rawFrame(const PovPackEntry &entry, const PovPackFrame &frame) const {
+		// The frame's segment words in place, or nullptr if it is run length coded, out of the file or misaligned
+		if ((frame.flags & POV_PACK_RLE) || frame.length != entry.frameBytes() || frame.offset % 4
+				|| !payload(frame)) {
+			return nullptr;
+		}
+		return (const uint32_t *) (map + frame.offset);
+	}
+
+	bool decodeFrame(const PovPackEntry &entry, const PovPackFrame &frame,
+			std::vector<uint32_t> &words) const {
+		// Any frame as segment words. False if the payload is out of the file or doesn't decode to a whole frame.
+		const uint32_t *raw = rawFrame(entry, frame);
+		const uint8_t *stored = payload(frame);
+		uint32_t numWords = entry.frameBytes() / 4;
+
+		if (raw) {
+			words.assign(raw, raw + numWords);
+			return true;
+		}
+		words.assign(numWords, 0);
+		return stored && (frame.flags & POV_PACK_RLE)
+				&& povPackDecodeRle(stored, frame.length, words.data(), numWords);
+	}
+};
+
+#endif /* POVPACKFILE_H_ */
@@ -0,0 +1,91 @@
+/*
+ * PovTrace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * LED trace files, written by povsim and read by povrender. Little endian:
+ * 	Header: "POVT", version (2 bytes), number of LEDs (2 bytes), clock rate of the time stamps in Hz (4 bytes)
+ * 	Then one record per FastLED.show(): time (8 bytes), rotor position in 1/2^32 revolution since the
+ * 	start (8 bytes; the Hall sensor is at whole revolutions), then R, G, B of each LED, innermost first.
+ * The LEDs show a record's colors from its position up to the next record's.
+ */
+
+#ifndef POVTRACE_H_
+#define POVTRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint16_t povTraceVersion = 1;
+static const uint32_t povTraceHeaderLength = 12;
+static const uint32_t povTraceStampLength = 16;
+static const double povTraceRevolution = 4294967296.0;
+
+struct PovTraceRecord {
+	uint64_t ticks;
+	uint64_t position;
+	uint8_t rgb[3 * 255];
+};
+
+inline void povTracePut(uint8_t *out, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out[i] = value >> (8 * i);
+	}
+}
+
+inline uint64_t povTraceGet(const uint8_t *in, int bytes) {
+	uint64_t value = 0;
+
+	while (bytes--) {
+		value = (value << 8) | in[bytes];
+	}
+	return value;
+}
+
+inline bool povTraceWriteHeader(FILE *f, uint16_t numLeds, uint32_t tickRate) {
+	uint8_t header[povTraceHeaderLength];
+
+	memcpy(header, "POVT", 4);
+	povTracePut(header + 4, povTraceVersion, 2);
+	povTracePut(header + 6, numLeds, 2);
+	povTracePut(header + 8, tickRate, 4);
+	return fwrite(header, 1, sizeof(header), f) == sizeof(header);
+}
+
+inline bool povTraceWrite(FILE *f, uint64_t ticks, uint64_t position, const uint8_t *rgb,
+		uint16_t numLeds) {
+	uint8_t stamp[povTraceStampLength];
+
+	povTracePut(stamp, ticks, 8);
+	povTracePut(stamp + 8, position, 8);
+	return fwrite(stamp, 1, sizeof(stamp), f) == sizeof(stamp)
+			&& fwrite(rgb, 3, numLeds, f) == numLeds;
+}
+
+inline bool povTraceReadHeader(FILE *f, uint16_t *numLeds, uint32_t *tickRate) {
+	uint8_t header[povTraceHeaderLength];
+
+	if (fread(header, 1, sizeof(header), f) != sizeof(header) || memcmp(header, "POVT", 4)
+			|| povTraceGet(header + 4, 2) != povTraceVersion) {
+		return false;
+	}
+	*numLeds = povTraceGet(header + 6, 2);
+	*tickRate = povTraceGet(header + 8, 4);
+	return *numLeds > 0 && *numLeds <= 255 && *tickRate > 0;
+}
+
+inline bool povTraceRead(FILE *f, PovTraceRecord *record, uint16_t numLeds) {
+	uint8_t stamp[povTraceStampLength];
+
+	if (fread(stamp, 1, sizeof(stamp), f) != sizeof(stamp)
+			|| fread(record->rgb, 3, numLeds, f) != numLeds) {
+		return false;
+	}
+	record->ticks = povTraceGet(stamp, 8);
+	record->position = povTraceGet(stamp + 8, 8);
+	return true;
+}
+
+#endif /* POVTRACE_H_ */
@@ -0,0 +1,174 @@
+/*
+ * povaudio.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Stand-in for TeensyPovAudio's ADC input: runs the same fixed point analysis (TeensyPovFft) over a WAV
+ * file, one 256 sample window per simulated revolution, and prints the band levels as text bars. Use it
+ * to pick the band count, floor and span for a venue's audio before taking the fan there.
+ *
+ * Build:  g++ -O2 -std=c++11 -I../.. -o povaudio povaudio.cpp ../../TeensyPovFft.cpp
+ * Usage:  povaudio [options] <file.wav>
+ * 	-b BANDS  Number of bands: 1, 2, 4, 8 or 16 (default 16)
+ * 	-r RPS    Revolutions per second, i.e. analyses per second of audio (default 20)
+ * 	-s RATE   Sample rate the Teensy would use; the file is decimated to about this (default 8000)
+ * 	-f FLOOR  Level drawn as nothing (default 40, as TeensyPovAudio::setRange())
+ * 	-w SPAN   Levels above the floor for a full bar (default 64)
+ * 	-q        Only print the totals
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include "TeensyPovFft.h"
+
+static uint32_t readLe(const uint8_t *p, int n) {
+	uint32_t value = 0;
+
+	while (n--) {
+		value = (value << 8) | p[n];
+	}
+	return value;
+}
+
+static bool readWav(const char *name, std::vector<int16_t> &samples, uint32_t *rate) {
+	// 16 bit PCM, any number of channels (mixed to mono)
+	FILE *file = fopen(name, "rb");
+	uint8_t header[12], chunk[8], format[16];
+	uint32_t size, channels = 0, bits = 0, i, c;
+	int32_t sum;
+	std::vector<uint8_t> data;
+
+	if (!file || fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4)
+			|| memcmp(header + 8, "WAVE", 4)) {
+		if (file) {
+			fclose(file);
+		}
+		return false;
+	}
+	while (fread(chunk, 1, 8, file) == 8) {
+		size = readLe(chunk + 4, 4);
+		if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+			if (fread(format, 1, 16, file) != 16) {
+				break;
+			}
+			fseek(file, size - 16 + (size & 1), SEEK_CUR);
+			channels = readLe(format + 2, 2);
+			*rate = readLe(format + 4, 4);
+			bits = readLe(format + 14, 2);
+			if (readLe(format, 2) != 1 || bits != 16 || channels == 0) {
+				break;
+			}
+		} else if (!memcmp(chunk, "data", 4) && channels) {
+			data.resize(size);
+			size = fread(data.data(), 1, size, file);
+			samples.resize(size / (2 * channels));
+			for (i = 0; i < samples.size(); i++) {
+				sum = 0;
+				for (c = 0; c < channels; c++) {
+					sum += (int16_t) readLe(&data[(i * channels + c) * 2], 2);
+				}
+				samples[i] = sum / (int32_t) channels;
+			}
+			fclose(file);
+			return true;
+		} else {
+			fseek(file, size + (size & 1), SEEK_CUR);
+		}
+	}
+	fclose(file);
+	return false;
+}
+
+int main(int argc, char **argv) {
+	static const char shades[] = " .:-=+*#%@";
+	std::vector<int16_t> input, samples;
+	uint32_t bands = 16, rps = 20, targetRate = 8000, floorLevel = 40, span = 64;
+	uint32_t fileRate = 0, factor, rate, hop, position, band, bar, analyses = 0;
+	uint32_t peakBand[TeensyPovFft::maxBands] = { 0 };
+	int32_t sum;
+	bool quiet = false;
+	double seconds = 0;
+	struct timespec start, stop;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:r:s:f:w:q")) != -1) {
+		switch (opt) {
+		case 'b': bands = atoi(optarg); break;
+		case 'r': rps = atoi(optarg); break;
+		case 's': targetRate = atoi(optarg); break;
+		case 'f': floorLevel = atoi(optarg); break;
+		case 'w': span = atoi(optarg); break;
+		case 'q': quiet = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-b bands] [-r rps] [-s rate] [-f floor] "
+					"[-w span] [-q] file.wav\n", argv[0]);
+			return 1;
+		}
+	}
+	TeensyPovFft fft(bands);
+	if (optind >= argc || fft.getNumBands() != bands || rps == 0 || targetRate == 0
+			|| span == 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 1;
+	}
+	if (!readWav(argv[optind], input, &fileRate)) {
+		fprintf(stderr, "can't read %s (16 bit PCM WAV only)\n", argv[optind]);
+		return 1;
+	}
+
+	// Average groups of samples down to about the Teensy's rate, as its anti-alias filter would
+	factor = (fileRate + targetRate / 2) / targetRate;
+	factor = factor ? factor : 1;
+	rate = fileRate / factor;
+	for (position = 0; position + factor <= input.size(); position += factor) {
+		sum = 0;
+		for (band = 0; band < factor; band++) {
+			sum += input[position + band];
+		}
+		samples.push_back(sum / (int32_t) factor);
+	}
+	hop = rate / rps;
+	hop = hop ? hop : 1;
+	if (!quiet) {
+		printf("%u Hz / %u = %u Hz, band edges at bins of %u Hz\n", fileRate, factor,
+				rate, rate / TeensyPovFft::size);
+	}
+
+	for (position = TeensyPovFft::size; position <= samples.size(); position += hop) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		fft.analyze(&samples[position - TeensyPovFft::size]);
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		seconds += (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;
+		analyses++;
+
+		if (!quiet) {
+			printf("%7.2f %3u |", (double) position / rate, fft.getLevel());
+		}
+		for (band = 0; band < bands; band++) {
+			if (fft.getLevels()[band] > peakBand[band]) {
+				peakBand[band] = fft.getLevels()[band];
+			}
+			if (!quiet) {
+				bar = (fft.getLevels()[band] > floorLevel) ?
+						(fft.getLevels()[band] - floorLevel) * 9 / span : 0;
+				putchar(shades[(bar > 9) ? 9 : bar]);
+			}
+		}
+		if (!quiet) {
+			printf("|\n");
+		}
+	}
+
+	printf("%u analyses, %.1f us each on this host\npeak levels:", analyses,
+			analyses ? seconds * 1e6 / analyses : 0.0);
+	for (band = 0; band < bands; band++) {
+		printf(" %u", peakBand[band]);
+	}
+	printf("\n");
+	return 0;
+}
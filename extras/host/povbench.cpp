@@ -0,0 +1,331 @@
+/*
+ * povbench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Angular accuracy benchmark of the segment timing (tdcIsrActive(), segmentTimerIsr()) on the host
+ * simulator (sim/PovSim.cpp). Each rotor profile is run under each overrun policy, from a fresh
+ * simulation each time, and compared side by side:
+ * 	error     Where each segment was shown against where it belongs (segment s at s / N of a revolution
+ * 	          past the Hall sensor), in degrees: mean, RMS and largest. It includes the time the LED data
+ * 	          takes to clock out, a constant lag.
+ * 	missed    Segments not shown at all, per revolution
+ * 	compr     Segments the library's compression kept from being dropped by a speeding rotor (telemetry),
+ * 	          per revolution
+ * 	blank     Angle left dark beyond the nominal segment width, e.g. waiting for a late TDC, as a
+ * 	          percentage of all the angle swept
+ * The segments are recognized from the LEDs alone: the pattern writes each segment's number into the
+ * first two LEDs (blue, palette entry = value), so the library is benchmarked exactly as built.
+ *
+ * Profiles, over the run time (default 2 s):
+ * 	steady    20 rev/s
+ * 	rampup    14 to 30 rev/s
+ * 	rampdown  30 to 14 rev/s
+ * 	wobble    20 rev/s +/- 1.5 at 3 Hz
+ * 	jitter    20 rev/s, Hall interrupt up to 20 us late (-j)
+ * 	file      From -f: lines of "seconds rev/s", linearly interpolated (e.g. logged from a real fan)
+ *
+ * Build:  g++ -O2 -std=gnu++14 -Isim -I../.. -o povbench povbench.cpp sim/PovSim.cpp ../../[Tt]*.cpp
+ * Usage:  povbench [options]
+ * 	-s LOG      Log2 of the number of segments (default 8)
+ * 	-t SECONDS  Run time of each profile (default 2)
+ * 	-j US       Hall jitter of the jitter profile (default 20)
+ * 	-m MHZ      LED data clock (default 24)
+ * 	-p NAME     Only this profile
+ * 	-f FILE     Add a recorded profile
+ * 	-o FILE     Write every segment's error as CSV: profile, policy, revolution, segment, degrees
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "PovHost.h"
+#include "sim/PovSim.h"
+#include "TeensyPovDisplay.h"
+
+static const uint8_t hallPin = 21;
+static const uint8_t numLeds = 36;
+static const uint8_t markerLed = 2;				// Always lit, tells segments from blanking
+static const uint32_t spinUpLimit = 5000;		// ms
+static const uint8_t warmUpRevolutions = 2;
+
+struct RpmProfile {
+	const char *name;
+	double (*rps)(double t);
+	bool jitter;
+};
+
+static double runTime = 2;
+static std::vector<double> fileTimes, fileRps;
+
+static double steady(double) {
+	return 20;
+}
+
+static double rampUp(double t) {
+	return 14 + 16 * ((t < runTime) ? t / runTime : 1);
+}
+
+static double rampDown(double t) {
+	return 30 - 16 * ((t < runTime) ? t / runTime : 1);
+}
+
+static double wobble(double t) {
+	return 20 + 1.5 * sin(2 * M_PI * 3 * t);
+}
+
+static double recorded(double t) {
+	size_t i;
+
+	if (t <= fileTimes.front()) {
+		return fileRps.front();
+	}
+	for (i = 1; i < fileTimes.size(); i++) {
+		if (t < fileTimes[i]) {
+			return fileRps[i - 1] + (fileRps[i] - fileRps[i - 1]) * (t - fileTimes[i - 1])
+					/ (fileTimes[i] - fileTimes[i - 1]);
+		}
+	}
+	return fileRps.back();
+}
+
+static bool readProfile(const char *path) {
+	FILE *f = fopen(path, "r");
+	double t, rps;
+
+	if (!f) {
+		return false;
+	}
+	while (fscanf(f, "%lf %lf", &t, &rps) == 2) {
+		if (!fileTimes.empty() && t <= fileTimes.back()) {
+			break;
+		}
+		fileTimes.push_back(t);
+		fileRps.push_back(rps);
+	}
+	fclose(f);
+	return !fileTimes.empty();
+}
+
+// Measurements, made by the show() hook
+static struct {
+	uint32_t numSegments;
+	uint64_t segments;
+	double sum, sumSquares, largest;
+	uint64_t missed;
+	uint64_t revolutions;
+	uint64_t revolution;				// Current one, UINT64_MAX before the first
+	std::vector<bool> shown;
+	uint64_t lastStart;					// Position of the last segment shown
+	uint64_t firstPosition;
+	uint64_t blank;						// Position units
+	FILE *csv;
+	const char *profile, *policy;
+} m;
+
+static void measureShow(uint64_t, uint64_t position, const CRGB *leds, uint16_t) {
+	uint32_t segment, count;
+	uint64_t revolution = position >> 32, nominal = (1ULL << 32) / m.numSegments;
+	double error;
+
+	if (leds[markerLed].b == 0) {
+		return;
+	}
+	segment = leds[0].b | (leds[1].b << 8);
+	if (revolution != m.revolution) {
+		// Only revolutions seen from their start count for missed segments
+		if (m.revolution != UINT64_MAX && m.revolution >= (m.firstPosition >> 32) + 1) {
+			count = 0;
+			for (bool s : m.shown) {
+				count += s;
+			}
+			m.missed += m.numSegments - count;
+			m.revolutions++;
+		}
+		m.shown.assign(m.numSegments, false);
+		m.revolution = revolution;
+	}
+	m.shown[segment] = true;
+
+	// Wrapped to +/- half a revolution
+	error = (double) (uint32_t) position / povSimPositionScale - (double) segment / m.numSegments;
+	error -= floor(error + 0.5);
+	error *= 360;
+	m.segments++;
+	m.sum += error;
+	m.sumSquares += error * error;
+	if (fabs(error) > m.largest) {
+		m.largest = fabs(error);
+	}
+	if (m.csv) {
+		fprintf(m.csv, "%s,%s,%llu,%u,%.4f\n", m.profile, m.policy,
+				(unsigned long long) revolution, segment, error);
+	}
+
+	if (m.lastStart && position - m.lastStart > nominal) {
+		m.blank += position - m.lastStart - nominal;
+	}
+	m.lastStart = position;
+}
+
+static void makePattern(const PovConfig &cfg, std::vector<uint32_t> &frame) {
+	uint32_t segment;
+
+	frame.assign(cfg.frameWords(), 0);
+	for (segment = 0; segment < cfg.numSegments(); segment++) {
+		povPackPixel(cfg, frame.data(), segment, 0, segment & 0xFF);
+		povPackPixel(cfg, frame.data(), segment, 1, segment >> 8);
+		povPackPixel(cfg, frame.data(), segment, markerLed, 0xFF);
+	}
+}
+
+static void run(const RpmProfile &profile, uint8_t policy, const char *policyName, uint8_t logSegments,
+		uint32_t ledMhz, double jitter) {
+	// In a fresh process, so the library and the simulator start from power on
+	static CRGB leds[numLeds];
+	static uint32_t colors[256];
+	PovConfig cfg = { logSegments, 8, 0, numLeds };
+	std::vector<uint32_t> frame;
+	LedArrayStruct pattern;
+	TeensyPovDisplay display;
+	PovTelemetry telemetry;
+	uint32_t start, ms, steps = (uint32_t) (runTime * 1000 + 0.5);
+	uint64_t ready;
+	double rps, next, angle;
+
+	for (uint32_t i = 0; i < 256; i++) {
+		colors[i] = i;
+	}
+	makePattern(cfg, frame);
+	pattern = { frame.data(), colors, 8, logSegments, cfg.columns(), 0 };
+
+	FastLED.addLeds<APA102, 11, 13, BGR>(leds, numLeds);
+	povSimSetLedClock(DATA_RATE_MHZ(ledMhz));
+	TeensyPOV::povSetup(hallPin, leds, numLeds);
+	TeensyPOV::setOverrunPolicy(policy);
+	display.load(&pattern);
+	display.setDisplay(logSegments, 8, 0, colors);
+	if (profile.jitter) {
+		povSimSetHallJitter(jitter);
+	}
+
+	// Spin up at the profile's starting speed, activate, and let the display settle
+	povSimSetRotor(profile.rps(0));
+	start = millis();
+	while (!TeensyPOV::rpmGood() && millis() - start < spinUpLimit) {
+		delay(1);
+	}
+	display.activate();
+	while (!TeensyPOV::rpmGood() && millis() - start < spinUpLimit) {
+		delay(1);
+	}
+	if (!TeensyPOV::rpmGood()) {
+		printf("%-9s %-9s  no display\n", profile.name, policyName);
+		return;
+	}
+	ready = povSimHallEdges() + warmUpRevolutions;
+	while (povSimHallEdges() < ready) {
+		delay(1);
+	}
+
+	TeensyPOV::clearTelemetry();
+	m.numSegments = 1UL << logSegments;
+	m.revolution = UINT64_MAX;
+	m.firstPosition = povSimPosition();
+	m.profile = profile.name;
+	m.policy = policyName;
+	povSimSetShowHook(measureShow);
+	for (ms = 0; ms < steps; ms++) {
+		// Speed linear over each millisecond
+		rps = profile.rps(ms / 1000.0);
+		next = profile.rps((ms + 1) / 1000.0);
+		povSimSetRotor(rps, (next - rps) * 1000);
+		display.update();
+		delay(1);
+	}
+	povSimSetShowHook(nullptr);
+	TeensyPOV::getTelemetry(&telemetry);
+
+	angle = (double) (povSimPosition() - m.firstPosition);
+	printf("%-9s %-9s %7llu %7.3f %7.3f %7.3f %8.2f %9.1f %6.2f\n", profile.name, policyName,
+			(unsigned long long) m.segments, m.segments ? m.sum / m.segments : 0.0,
+			m.segments ? sqrt(m.sumSquares / m.segments) : 0.0, m.largest,
+			m.revolutions ? (double) m.missed / m.revolutions : 0.0,
+			telemetry.revolutions ? (double) telemetry.compressedSegments / telemetry.revolutions : 0.0,
+			angle > 0 ? 100 * m.blank / angle : 0.0);
+}
+
+int main(int argc, char **argv) {
+	static const RpmProfile profiles[] = { { "steady", steady, false }, { "rampup", rampUp, false },
+			{ "rampdown", rampDown, false }, { "wobble", wobble, false },
+			{ "jitter", steady, true }, { "file", recorded, false } };
+	static const char * const policyNames[] = { "skip", "compress", "correct" };
+	const char *only = nullptr, *profileFile = nullptr, *csvFile = nullptr;
+	uint32_t logSegments = 8, ledMhz = 24;
+	double jitter = 20e-6;
+	uint8_t policy;
+	size_t p;
+	pid_t child;
+	int opt, status;
+
+	while ((opt = getopt(argc, argv, "s:t:j:m:p:f:o:")) != -1) {
+		switch (opt) {
+		case 's': logSegments = atoi(optarg); break;
+		case 't': runTime = atof(optarg); break;
+		case 'j': jitter = atof(optarg) * 1e-6; break;
+		case 'm': ledMhz = atoi(optarg); break;
+		case 'p': only = optarg; break;
+		case 'f': profileFile = optarg; break;
+		case 'o': csvFile = optarg; break;
+		default:
+			fprintf(stderr, "usage: %s [-s log segments] [-t seconds] [-j us] [-m mhz] [-p profile] "
+					"[-f profile file] [-o errors.csv]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (logSegments < 1 || logSegments > TeensyPOV::maxLogNumSegments || runTime <= 0
+			|| ledMhz == 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 1;
+	}
+	if (profileFile && !readProfile(profileFile)) {
+		fprintf(stderr, "can't read profile %s\n", profileFile);
+		return 1;
+	}
+	if (csvFile && !(m.csv = fopen(csvFile, "w"))) {
+		perror(csvFile);
+		return 1;
+	}
+
+	printf("%u segments, %.1f s per run\n", 1U << logSegments, runTime);
+	printf("%-9s %-9s %7s %7s %7s %7s %8s %9s %6s\n", "profile", "policy", "shown", "mean",
+			"rms", "max", "miss/rev", "compr/rev", "blank%");
+	for (p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+		if ((only && strcmp(only, profiles[p].name))
+				|| (profiles[p].rps == recorded && !profileFile)) {
+			continue;
+		}
+		for (policy = TeensyPOV::OVERRUN_SKIP; policy <= TeensyPOV::OVERRUN_CORRECT; policy++) {
+			fflush(stdout);
+			if (m.csv) {
+				fflush(m.csv);
+			}
+			if ((child = fork()) == 0) {
+				run(profiles[p], policy, policyNames[policy], logSegments, ledMhz, jitter);
+				fflush(stdout);
+				if (m.csv) {
+					fflush(m.csv);
+				}
+				_exit(0);
+			}
+			if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status)) {
+				fprintf(stderr, "%s / %s failed\n", profiles[p].name, policyNames[policy]);
+			}
+		}
+	}
+	if (m.csv) {
+		fclose(m.csv);
+	}
+	return 0;
+}
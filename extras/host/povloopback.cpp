@@ -0,0 +1,425 @@
+/*
+ * povloopback.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Loopback test of TeensyPovStream: povsend -> pseudo terminal -> TeensyPovStream on the host simulator
+ * (sim/PovSim.cpp). Writes random frames and a random palette to temporary files, runs povsend on them
+ * against the slave side of a pseudo terminal and feeds the master side to a TeensyPovStream, exactly as
+ * a Teensy running examples/SerialStream would see it over USB. After every swap has taken effect, each
+ * segment's LEDs over a whole revolution are compared with the segment words and palette that were sent,
+ * so the test sees the library exactly as built.
+ *
+ * Each scenario runs from a fresh simulation:
+ * 	full      Every frame in full. The first segment word of every third frame is corrupted on the way
+ * 	          in: that frame must be rejected (checksum) and the previous one stay on display.
+ * 	delta     After the first frame only the segments that changed (povsend -d), in several runs.
+ *
+ * Build:  g++ -O2 -std=gnu++14 -DPOV_DOUBLE_BUFFER -Isim -I../.. -o povloopback povloopback.cpp sim/PovSim.cpp ../../[Tt]*.cpp
+ * 	povsend must be built too (see povsend.cpp), both with the same -DPOV_MAX_LEDS / -DPOV_MAX_LOG_SEGMENTS
+ * 	for more LEDs than the default.
+ * Usage:  povloopback [options]
+ * 	-x PATH     povsend to run (default ./povsend)
+ * 	-s LOG      Log2 of the number of segments (default 7)
+ * 	-b BITS     Color bits: 1, 2, 4 or 8 (default 4)
+ * 	-l LEDS     Number of LEDs (default 36)
+ * 	-n FRAMES   Frames per scenario (default 20)
+ * Exit status 0 if every frame and the palette arrived intact, 1 otherwise.
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include "PovHost.h"
+#include "sim/PovSim.h"
+#include "TeensyPovStream.h"
+
+#ifndef POV_DOUBLE_BUFFER
+#error "Build with -DPOV_DOUBLE_BUFFER: TeensyPovStream only shows frames after a swap with it"
+#endif  // POV_DOUBLE_BUFFER
+
+static const uint8_t hallPin = 21;
+static const uint32_t spinUpLimit = 5000;			// ms
+static const int idleMs = 2;						// Real time to wait for bytes from povsend
+static const int drainMs = 200;						// After it exits
+static const uint32_t minLedClock = DATA_RATE_MHZ(24);
+static const uint32_t rotorSpeed = 20;				// Revolutions per second
+
+class PtyStream: public Stream {
+	// The master side of the pseudo terminal as a Stream. Bytes read pass through a parser of the
+	// message framing so a payload byte can be corrupted on the way in.
+private:
+	int fd;
+	uint32_t position = 0, length = 0, swaps = 0;
+	uint8_t type = 0;
+	bool corrupted = false;
+
+	uint8_t corrupt(uint8_t byte) {
+		// position counts from the first sync byte; the payload starts at povHeaderLength
+		if (position == 2) {
+			type = byte;
+		} else if (position == 3) {
+			length = byte;
+		} else if (position == 4) {
+			length |= byte << 8;
+		} else if (position == povHeaderLength + povSegmentsHeaderLength && corruptEvery > 0
+				&& (type == POV_CMD_FRAME || type == POV_CMD_SEGMENTS)
+				&& swaps % corruptEvery == 0 && swaps > 0) {
+			byte ^= 0x55;
+			corrupted = true;
+		}
+		if (++position == povHeaderLength + length + povChecksumLength) {
+			if (type == POV_CMD_SWAP) {
+				if (corrupted) {
+					corruptedFrames.push_back(swaps - 1);
+				}
+				corrupted = false;
+				swaps++;
+			}
+			position = 0;
+		}
+		return byte;
+	}
+
+public:
+	uint32_t corruptEvery = 0;				// Swaps, 0 for none
+	std::vector<uint32_t> corruptedFrames;
+
+	explicit PtyStream(int f) :
+			fd(f) {
+	}
+	int available(void) {
+		int n = 0;
+
+		return (ioctl(fd, FIONREAD, &n) == 0) ? n : 0;
+	}
+	int read(void) {
+		uint8_t byte;
+
+		if (::read(fd, &byte, 1) != 1) {
+			return -1;
+		}
+		return corrupt(byte);
+	}
+	int peek(void) {
+		return -1;
+	}
+	size_t write(uint8_t byte) {
+		return povWriteAll(fd, &byte, 1) ? 1 : 0;
+	}
+	using Print::write;
+};
+
+static const char *povsend = "./povsend";
+static PovConfig cfg = { 7, 4, 0, 36 };
+static uint32_t numFrames = 20;
+
+static void randomFrames(std::vector<uint32_t> &frames, bool delta) {
+	// Random pixels; with delta a few runs of segments change from one frame to the next
+	uint32_t words = cfg.frameWords(), numColors = 1UL << cfg.numColorBits;
+	uint32_t frame, segment, pixel, run, start, count;
+	uint32_t *current, *previous;
+
+	frames.assign((size_t) words * numFrames, 0);
+	for (frame = 0; frame < numFrames; frame++) {
+		current = frames.data() + (size_t) frame * words;
+		if (frame == 0 || !delta) {
+			for (segment = 0; segment < cfg.numSegments(); segment++) {
+				for (pixel = 0; pixel < cfg.numLeds; pixel++) {
+					povPackPixel(cfg, current, segment, pixel, rand() % numColors);
+				}
+			}
+			continue;
+		}
+		previous = current - words;
+		memcpy(current, previous, words * 4);
+		for (run = 0; run < 3; run++) {
+			start = rand() % cfg.numSegments();
+			count = 1 + rand() % 8;
+			for (segment = start; segment < start + count && segment < cfg.numSegments(); segment++) {
+				for (pixel = 0; pixel < cfg.numLeds; pixel++) {
+					povPackPixel(cfg, current, segment, pixel, rand() % numColors);
+				}
+			}
+		}
+	}
+}
+
+static bool writeFiles(const std::vector<uint32_t> &frames, const std::vector<uint32_t> &palette,
+		char *framePath, char *palettePath) {
+	FILE *f;
+	int fd;
+	bool ok;
+
+	if ((fd = mkstemp(framePath)) < 0 || !(f = fdopen(fd, "wb"))) {
+		return false;
+	}
+	ok = fwrite(frames.data(), 4, frames.size(), f) == frames.size();
+	ok = (fclose(f) == 0) && ok;
+	if (!ok || (fd = mkstemp(palettePath)) < 0 || !(f = fdopen(fd, "w"))) {
+		return false;
+	}
+	for (uint32_t color : palette) {
+		fprintf(f, "%06X\n", color);
+	}
+	return fclose(f) == 0;
+}
+
+// What the LEDs showed over one revolution, by the show() hook
+static struct {
+	bool recording;
+	uint64_t revolution;
+	std::vector<bool> shown;
+	std::vector<CRGB> leds;
+} capture;
+
+static void recordShow(uint64_t, uint64_t position, const CRGB *leds, uint16_t numLeds) {
+	// Segment s is shown from s / N of a revolution past the Hall edge (TDC segment 0), less than a
+	// segment late. Skips the blanking between segments: no palette entry is black.
+	uint32_t segment;
+	uint16_t led;
+
+	if (!capture.recording || (position >> 32) != capture.revolution) {
+		return;
+	}
+	for (led = 0; led < numLeds && !(leds[led].r | leds[led].g | leds[led].b); led++) {
+	}
+	if (led == numLeds) {
+		return;
+	}
+	segment = ((position & 0xFFFFFFFF) << cfg.logNumSegments) >> 32;
+	capture.shown[segment] = true;
+	memcpy(&capture.leds[segment * cfg.numLeds], leds, numLeds * sizeof(CRGB));
+}
+
+static uint32_t ledClock() {
+	// Fast enough that each segment has time for its LED update and the blanking after it (bits as
+	// povSimShow()); long strings at many segments need more than real APA102s manage
+	uint32_t bits = 32 + 32 * cfg.numLeds + 8 * ((cfg.numLeds + 15) / 16);
+
+	return max(minLedClock, 3 * bits * cfg.numSegments() * rotorSpeed);
+}
+
+static bool check(const uint32_t *expected, const std::vector<uint32_t> &palette, uint32_t swap) {
+	// Lets the swap take effect, then records a revolution and compares every segment's LEDs with the
+	// segment words and palette that were sent
+	uint32_t segment, led, word, value, start;
+	CRGB color;
+
+	start = millis();
+	while (!TeensyPOV::rpmGood()) {
+		if (millis() - start > spinUpLimit) {
+			printf("  swap %u: display never came on\n", swap);
+			return false;
+		}
+		delay(1);
+	}
+	// The swap is done by the next TDC, record the whole revolution after that
+	capture.revolution = (povSimPosition() >> 32) + 2;
+	capture.shown.assign(cfg.numSegments(), false);
+	capture.leds.assign(cfg.numSegments() * cfg.numLeds, CRGB((uint32_t) 0));
+	capture.recording = true;
+	while ((povSimPosition() >> 32) <= capture.revolution) {
+		delay(1);
+	}
+	capture.recording = false;
+
+	for (segment = 0; segment < cfg.numSegments(); segment++) {
+		if (!capture.shown[segment]) {
+			printf("  swap %u: segment %u not shown\n", swap, segment);
+			return false;
+		}
+		for (led = 0; led < cfg.numLeds; led++) {
+			word = expected[segment * cfg.columns() + led / cfg.pixelsPerWord()];
+			value = (word >> ((led % cfg.pixelsPerWord()) * cfg.numColorBits))
+					& ((1UL << cfg.numColorBits) - 1);
+			color = CRGB(palette[value]);
+			if (capture.leds[segment * cfg.numLeds + led] != color) {
+				printf("  swap %u: segment %u LED %u shows %02X%02X%02X, sent entry %u = %06X\n", swap,
+						segment, led, capture.leds[segment * cfg.numLeds + led].r,
+						capture.leds[segment * cfg.numLeds + led].g,
+						capture.leds[segment * cfg.numLeds + led].b, value, palette[value]);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool run(const char *name, bool delta, uint32_t corruptEvery) {
+	std::vector<uint32_t> frames, palette(1UL << cfg.numColorBits);
+	std::vector<uint32_t> blank(cfg.frameWords(), 0);
+	static CRGB leds[255];
+	char framePath[] = "/tmp/povloopbackXXXXXX", palettePath[] = "/tmp/povloopbackXXXXXX";
+	char arguments[4][16];
+	const char *argv[20];
+	const uint32_t *expected = blank.data();
+	uint32_t swaps = 0, frame;
+	bool ok = true, done = false, exited = false;
+	int master, slave, status = 0, argc = 0, null;
+	struct termios tio;
+	struct pollfd pfd;
+	pid_t child;
+	uint8_t completed;
+
+	srand(cfg.logNumSegments * 1000 + cfg.numColorBits * 10 + delta);
+	randomFrames(frames, delta);
+	for (uint32_t &color : palette) {
+		color = (rand() & 0xFFFFFF) | 0x000001;		// Never black, see recordShow()
+	}
+	if (!writeFiles(frames, palette, framePath, palettePath)) {
+		perror("temporary files");
+		return false;
+	}
+
+	// Pseudo terminal, raw on the slave side as povsend sets it. The slave stays open here too, so
+	// what povsend wrote can still be read after it exits.
+	if ((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0 || grantpt(master) || unlockpt(master)
+			|| (slave = open(ptsname(master), O_RDWR | O_NOCTTY)) < 0) {
+		perror("pseudo terminal");
+		return false;
+	}
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	// povsend at a high frame rate: it still waits for each swap's ACK
+	snprintf(arguments[0], sizeof(arguments[0]), "%u", cfg.logNumSegments);
+	snprintf(arguments[1], sizeof(arguments[1]), "%u", cfg.numColorBits);
+	snprintf(arguments[2], sizeof(arguments[2]), "%u", cfg.numLeds);
+	snprintf(arguments[3], sizeof(arguments[3]), "%u", cfg.tdcSegment);
+	for (const char *argument : { povsend, "-s", (const char *) arguments[0], "-b",
+			(const char *) arguments[1], "-l", (const char *) arguments[2], "-t",
+			(const char *) arguments[3], "-r", "1000", "-p", (const char *) palettePath, "-f",
+			(const char *) framePath }) {
+		argv[argc++] = argument;
+	}
+	if (delta) {
+		argv[argc++] = "-d";
+	}
+	argv[argc++] = ptsname(master);
+	argv[argc] = nullptr;
+	if ((child = fork()) == 0) {
+		// Quiet: rejected frames are expected, its exit status is checked
+		if ((null = open("/dev/null", O_WRONLY)) >= 0) {
+			dup2(null, STDOUT_FILENO);
+			dup2(null, STDERR_FILENO);
+		}
+		close(master);
+		execv(povsend, (char * const *) argv);
+		perror(povsend);
+		_exit(2);
+	}
+	if (child < 0) {
+		perror("fork");
+		return false;
+	}
+
+	// As SerialStream's setup() and loop()
+	PtyStream port(master);
+	TeensyPovStream stream(port);
+
+	port.corruptEvery = corruptEvery;
+	FastLED.addLeds<APA102, 11, 13, BGR>(leds, cfg.numLeds);
+	povSimSetLedClock(ledClock());
+	TeensyPOV::povSetup(hallPin, leds, cfg.numLeds);
+	povSimSetShowHook(recordShow);
+	povSimSetRotor(rotorSpeed);
+	pfd = { master, POLLIN, 0 };
+	while (!done) {
+		completed = stream.poll();
+		if (completed == POV_CMD_SWAP) {
+			// A corrupted frame must leave the previous one on display
+			if (swaps > 0) {
+				frame = swaps - 1;
+				if (std::find(port.corruptedFrames.begin(), port.corruptedFrames.end(), frame)
+						== port.corruptedFrames.end()) {
+					expected = frames.data() + (size_t) frame * cfg.frameWords();
+				}
+			}
+			ok = check(expected, palette, swaps) && ok;
+			swaps++;
+		} else if (completed == 0) {
+			if (port.available() == 0) {
+				// Bytes written reach the master side a little later, so povsend having exited
+				// isn't the end until nothing more arrives
+				if (!exited && waitpid(child, &status, WNOHANG) == child) {
+					exited = true;
+				}
+				done = poll(&pfd, 1, exited ? drainMs : idleMs) == 0 && exited;
+			}
+			delay(1);
+		}
+	}
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		printf("  povsend exited with status %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+		ok = false;
+	}
+	if (swaps != numFrames + 1 || stream.getErrors() != port.corruptedFrames.size()) {
+		ok = false;
+	}
+	printf("%-8s %u frames, %u swapped, %u corrupted, %u stream errors: %s\n", name, numFrames,
+			swaps > 0 ? swaps - 1 : 0, (uint32_t) port.corruptedFrames.size(), stream.getErrors(),
+			ok ? "ok" : "FAILED");
+	close(slave);
+	close(master);
+	unlink(framePath);
+	unlink(palettePath);
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	static const struct {
+		const char *name;
+		bool delta;
+		uint32_t corruptEvery;
+	} scenarios[] = { { "full", false, 3 }, { "delta", true, 0 } };
+	bool ok = true;
+	pid_t child;
+	int opt, status;
+
+	while ((opt = getopt(argc, argv, "x:s:b:l:n:")) != -1) {
+		switch (opt) {
+		case 'x': povsend = optarg; break;
+		case 's': cfg.logNumSegments = atoi(optarg); break;
+		case 'b': cfg.numColorBits = atoi(optarg); break;
+		case 'l': cfg.numLeds = atoi(optarg); break;
+		case 'n': numFrames = atoi(optarg); break;
+		default:
+			fprintf(stderr, "usage: %s [-x povsend] [-s log] [-b bits] [-l leds] [-n frames]\n",
+					argv[0]);
+			return 2;
+		}
+	}
+	if (cfg.logNumSegments < 1 || cfg.logNumSegments > TeensyPOV::maxLogNumSegments
+			|| (cfg.numColorBits != 1 && cfg.numColorBits != 2 && cfg.numColorBits != 4
+					&& cfg.numColorBits != 8) || cfg.numLeds == 0 || cfg.numLeds > POV_MAX_LEDS
+			|| cfg.columns() > povMaxColumns || numFrames == 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 2;
+	}
+	if (access(povsend, X_OK)) {
+		perror(povsend);
+		return 2;
+	}
+	fflush(stdout);
+	for (const auto &scenario : scenarios) {
+		// Corrupting a frame only drops it if the frame is a single message
+		uint32_t corruptEvery = (cfg.frameWords() * 4 + povSegmentsHeaderLength <= povMaxPayload) ?
+				scenario.corruptEvery : 0;
+
+		if ((child = fork()) == 0) {
+			status = run(scenario.name, scenario.delta, corruptEvery) ? 0 : 1;
+			fflush(stdout);
+			_exit(status);
+		}
+		if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status)
+				|| WEXITSTATUS(status) != 0) {
+			ok = false;
+		}
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+/*
+ * povpack.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Builds a content pack (TeensyPovPack.h) for TeensyPovContent from raw frame files, as written by
+ * povvideo -o (segments x words per segment little endian 32-bit words per frame), and palette files.
+ * Copying the pack to the SD card deploys it. Each -f adds an entry with the entry options given so
+ * far. Frames are laid out on payload alignment boundaries, optionally run length coded where that is
+ * smaller, and identical payloads are stored once. The written pack is checked before povpack exits.
+ * With -c, checks and lists an existing pack instead: directory checksum, every entry's geometry, every
+ * palette, frame table and payload in the file and aligned, payload checksums, and that every run length
+ * coded frame decodes to exactly one frame.
+ *
+ * Build:  g++ -O2 -std=c++11 -o povpack povpack.cpp
+ * Usage:  povpack [options] -f FRAMES [[options] -f FRAMES ...] pack.pov
+ *         povpack -c pack.pov
+ * Entry options, for every -f after them:
+ * 	-s LOG      Log2 of the number of segments (default 7)
+ * 	-b BITS     Color bits: 1, 2, 4 or 8 (default 2)
+ * 	-l LEDS     Number of LEDs (default 36)
+ * 	-t TDC      Top Dead Center segment (default 0)
+ * 	-p FILE     Palette, one RRGGBB hex value per line (default as povsend)
+ * 	-i MS       Milliseconds between frames (default 100, 0 shows only the first frame)
+ * 	-d MS       Milliseconds before the next entry (default 0: animations once, stills until told)
+ * 	-n COUNT    Frames to take from the next file (default all)
+ * Pack options:
+ * 	-a LOG      Log2 of the payload alignment (default 9, the SD card sector)
+ * 	-z          Run length code frames where that is smaller
+ * Exit status: 0, 1 if the pack checked is invalid, 2 on other errors.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include "PovHost.h"
+#include "PovPackFile.h"
+
+static const uint8_t maxLogAlignment = 16;
+
+struct PackEntry {
+	PovPackEntry entry = PovPackEntry();
+	std::vector<uint32_t> palette;
+	std::vector<uint32_t> words;			// Every frame, one after the other
+};
+
+static void putWord(std::vector<uint8_t> &out, uint32_t word) {
+	uint8_t bytes[4];
+
+	povPackPut(bytes, word, 4);
+	out.insert(out.end(), bytes, bytes + 4);
+}
+
+static void putLiteral(std::vector<uint8_t> &out, const uint32_t *words, uint32_t first, uint32_t end) {
+	uint32_t k;
+
+	if (end > first) {
+		putWord(out, end - first - 1);
+		for (k = first; k < end; k++) {
+			putWord(out, words[k]);
+		}
+	}
+}
+
+static void encodeRle(const uint32_t *words, uint32_t n, std::vector<uint8_t> &out) {
+	// Runs of 3 or more become a repeat, everything in between goes in literal runs
+	uint32_t index = 0, literal = 0, run;
+
+	while (index < n) {
+		for (run = 1; index + run < n && words[index + run] == words[index]; run++) {
+		}
+		if (run >= 3) {
+			putLiteral(out, words, literal, index);
+			putWord(out, povPackRunFlag | (run - 1));
+			putWord(out, words[index]);
+			literal = index + run;
+		}
+		index += run;
+	}
+	putLiteral(out, words, literal, n);
+}
+
+static uint16_t checksum(const uint8_t *data, uint32_t len) {
+	PovChecksum sum;
+
+	sum.add(data, len);
+	return sum.value();
+}
+
+static bool readFrames(const char *path, const PovConfig &cfg, uint32_t count, PackEntry &pack) {
+	FILE *f = fopen(path, "rb");
+	std::vector<uint8_t> frame(cfg.frameWords() * 4);
+	uint32_t frames = 0, k;
+
+	if (!f) {
+		perror(path);
+		return false;
+	}
+	while ((count == 0 || frames < count) && fread(frame.data(), 1, frame.size(), f) == frame.size()) {
+		for (k = 0; k < cfg.frameWords(); k++) {
+			pack.words.push_back(povPackGet(&frame[4 * k], 4));
+		}
+		frames++;
+	}
+	fclose(f);
+	if (frames == 0 || frames > 65535) {
+		fprintf(stderr, "%s: %u frames of %u bytes\n", path, frames, (uint32_t) frame.size());
+		return false;
+	}
+	pack.entry.numFrames = frames;
+	return true;
+}
+
+static bool writePack(const char *path, std::vector<PackEntry> &entries, uint8_t logAlignment,
+		bool compress) {
+	// Header, directory, palettes, frame tables, then the payloads on alignment boundaries
+	std::vector<uint8_t> out(povPackHeaderLength), payload;
+	std::map<std::vector<uint8_t>, PovPackFrame> stored;
+	PovPackHeader header;
+	uint32_t alignment = 1UL << logAlignment, frameWords, index, frame;
+	FILE *f;
+
+	header.numEntries = entries.size();
+	header.directoryOffset = povPackHeaderLength;
+	header.logAlignment = logAlignment;
+	out.resize(povPackHeaderLength + entries.size() * povPackEntryLength);
+	for (PackEntry &e : entries) {
+		e.entry.paletteOffset = out.size();
+		for (uint32_t color : e.palette) {
+			putWord(out, color);
+		}
+	}
+	for (PackEntry &e : entries) {
+		e.entry.frameTableOffset = out.size();
+		out.resize(out.size() + e.entry.numFrames * povPackFrameLength);
+	}
+
+	for (PackEntry &e : entries) {
+		frameWords = e.entry.frameBytes() / 4;
+		for (frame = 0; frame < e.entry.numFrames; frame++) {
+			const uint32_t *words = &e.words[frame * frameWords];
+			PovPackFrame info = { 0, 0, 0, 0 };
+
+			payload.clear();
+			for (index = 0; index < frameWords; index++) {
+				putWord(payload, words[index]);
+			}
+			if (compress) {
+				std::vector<uint8_t> coded;
+
+				encodeRle(words, frameWords, coded);
+				if (coded.size() < payload.size()) {
+					payload.swap(coded);
+					info.flags = POV_PACK_RLE;
+				}
+			}
+			auto found = stored.find(payload);
+			if (found != stored.end()) {
+				info = found->second;
+			} else {
+				out.resize((out.size() + alignment - 1) & ~(alignment - 1), 0);
+				info.offset = out.size();
+				info.length = payload.size();
+				info.checksum = checksum(payload.data(), payload.size());
+				out.insert(out.end(), payload.begin(), payload.end());
+				stored[payload] = info;
+			}
+			povPackFormatFrame(&out[e.entry.frameTableOffset + frame * povPackFrameLength], &info);
+		}
+	}
+
+	for (index = 0; index < entries.size(); index++) {
+		povPackFormatEntry(&out[povPackHeaderLength + index * povPackEntryLength], &entries[index].entry);
+	}
+	header.directoryChecksum = checksum(&out[povPackHeaderLength], entries.size() * povPackEntryLength);
+	header.fileSize = out.size();
+	povPackFormatHeader(out.data(), &header);
+
+	if (!(f = fopen(path, "wb"))) {
+		perror(path);
+		return false;
+	}
+	if (fwrite(out.data(), 1, out.size(), f) != out.size() || fclose(f)) {
+		fprintf(stderr, "error writing %s\n", path);
+		return false;
+	}
+	return true;
+}
+
+static bool checkEntry(const PovPackFile &pack, uint16_t index, bool list) {
+	PovPackEntry entry = PovPackEntry();
+	PovPackFrame frame = { 0, 0, 0, 0 };
+	std::vector<uint32_t> words;
+	std::string problem;
+	uint32_t numFrame, stored = 0, coded = 0;
+	char text[128];
+
+	pack.entry(index, &entry);
+	if (entry.logNumSegments < 1 || entry.logNumSegments > 9
+			|| (entry.numColorBits != 1 && entry.numColorBits != 2 && entry.numColorBits != 4
+					&& entry.numColorBits != 8) || entry.numLeds == 0
+			|| entry.wordsPerSegment != (entry.numLeds * entry.numColorBits + 31) / 32
+			|| entry.tdcSegment >= (1U << entry.logNumSegments)) {
+		problem = "bad geometry";
+	} else if (entry.numFrames == 0) {
+		problem = "no frames";
+	} else if (entry.flags != 0) {
+		problem = "unknown flags";
+	} else if (entry.numPaletteEntries == 0 || entry.numPaletteEntries > 256 || !pack.palette(entry)) {
+		problem = "bad palette";
+	}
+	for (numFrame = 0; problem.empty() && numFrame < entry.numFrames; numFrame++) {
+		snprintf(text, sizeof(text), "frame %u: ", numFrame);
+		if (!pack.frame(entry, numFrame, &frame)) {
+			problem = std::string(text) + "frame table out of the file";
+		} else if (!pack.payload(frame)) {
+			problem = std::string(text) + "payload out of the file";
+		} else if (frame.offset & ((1UL << pack.header.logAlignment) - 1)) {
+			problem = std::string(text) + "payload not aligned";
+		} else if (frame.flags & ~POV_PACK_RLE) {
+			problem = std::string(text) + "unknown flags";
+		} else if (checksum(pack.payload(frame), frame.length) != frame.checksum) {
+			problem = std::string(text) + "checksum error";
+		} else if (!pack.decodeFrame(entry, frame, words)) {
+			problem = std::string(text) + ((frame.flags & POV_PACK_RLE) ?
+					"doesn't decode to one frame" : "wrong length");
+		}
+		stored += frame.length;
+		coded += (frame.flags & POV_PACK_RLE) ? 1 : 0;
+	}
+
+	if (list || !problem.empty()) {
+		printf("%3u: %4u segments x %3u LEDs, %u bits, %5u frames", index, 1U << entry.logNumSegments,
+				entry.numLeds, entry.numColorBits, entry.numFrames);
+		if (entry.frameInterval > 0 && entry.numFrames > 1) {
+			printf(" every %u ms", entry.frameInterval);
+		}
+		if (entry.duration > 0) {
+			printf(", %u ms", entry.duration);
+		}
+		if (problem.empty()) {
+			printf(", %u KB (%u run length coded)\n", (stored + 1023) / 1024, coded);
+		} else {
+			printf(": %s\n", problem.c_str());
+		}
+	}
+	return problem.empty();
+}
+
+static int checkPack(const char *path, bool list) {
+	PovPackFile pack;
+	const uint8_t *directory;
+	uint32_t bad = 0;
+	uint16_t index;
+
+	if (!pack.open(path)) {
+		fprintf(stderr, "%s: not a version %u content pack, or cut short\n", path, povPackVersion);
+		return 1;
+	}
+	directory = pack.directory();
+	if (pack.header.logAlignment < 2 || pack.header.logAlignment > maxLogAlignment || !directory
+			|| checksum(directory, pack.header.numEntries * povPackEntryLength)
+					!= pack.header.directoryChecksum) {
+		fprintf(stderr, "%s: corrupt header or directory\n", path);
+		return 1;
+	}
+	for (index = 0; index < pack.header.numEntries; index++) {
+		bad += checkEntry(pack, index, list) ? 0 : 1;
+	}
+	printf("%s: %u entries, %u bytes, %s\n", path, pack.header.numEntries, (uint32_t) pack.size(),
+			bad ? "INVALID" : "ok");
+	return bad ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+	std::vector<PackEntry> entries;
+	PackEntry pack;
+	PovConfig cfg = { 7, 2, 0, 36 };
+	uint32_t colors[256], numColors, count = 0;
+	const char *paletteFile = nullptr;
+	uint16_t interval = 100;
+	uint32_t duration = 0;
+	uint8_t logAlignment = povPackDefaultAlignment;
+	bool compress = false, check = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "+s:b:l:t:p:i:d:n:f:a:zc")) != -1) {
+		switch (opt) {
+		case 's': cfg.logNumSegments = atoi(optarg); break;
+		case 'b': cfg.numColorBits = atoi(optarg); break;
+		case 'l': cfg.numLeds = atoi(optarg); break;
+		case 't': cfg.tdcSegment = atoi(optarg); break;
+		case 'p': paletteFile = optarg; break;
+		case 'i': interval = atoi(optarg); break;
+		case 'd': duration = atoi(optarg); break;
+		case 'n': count = atoi(optarg); break;
+		case 'a': logAlignment = atoi(optarg); break;
+		case 'z': compress = true; break;
+		case 'c': check = true; break;
+		case 'f':
+			if (cfg.numLeds == 0 || cfg.numLeds > 255 || cfg.logNumSegments < 1 || cfg.logNumSegments > 9
+					|| (cfg.numColorBits != 1 && cfg.numColorBits != 2 && cfg.numColorBits != 4
+							&& cfg.numColorBits != 8) || cfg.tdcSegment >= cfg.numSegments()) {
+				fprintf(stderr, "bad entry options for %s\n", optarg);
+				return 2;
+			}
+			numColors = povDefaultPalette(cfg.numColorBits, colors);
+			if (paletteFile && !povReadPalette(paletteFile, colors, &numColors)) {
+				fprintf(stderr, "can't read palette %s\n", paletteFile);
+				return 2;
+			}
+			pack = PackEntry();
+			pack.entry = { cfg.logNumSegments, cfg.numColorBits, (uint8_t) cfg.numLeds,
+					(uint8_t) cfg.columns(), cfg.tdcSegment, (uint16_t) numColors, 0, interval,
+					duration, 0, 0, 0 };
+			pack.palette.assign(colors, colors + numColors);
+			if (!readFrames(optarg, cfg, count, pack)) {
+				return 2;
+			}
+			entries.push_back(pack);
+			count = 0;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-s log segments] [-b bits] [-l leds] [-t tdc] [-p palette] "
+					"[-i ms] [-d ms] [-n frames] -f frames [...] [-a log alignment] [-z] pack.pov\n"
+					"       %s -c pack.pov\n", argv[0], argv[0]);
+			return 2;
+		}
+	}
+	if (optind + 1 != argc || (!check && entries.empty()) || (check && !entries.empty())
+			|| logAlignment < 2 || logAlignment > maxLogAlignment) {
+		fprintf(stderr, "bad arguments\n");
+		return 2;
+	}
+	if (check) {
+		return checkPack(argv[optind], true);
+	}
+	if (!writePack(argv[optind], entries, logAlignment, compress)) {
+		return 2;
+	}
+	return checkPack(argv[optind], true) ? 2 : 0;
+}
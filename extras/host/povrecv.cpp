@@ -0,0 +1,214 @@
+/*
+ * povrecv.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Stand-in for a Teensy running examples/SerialStream, for testing senders without hardware.
+ * Opens a pseudo terminal, prints its name, then checks and ACKs TeensyPovProtocol messages the way
+ * TeensyPovStream does, keeping the received segments in a frame buffer. Prints link statistics
+ * once a second.
+ *
+ * Build:  g++ -O2 -std=c++11 -o povrecv povrecv.cpp
+ * Usage:  povrecv [-o FILE] [-q]
+ * 	-o FILE   Write the frame buffer at every swap (povsend -f format, for comparing with povvideo -o)
+ * 	-q        Only print the totals when the sender closes the port
+ *
+ * Example:
+ * 	./povrecv &           (prints e.g. /dev/pts/5)
+ * 	./povvideo clip.mp4 /dev/pts/5
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "PovHost.h"
+
+static const uint32_t maxMessage = povHeaderLength + povMaxPayload + povChecksumLength;
+
+struct Receiver {
+	PovConfig cfg = { 0, 0, 0, 0 };
+	std::vector<uint32_t> frame;
+	uint32_t messages = 0, errors = 0, swaps = 0, segments = 0, bytes = 0;
+	FILE *raw = nullptr;
+	int fd;
+
+	void ack(uint8_t command, uint8_t status) {
+		std::vector<uint8_t> out;
+		uint8_t payload[povAckLength] = { command, status };
+
+		povEncodeMessage(out, POV_CMD_ACK, payload, sizeof(payload));
+		povWriteAll(fd, out.data(), out.size());
+	}
+
+	uint8_t apply(uint8_t type, const uint8_t *payload, uint16_t length) {
+		uint32_t first, count, columns, i;
+
+		switch (type) {
+		case POV_CMD_CONFIG:
+			if (length != povConfigLength || payload[0] < 1 || payload[0] > povMaxLogNumSegments
+					|| (payload[1] != 1 && payload[1] != 2 && payload[1] != 4
+							&& payload[1] != 8)) {
+				return POV_STATUS_RANGE;
+			}
+			cfg.logNumSegments = payload[0];
+			cfg.numColorBits = payload[1];
+			cfg.tdcSegment = payload[2] | (payload[3] << 8);
+			frame.assign(cfg.numSegments() * povMaxColumns, 0);
+			return POV_STATUS_OK;
+
+		case POV_CMD_PALETTE:
+			if (length < 1 || ((length - 1) & 3)
+					|| payload[0] + (length - 1) / 4 > 256) {
+				return POV_STATUS_RANGE;
+			}
+			return POV_STATUS_OK;
+
+		case POV_CMD_FRAME:
+		case POV_CMD_SEGMENTS:
+			if (length < povSegmentsHeaderLength || frame.empty()) {
+				return POV_STATUS_RANGE;
+			}
+			first = payload[0] | (payload[1] << 8);
+			count = payload[2] | (payload[3] << 8);
+			columns = payload[4];
+			if (first + count > cfg.numSegments() || columns > povMaxColumns
+					|| (uint32_t) (length - povSegmentsHeaderLength) != count * columns * 4
+					|| (type == POV_CMD_FRAME
+							&& (first != 0 || count != cfg.numSegments()))) {
+				return POV_STATUS_RANGE;
+			}
+			cfg.numLeds = columns * 32 / cfg.numColorBits;	// Only the packing matters here
+			for (i = 0; i < count * columns; i++) {
+				memcpy(&frame[(first + i / columns) * povMaxColumns + i % columns],
+						payload + povSegmentsHeaderLength + i * 4, 4);
+			}
+			segments += count;
+			return POV_STATUS_OK;
+
+		case POV_CMD_SWAP:
+			swaps++;
+			if (raw && !frame.empty()) {
+				for (i = 0; i < cfg.numSegments(); i++) {
+					fwrite(&frame[i * povMaxColumns], 4, cfg.columns(), raw);
+				}
+			}
+			return POV_STATUS_OK;
+
+		default:
+			return POV_STATUS_UNKNOWN;
+		}
+	}
+};
+
+int main(int argc, char **argv) {
+	Receiver rx;
+	std::vector<uint8_t> buffer;
+	uint8_t chunk[4096];
+	uint32_t lastMessages = 0, lastBytes = 0, lastSwaps = 0;
+	uint16_t length, expected;
+	bool quiet = false;
+	time_t lastReport = time(nullptr);
+	struct termios tio;
+	struct pollfd pfd;
+	PovChecksum sum;
+	size_t used;
+	ssize_t n;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:q")) != -1) {
+		switch (opt) {
+		case 'o':
+			if (!(rx.raw = fopen(optarg, "wb"))) {
+				perror(optarg);
+				return 1;
+			}
+			break;
+		case 'q': quiet = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-o raw] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	rx.fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (rx.fd < 0 || grantpt(rx.fd) || unlockpt(rx.fd)) {
+		perror("pty");
+		return 1;
+	}
+	tcgetattr(rx.fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(rx.fd, TCSANOW, &tio);
+	printf("%s\n", ptsname(rx.fd));
+	fflush(stdout);
+
+	pfd.fd = rx.fd;
+	pfd.events = POLLIN;
+	for (;;) {
+		if (poll(&pfd, 1, 1000) > 0) {
+			n = read(rx.fd, chunk, sizeof(chunk));
+			if (n <= 0) {
+				if (n < 0 && errno == EIO && rx.messages == 0) {
+					usleep(100000);			// No sender has opened the port yet
+					continue;
+				}
+				if (n < 0 && errno != EIO) {
+					perror("read");
+				}
+				break;					// Sender closed the port
+			}
+			rx.bytes += n;
+			buffer.insert(buffer.end(), chunk, chunk + n);
+		}
+
+		// Parse every complete message in the buffer
+		used = 0;
+		while (buffer.size() - used >= povHeaderLength) {
+			if (buffer[used] != POV_SYNC_1 || buffer[used + 1] != POV_SYNC_2) {
+				used++;
+				continue;
+			}
+			length = buffer[used + 3] | (buffer[used + 4] << 8);
+			if (buffer.size() - used < (size_t) povHeaderLength + length
+					+ povChecksumLength) {
+				break;
+			}
+			sum = PovChecksum();
+			sum.add(&buffer[used + 2], length + 3);
+			expected = buffer[used + povHeaderLength + length]
+					| (buffer[used + povHeaderLength + length + 1] << 8);
+			rx.messages++;
+			if (expected != sum.value()) {
+				rx.errors++;
+				rx.ack(buffer[used + 2], POV_STATUS_CHECKSUM);
+			} else {
+				uint8_t status = rx.apply(buffer[used + 2],
+						&buffer[used + povHeaderLength], length);
+				rx.errors += (status != POV_STATUS_OK);
+				rx.ack(buffer[used + 2], status);
+			}
+			used += povHeaderLength + length + povChecksumLength;
+		}
+		buffer.erase(buffer.begin(), buffer.begin() + used);
+		if (buffer.size() > maxMessage) {
+			buffer.clear();
+		}
+
+		if (!quiet && time(nullptr) != lastReport) {
+			lastReport = time(nullptr);
+			printf("%u msg/s  %u swaps/s  %u bytes/s  errors %u\n",
+					rx.messages - lastMessages, rx.swaps - lastSwaps,
+					rx.bytes - lastBytes, rx.errors);
+			fflush(stdout);
+			lastMessages = rx.messages;
+			lastSwaps = rx.swaps;
+			lastBytes = rx.bytes;
+		}
+	}
+
+	printf("%u messages, %u swaps, %u segments, %u bytes, %u errors\n",
+			rx.messages, rx.swaps, rx.segments, rx.bytes, rx.errors);
+	if (rx.raw) {
+		fclose(rx.raw);
+	}
+	return 0;
+}
@@ -0,0 +1,360 @@
+/*
+ * povrender.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Renders an LED trace from povsim (PovTrace.h) as the eye would see it: each LED's color is integrated
+ * over the angle it swept while showing it, averaged over whole revolutions, and the polar result drawn
+ * as a PNG. Blanking between segments, the segment period, TDC timing and speed changes all show, so
+ * with a golden image from a known good build it makes a pixel exact regression test of what reaches
+ * the LEDs (strings, patterns, timing).
+ *
+ * The integration is exact integer arithmetic over the trace's positions; only mapping the polar result
+ * to pixels uses floating point.
+ *
+ * Build:  g++ -O2 -std=c++11 -o povrender povrender.cpp
+ * Usage:  povrender [options] trace.povt image.png
+ * 	-s SIZE     Image width and height in pixels (default 512)
+ * 	-i HUB      Radius inside the innermost LED, in LED pitches (default 4)
+ * 	-a DEGREES  Position of the Hall sensor, clockwise from 12 o'clock (default 0)
+ * 	-r          Rotor turns counterclockwise as seen (default clockwise)
+ * 	-k REVS     Revolutions to skip at the start of the trace (default 0)
+ * 	-n REVS     Revolutions to integrate (default all whole ones left)
+ * 	-g GAIN     Brightness gain; the LEDs are dark between segments, so the average is dim (default 1)
+ * 	-c GOLDEN   Compare with a PNG written by an earlier povrender run
+ * 	-e TOL      Largest difference in any color for a pixel to still match (default 0)
+ * 	-d FILE     With -c, write the differing pixels in red over the golden image, dimmed
+ * Exit status: 0, or 1 if the image doesn't match the golden one, 2 on other errors.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "PovTrace.h"
+
+static const uint32_t logAngleBins = 12;			// Angular resolution of the integration
+static const uint32_t angleBins = 1UL << logAngleBins;
+static const uint32_t binShift = 32 - logAngleBins;	// Position units per bin, as a shift
+static const int supersample = 4;					// Per pixel, each way
+
+static uint32_t crcTable[256];
+
+static void makeCrcTable(void) {
+	uint32_t n, k, c;
+
+	for (n = 0; n < 256; n++) {
+		c = n;
+		for (k = 0; k < 8; k++) {
+			c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+		}
+		crcTable[n] = c;
+	}
+}
+
+static uint32_t crc32(const uint8_t *data, size_t length) {
+	uint32_t c = 0xFFFFFFFFUL;
+
+	while (length--) {
+		c = crcTable[(c ^ *data++) & 0xFF] ^ (c >> 8);
+	}
+	return c ^ 0xFFFFFFFFUL;
+}
+
+static void putBig(std::vector<uint8_t> &out, uint32_t value) {
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		out.push_back(value >> shift);
+	}
+}
+
+static uint32_t getBig(const uint8_t *in) {
+	return ((uint32_t) in[0] << 24) | ((uint32_t) in[1] << 16) | ((uint32_t) in[2] << 8) | in[3];
+}
+
+static void putChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+	size_t start;
+
+	putBig(png, data.size());
+	start = png.size();
+	png.insert(png.end(), type, type + 4);
+	png.insert(png.end(), data.begin(), data.end());
+	putBig(png, crc32(&png[start], png.size() - start));
+}
+
+static bool writePng(const char *path, uint32_t width, uint32_t height,
+		const std::vector<uint8_t> &rgb) {
+	// 8 bit RGB, no filtering, zlib stream of stored (uncompressed) blocks: simple and exact
+	std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<uint8_t> header, raw, zlib = { 0x78, 0x01 };
+	uint32_t row, a = 1, b = 0;
+	size_t offset, length, i;
+	FILE *f;
+
+	putBig(header, width);
+	putBig(header, height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+	putChunk(png, "IHDR", header);
+
+	for (row = 0; row < height; row++) {
+		raw.push_back(0);
+		raw.insert(raw.end(), rgb.begin() + row * width * 3, rgb.begin() + (row + 1) * width * 3);
+	}
+	for (offset = 0; offset < raw.size(); offset += length) {
+		length = raw.size() - offset;
+		if (length > 0xFFFF) {
+			length = 0xFFFF;
+		}
+		zlib.push_back(offset + length == raw.size());
+		zlib.insert(zlib.end(), { (uint8_t) length, (uint8_t) (length >> 8),
+				(uint8_t) ~length, (uint8_t) (~length >> 8) });
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+	}
+	for (i = 0; i < raw.size(); i++) {
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	putBig(zlib, (b << 16) | a);
+	putChunk(png, "IDAT", zlib);
+	putChunk(png, "IEND", std::vector<uint8_t>());
+
+	if (!(f = fopen(path, "wb"))) {
+		return false;
+	}
+	length = fwrite(png.data(), 1, png.size(), f);
+	return !fclose(f) && length == png.size();
+}
+
+static bool readPng(const char *path, uint32_t *width, uint32_t *height, std::vector<uint8_t> &rgb) {
+	// Only what writePng() writes: 8 bit RGB, stored blocks, no filtering
+	std::vector<uint8_t> file, zlib, raw;
+	uint32_t length, row;
+	size_t offset, block;
+	bool last = false;
+	FILE *f = fopen(path, "rb");
+	int c;
+
+	if (!f) {
+		return false;
+	}
+	while ((c = fgetc(f)) != EOF) {
+		file.push_back(c);
+	}
+	fclose(f);
+	if (file.size() < 33 || memcmp(&file[1], "PNG", 3) || memcmp(&file[12], "IHDR", 4)
+			|| file[24] != 8 || file[25] != 2 || file[28] != 0) {
+		return false;
+	}
+	*width = getBig(&file[16]);
+	*height = getBig(&file[20]);
+	for (offset = 8; offset + 12 <= file.size(); offset += length + 12) {
+		length = getBig(&file[offset]);
+		if (offset + 12 + length > file.size()) {
+			return false;
+		}
+		if (!memcmp(&file[offset + 4], "IDAT", 4)) {
+			zlib.insert(zlib.end(), file.begin() + offset + 8, file.begin() + offset + 8 + length);
+		}
+	}
+	for (offset = 2; !last && offset + 5 <= zlib.size(); offset += 5 + block) {
+		if (zlib[offset] & 6) {
+			return false;		// Compressed block, not written by povrender
+		}
+		last = zlib[offset] & 1;
+		block = zlib[offset + 1] | (zlib[offset + 2] << 8);
+		if (offset + 5 + block > zlib.size()) {
+			return false;
+		}
+		raw.insert(raw.end(), zlib.begin() + offset + 5, zlib.begin() + offset + 5 + block);
+	}
+	if (raw.size() != (size_t) (*width * 3 + 1) * *height) {
+		return false;
+	}
+	rgb.clear();
+	for (row = 0; row < *height; row++) {
+		if (raw[row * (*width * 3 + 1)] != 0) {
+			return false;
+		}
+		rgb.insert(rgb.end(), raw.begin() + row * (*width * 3 + 1) + 1,
+				raw.begin() + (row + 1) * (*width * 3 + 1));
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	std::vector<PovTraceRecord> records;
+	std::vector<uint64_t> sums;				// [bin][led][color], color x position units
+	std::vector<float> polar;				// Average of each, 0 - 255
+	std::vector<uint8_t> image, golden, diff;
+	PovTraceRecord record;
+	uint32_t size = 512, hub = 4, skip = 0, revolutions = 0, tolerance = 0;
+	uint32_t x, y, sx, sy, bin, led, color, index, goldenWidth, goldenHeight;
+	uint32_t differing = 0, worst = 0, difference;
+	uint64_t first, last, from, to, start, stop, binEnd;
+	uint32_t tickRate;
+	uint16_t numLeds;
+	double hallAngle = 0, gain = 1, radius, pitch, dx, dy, angle, sum[3];
+	const char *goldenPath = nullptr, *diffPath = nullptr;
+	bool counterclockwise = false, lit;
+	size_t r;
+	FILE *f;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:i:a:rk:n:g:c:e:d:")) != -1) {
+		switch (opt) {
+		case 's': size = atoi(optarg); break;
+		case 'i': hub = atoi(optarg); break;
+		case 'a': hallAngle = atof(optarg); break;
+		case 'r': counterclockwise = true; break;
+		case 'k': skip = atoi(optarg); break;
+		case 'n': revolutions = atoi(optarg); break;
+		case 'g': gain = atof(optarg); break;
+		case 'c': goldenPath = optarg; break;
+		case 'e': tolerance = atoi(optarg); break;
+		case 'd': diffPath = optarg; break;
+		default:
+			fprintf(stderr, "usage: %s [-s size] [-i hub] [-a degrees] [-r] [-k skip] [-n revs] "
+					"[-g gain] [-c golden.png [-e tolerance] [-d diff.png]] trace.povt image.png\n",
+					argv[0]);
+			return 2;
+		}
+	}
+	if (argc - optind != 2 || size < 16 || size > 8192 || gain <= 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 2;
+	}
+	if (!(f = fopen(argv[optind], "rb")) || !povTraceReadHeader(f, &numLeds, &tickRate)) {
+		fprintf(stderr, "can't read trace %s\n", argv[optind]);
+		return 2;
+	}
+	while (povTraceRead(f, &record, numLeds)) {
+		if (!records.empty() && record.position < records.back().position) {
+			fprintf(stderr, "rotor position goes backwards\n");
+			return 2;
+		}
+		records.push_back(record);
+	}
+	fclose(f);
+	if (records.size() < 2) {
+		fprintf(stderr, "trace too short\n");
+		return 2;
+	}
+
+	// Whole revolutions, Hall edge to Hall edge, covered by the trace (the last record has no end)
+	first = ((records.front().position + 0xFFFFFFFFULL) >> 32) + skip;
+	last = records.back().position >> 32;
+	if (revolutions == 0 && last > first) {
+		revolutions = last - first;
+	}
+	if (revolutions == 0 || first + revolutions > last) {
+		fprintf(stderr, "trace has only %lld whole revolutions after skipping %u\n",
+				(long long) last - (long long) first + skip, skip);
+		return 2;
+	}
+	start = first << 32;
+	stop = (first + revolutions) << 32;
+
+	// Each record's colors light the angle swept until the next record
+	sums.assign((size_t) angleBins * numLeds * 3, 0);
+	for (r = 0; r + 1 < records.size(); r++) {
+		from = (records[r].position > start) ? records[r].position : start;
+		to = (records[r + 1].position < stop) ? records[r + 1].position : stop;
+		lit = false;
+		for (index = 0; index < 3u * numLeds; index++) {
+			lit |= records[r].rgb[index] != 0;
+		}
+		for (; lit && from < to; from = binEnd) {
+			binEnd = ((from >> binShift) + 1) << binShift;
+			if (binEnd > to) {
+				binEnd = to;
+			}
+			bin = (from >> binShift) & (angleBins - 1);
+			for (index = 0; index < 3u * numLeds; index++) {
+				sums[(size_t) bin * numLeds * 3 + index] += records[r].rgb[index] * (binEnd - from);
+			}
+		}
+	}
+	polar.resize(sums.size());
+	for (index = 0; index < sums.size(); index++) {
+		polar[index] = (double) sums[index] / ((double) revolutions * (1ULL << binShift));
+	}
+
+	// Polar to cartesian, LED 0 innermost, 12 o'clock up
+	pitch = (size / 2.0 - 1) / (hub + numLeds);
+	image.resize((size_t) size * size * 3);
+	for (y = 0; y < size; y++) {
+		for (x = 0; x < size; x++) {
+			sum[0] = sum[1] = sum[2] = 0;
+			for (sy = 0; sy < supersample; sy++) {
+				for (sx = 0; sx < supersample; sx++) {
+					dx = x + (sx + 0.5) / supersample - size / 2.0;
+					dy = y + (sy + 0.5) / supersample - size / 2.0;
+					radius = sqrt(dx * dx + dy * dy) / pitch - hub;
+					if (radius < 0 || radius >= numLeds) {
+						continue;
+					}
+					led = (uint32_t) radius;
+					angle = atan2(dx, -dy) / (2 * M_PI) - hallAngle / 360;	// Clockwise from the sensor
+					if (counterclockwise) {
+						angle = -angle;
+					}
+					angle -= floor(angle);
+					bin = (uint32_t) (angle * angleBins) & (angleBins - 1);
+					for (color = 0; color < 3; color++) {
+						sum[color] += polar[((size_t) bin * numLeds + led) * 3 + color];
+					}
+				}
+			}
+			for (color = 0; color < 3; color++) {
+				sum[color] = sum[color] * gain / (supersample * supersample) + 0.5;
+				image[((size_t) y * size + x) * 3 + color] = (sum[color] > 255) ? 255 : sum[color];
+			}
+		}
+	}
+
+	makeCrcTable();
+	if (!writePng(argv[optind + 1], size, size, image)) {
+		fprintf(stderr, "can't write %s\n", argv[optind + 1]);
+		return 2;
+	}
+	printf("%u LEDs, %u revolutions from %llu, %zu LED updates\n", numLeds, revolutions,
+			(unsigned long long) first, records.size());
+
+	if (!goldenPath) {
+		return 0;
+	}
+	if (!readPng(goldenPath, &goldenWidth, &goldenHeight, golden)) {
+		fprintf(stderr, "can't read %s (only PNGs written by povrender)\n", goldenPath);
+		return 2;
+	}
+	if (goldenWidth != size || goldenHeight != size) {
+		fprintf(stderr, "%s is %u x %u, not %u x %u\n", goldenPath, goldenWidth, goldenHeight,
+				size, size);
+		return 1;
+	}
+	diff.resize(image.size());
+	for (index = 0; index < image.size(); index += 3) {
+		difference = 0;
+		for (color = 0; color < 3; color++) {
+			difference = std::max(difference,
+					(uint32_t) abs((int) image[index + color] - golden[index + color]));
+			diff[index + color] = golden[index + color] / 4;
+		}
+		worst = std::max(worst, difference);
+		if (difference > tolerance) {
+			differing++;
+			diff[index] = 255;
+			diff[index + 1] = diff[index + 2] = 0;
+		}
+	}
+	if (diffPath && !writePng(diffPath, size, size, diff)) {
+		fprintf(stderr, "can't write %s\n", diffPath);
+		return 2;
+	}
+	printf("%u pixels differ from %s (largest difference %u)\n", differing, goldenPath, worst);
+	return differing ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * povsend.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Reference sender for TeensyPovProtocol. Streams frames to a Teensy running TeensyPovStream
+ * (see examples/SerialStream), pacing itself on the ACK of each swap.
+ *
+ * Build:  g++ -O2 -std=c++11 -o povsend povsend.cpp
+ * Usage:  povsend [options] <port>
+ * 	-s LOG    Log (base 2) of number of segments (default 7)
+ * 	-b BITS   Color bits: 1, 2, 4 or 8 (default 4)
+ * 	-l LEDS   Number of LEDs (default 36)
+ * 	-t TDC    Top Dead Center segment (default 0)
+ * 	-p FILE   Palette, one RRGGBB hex value per line (default: built-in)
+ * 	-f FILE   Raw frames, (segments x words per segment) little endian 32-bit words each, as
+ * 	          produced by povvideo -o. Default: rotating test pattern.
+ * 	-n COUNT  Number of test pattern frames (default 100)
+ * 	-r FPS    Frame rate (default 10)
+ * 	-d        After the first frame, only send segments that changed
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "PovHost.h"
+
+static const int ackTimeoutMs = 1000;
+
+static void testPattern(const PovConfig &cfg, uint32_t *frame, uint32_t n) {
+	// Spokes rotating against a ring that grows and shrinks
+	uint32_t numSegments = cfg.numSegments(), numColors = 1UL << cfg.numColorBits;
+	uint32_t spokeSpacing = (numSegments >= 16) ? numSegments / 8 : 2;
+	uint32_t segment, pixel, ring;
+
+	memset(frame, 0, cfg.frameWords() * 4);
+	ring = n % (2 * cfg.numLeds);
+	ring = (ring < cfg.numLeds) ? ring : 2 * cfg.numLeds - 1 - ring;
+	for (segment = 0; segment < numSegments; segment++) {
+		if (((segment + n) % spokeSpacing) < 2) {
+			for (pixel = 0; pixel < cfg.numLeds; pixel++) {
+				povPackPixel(cfg, frame, segment, pixel,
+						1 + (segment * 8 / numSegments) % (numColors - 1));
+			}
+		}
+		povPackPixel(cfg, frame, segment, ring, numColors - 1);
+	}
+}
+
+static bool transact(int fd, PovAckReader &acks, std::vector<uint8_t> &out,
+		uint8_t lastCommand) {
+	// Send, then wait for the ACK of the last message. Returns false on error / timeout.
+	uint8_t command, status;
+
+	if (!povWriteAll(fd, out.data(), out.size())) {
+		return false;
+	}
+	out.clear();
+	while (acks.wait(&command, &status, ackTimeoutMs)) {
+		if (status != POV_STATUS_OK) {
+			fprintf(stderr, "command 0x%02X rejected, status %u\n", command,
+					status);
+			return false;
+		}
+		if (command == lastCommand) {
+			return true;
+		}
+	}
+	fprintf(stderr, "timeout waiting for ACK\n");
+	return false;
+}
+
+int main(int argc, char **argv) {
+	PovConfig cfg = { 7, 4, 0, 36 };
+	const char *paletteFile = nullptr, *frameFile = nullptr;
+	uint32_t palette[256], numColors = 0, count = 100, fps = 10, frameNumber;
+	uint32_t segmentsSent = 0;
+	bool delta = false, haveFrame = false;
+	struct timespec next;
+	FILE *frames = nullptr;
+	int opt, fd;
+
+	while ((opt = getopt(argc, argv, "s:b:l:t:p:f:n:r:d")) != -1) {
+		switch (opt) {
+		case 's': cfg.logNumSegments = atoi(optarg); break;
+		case 'b': cfg.numColorBits = atoi(optarg); break;
+		case 'l': cfg.numLeds = atoi(optarg); break;
+		case 't': cfg.tdcSegment = atoi(optarg); break;
+		case 'p': paletteFile = optarg; break;
+		case 'f': frameFile = optarg; break;
+		case 'n': count = atoi(optarg); break;
+		case 'r': fps = atoi(optarg); break;
+		case 'd': delta = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-s log] [-b bits] [-l leds] [-t tdc] "
+					"[-p palette] [-f frames] [-n count] [-r fps] [-d] port\n",
+					argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc || cfg.logNumSegments < 1 || cfg.logNumSegments > povMaxLogNumSegments
+			|| (cfg.numColorBits != 1 && cfg.numColorBits != 2
+					&& cfg.numColorBits != 4 && cfg.numColorBits != 8)
+			|| cfg.columns() > povMaxColumns || fps == 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 1;
+	}
+
+	if (paletteFile) {
+		if (!povReadPalette(paletteFile, palette, &numColors)) {
+			fprintf(stderr, "can't read palette %s\n", paletteFile);
+			return 1;
+		}
+	} else {
+		numColors = povDefaultPalette(cfg.numColorBits, palette);
+	}
+	if (numColors > (1UL << cfg.numColorBits)) {
+		numColors = 1UL << cfg.numColorBits;
+	}
+	if (frameFile && !(frames = fopen(frameFile, "rb"))) {
+		fprintf(stderr, "can't open %s\n", frameFile);
+		return 1;
+	}
+
+	fd = povOpenPort(argv[optind]);
+	if (fd < 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+	PovAckReader acks(fd);
+	std::vector<uint8_t> out;
+	std::vector<uint32_t> frame(cfg.frameWords()), previous(cfg.frameWords());
+
+	povEncodeConfig(out, cfg);
+	povEncodePalette(out, 0, palette, numColors);
+	povEncodeSwap(out);
+	if (!transact(fd, acks, out, POV_CMD_SWAP)) {
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (frameNumber = 0; frames || frameNumber < count; frameNumber++) {
+		if (frames) {
+			if (fread(frame.data(), 4, frame.size(), frames) != frame.size()) {
+				break;
+			}
+		} else {
+			testPattern(cfg, frame.data(), frameNumber);
+		}
+
+		if (delta && haveFrame) {
+			segmentsSent += povEncodeDelta(out, cfg, frame.data(),
+					previous.data());
+		} else {
+			povEncodeSegments(out, cfg, frame.data(), 0, cfg.numSegments());
+			segmentsSent += cfg.numSegments();
+		}
+		povEncodeSwap(out);
+		if (!transact(fd, acks, out, POV_CMD_SWAP)) {
+			// Device may hold a partial frame, next one goes in full
+			haveFrame = false;
+			continue;
+		}
+		previous.swap(frame);
+		haveFrame = true;
+
+		next.tv_nsec += 1000000000L / fps;
+		while (next.tv_nsec >= 1000000000L) {
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+	}
+
+	printf("%u frames, %u segments sent\n", frameNumber, segmentsSent);
+	if (frames) {
+		fclose(frames);
+	}
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * povsim.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Runs the library on the host against simulated hardware (sim/PovSim.cpp): the PITs count with a
+ * simulated bus clock and a simulated rotor drives the Hall interrupt, at a steady or changing speed.
+ * Loads strings and / or a test pattern into a TeensyPovDisplay the way a sketch would, waits for
+ * rpmGood(), activates it, then writes every FastLED.show() for the given number of revolutions to an
+ * LED trace (PovTrace.h). povrender turns the trace into the image the eye would see. Or plays a content
+ * pack (TeensyPovPack.h) through TeensyPovContent, reading it from a simulated SD card.
+ *
+ * Build:  g++ -O2 -std=gnu++14 -Isim -I../.. -o povsim povsim.cpp sim/PovSim.cpp ../../[Tt]*.cpp
+ * 	Library options are given as usual, e.g. -DPOV_DOUBLE_BUFFER. POV_APA102_HDR, HALL_INPUT_CAPTURE
+ * 	and TeensyPovAudio's sampling use peripherals that aren't simulated.
+ * Usage:  povsim [options] trace.povt
+ * 	-l LEDS     Number of LEDs (default 36)
+ * 	-s LOG      Log2 of the number of segments (default 7)
+ * 	-b BITS     Color bits: 1, 2, 4 or 8 (default 2)
+ * 	-c SEGMENT  TDC segment (default 0)
+ * 	-t TEXT     String along the top, in the brightest color
+ * 	-u TEXT     String along the bottom
+ * 	-p          Test pattern under the strings: a ring every 8 LEDs, 8 spokes and a mark at TDC
+ * 	-f FILE     Palette, one RRGGBB hex value per line (default as povsend)
+ * 	-r RPS      Rotor speed in revolutions per second (default 20)
+ * 	-a ACCEL    Rotor acceleration in revolutions per second per second (default 0)
+ * 	-n REVS     Revolutions to record after the display is activated (default 4)
+ * 	-m MHZ      LED data clock (default 24)
+ * 	-o POLICY   Overrun policy: skip, compress or correct (default skip)
+ * 	-k PACK     Play a content pack instead of strings and pattern (the pack sets the display)
+ * 	-q KB/S     SD card read rate in kilobytes per second (default 0, reads take no time)
+ *
+ * Example (regression test of the text renderer):
+ * 	./povsim -t HELLO -u WORLD hello.povt && ./povrender -c hello-golden.png hello.povt hello.png
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "PovHost.h"
+#include "PovTrace.h"
+#include "sim/PovSim.h"
+#include "TeensyPovDisplay.h"
+#include "TeensyPovContent.h"
+
+static const uint8_t hallPin = 21;
+static const uint32_t spinUpLimit = 5000;			// ms
+static const uint32_t recordLimit = 60000;			// ms
+
+static FILE *trace;
+static uint32_t records = 0;
+static bool traceError = false;
+
+static void recordShow(uint64_t ticks, uint64_t position, const CRGB *leds, uint16_t numLeds) {
+	if (!povTraceWrite(trace, ticks, position, leds[0].raw, numLeds)) {
+		traceError = true;
+	}
+	records++;
+}
+
+static void makePattern(const PovConfig &cfg, std::vector<uint32_t> &frame) {
+	uint32_t segment, led, numSegments = cfg.numSegments();
+	uint32_t last = (1UL << cfg.numColorBits) - 1;
+
+	frame.assign(cfg.frameWords(), 0);
+	for (segment = 0; segment < numSegments; segment++) {
+		for (led = 0; led < cfg.numLeds; led++) {
+			if (segment == 0 && led + 4 >= cfg.numLeds) {
+				povPackPixel(cfg, frame.data(), segment, led, last);
+			} else if (numSegments >= 8 && segment % (numSegments / 8) == 0) {
+				povPackPixel(cfg, frame.data(), segment, led, (last > 1) ? 2 : 1);
+			} else if (led % 8 == 7) {
+				povPackPixel(cfg, frame.data(), segment, led, 1);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	static CRGB leds[255];
+	static uint32_t colors[256];
+	std::vector<uint32_t> frame;
+	PovConfig cfg = { 7, 2, 0, 36 };
+	DisplayStringSpec strings[2];
+	LedArrayStruct pattern;
+	PovTelemetry telemetry;
+	TeensyPovDisplay display;
+	TeensyPovContent content;
+	ContentStats contentStats;
+	const char *top = nullptr, *bottom = nullptr, *paletteFile = nullptr, *pack = nullptr;
+	double rps = 20, acceleration = 0;
+	uint32_t revolutions = 4, ledMhz = 24, sdRate = 0, numColors, numStrings = 0, start;
+	uint64_t lastEdge = UINT64_MAX;
+	uint8_t policy = TeensyPOV::OVERRUN_SKIP;
+	bool usePattern = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "l:s:b:c:t:u:pf:r:a:n:m:o:k:q:")) != -1) {
+		switch (opt) {
+		case 'l': cfg.numLeds = atoi(optarg); break;
+		case 's': cfg.logNumSegments = atoi(optarg); break;
+		case 'b': cfg.numColorBits = atoi(optarg); break;
+		case 'c': cfg.tdcSegment = atoi(optarg); break;
+		case 't': top = optarg; break;
+		case 'u': bottom = optarg; break;
+		case 'p': usePattern = true; break;
+		case 'f': paletteFile = optarg; break;
+		case 'r': rps = atof(optarg); break;
+		case 'a': acceleration = atof(optarg); break;
+		case 'n': revolutions = atoi(optarg); break;
+		case 'm': ledMhz = atoi(optarg); break;
+		case 'k': pack = optarg; break;
+		case 'q': sdRate = atoi(optarg) * 1000; break;
+		case 'o':
+			if (!strcmp(optarg, "compress")) {
+				policy = TeensyPOV::OVERRUN_COMPRESS;
+			} else if (!strcmp(optarg, "correct")) {
+				policy = TeensyPOV::OVERRUN_CORRECT;
+			} else if (strcmp(optarg, "skip")) {
+				fprintf(stderr, "unknown policy %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-l leds] [-s log segments] [-b bits] [-c tdc] [-t top] "
+					"[-u bottom] [-p] [-f palette] [-r rps] [-a accel] [-n revs] [-m mhz] "
+					"[-o policy] [-k pack] [-q kb/s] trace.povt\n", argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc || cfg.numLeds == 0 || cfg.numLeds > 255 || cfg.logNumSegments < 1
+			|| cfg.logNumSegments > TeensyPOV::maxLogNumSegments
+			|| (cfg.numColorBits != 1 && cfg.numColorBits != 2 && cfg.numColorBits != 4
+					&& cfg.numColorBits != 8) || cfg.tdcSegment >= cfg.numSegments()
+			|| ledMhz == 0 || rps <= 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 1;
+	}
+	numColors = povDefaultPalette(cfg.numColorBits, colors);
+	if (paletteFile && !povReadPalette(paletteFile, colors, &numColors)) {
+		fprintf(stderr, "can't read palette %s\n", paletteFile);
+		return 1;
+	}
+	if (!(trace = fopen(argv[optind], "wb"))) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	// As a sketch's setup()
+	FastLED.addLeds<APA102, 11, 13, BGR>(leds, cfg.numLeds);
+	povSimSetLedClock(DATA_RATE_MHZ(ledMhz));
+	TeensyPOV::povSetup(hallPin, leds, cfg.numLeds);
+	TeensyPOV::setOverrunPolicy(policy);
+	povSimSetSdRate(sdRate);
+	if (pack && !(SD.begin(BUILTIN_SDCARD) && content.begin(pack))) {
+		fprintf(stderr, "can't read content pack %s\n", pack);
+		return 1;
+	}
+
+	if (top) {
+		strings[numStrings++] = { top, TOP, (uint8_t) (cfg.numLeds - 1),
+				(uint8_t) (numColors - 1), 0, false };
+	}
+	if (bottom) {
+		strings[numStrings++] = { bottom, BOTTOM, (uint8_t) (cfg.numLeds - 1),
+				(uint8_t) ((numColors > 2) ? numColors - 2 : 1), 0, true };
+	}
+	if (usePattern) {
+		makePattern(cfg, frame);
+		pattern = { frame.data(), colors, cfg.numColorBits, cfg.logNumSegments, cfg.columns(),
+				cfg.tdcSegment };
+		display.load(&pattern, strings, numStrings);
+	} else {
+		display.load(strings, numStrings);
+	}
+	display.setDisplay(cfg.logNumSegments, cfg.numColorBits, cfg.tdcSegment, colors);
+
+	povSimSetRotor(rps, acceleration);
+	start = millis();
+	while (!TeensyPOV::rpmGood()) {
+		if (millis() - start > spinUpLimit) {
+			fprintf(stderr, "rotor never reached a good speed\n");
+			return 1;
+		}
+		delay(1);
+	}
+	if (pack) {
+		if (!content.play()) {
+			fprintf(stderr, "nothing playable in %s\n", pack);
+			return 1;
+		}
+		content.update();
+	} else {
+		display.activate();
+	}
+
+	// As loop(). Activating restarts the speed check, so the LEDs come on a couple of revolutions later;
+	// record from then until the given number of whole revolutions has passed.
+	povTraceWriteHeader(trace, cfg.numLeds, F_BUS);
+	start = millis();
+	while (povSimHallEdges() < lastEdge) {
+		if (millis() - start > recordLimit) {
+			fprintf(stderr, "rotor stopped, trace cut short\n");
+			break;
+		}
+		if (lastEdge == UINT64_MAX && TeensyPOV::rpmGood()) {
+			// Starting with what the LEDs show now (the last show()), the trace covers every angle
+			recordShow(povSimTicks(), povSimPosition(), leds, cfg.numLeds);
+			povSimSetShowHook(recordShow);
+			lastEdge = povSimHallEdges() + revolutions + 1;
+		}
+		if (pack) {
+			content.update();
+		} else {
+			display.update();
+		}
+		delay(1);
+	}
+	povSimSetShowHook(nullptr);
+	if (fclose(trace) || traceError) {
+		fprintf(stderr, "error writing %s\n", argv[optind]);
+		return 1;
+	}
+
+	TeensyPOV::getTelemetry(&telemetry);
+	printf("%u LED updates over %u revolutions, %.2f s simulated, now %.2f rev/s\n", records,
+			revolutions, millis() / 1000.0, povSimGetRps());
+	printf("dropped segments %u, compressed %u, glitches %u, frames skipped %u\n",
+			telemetry.droppedSegments, telemetry.compressedSegments,
+			telemetry.glitchesRejected, telemetry.framesSkipped);
+	if (pack) {
+		content.getStats(&contentStats);
+		printf("content: %u frames, %u entries, %u late, %u errors, longest read %u us\n",
+				contentStats.framesShown, contentStats.entriesShown, contentStats.lateFrames,
+				contentStats.errors, contentStats.maxReadMicros);
+	}
+	return 0;
+}
@@ -0,0 +1,585 @@
+/*
+ * povvideo.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Streams video to a TeensyPOV. Frames are decoded, resampled from cartesian to polar
+ * (segment x LED), quantized to the palette, and sent as changed segments followed by a swap.
+ * Each stage runs in its own thread, with resampling spread over a pool of workers, so the
+ * pipeline keeps up with 30 fps at 512 segments x 48 LEDs.
+ *
+ * Build:  g++ -O2 -std=c++11 -pthread -o povvideo povvideo.cpp
+ * Usage:  povvideo [options] <input> [port]
+ * 	<input>   Video file (decoded by ffmpeg, which must be on the PATH), a binary PPM stream
+ * 	          (.ppm / .pnm, or - for stdin), or a printf pattern for an image sequence such as
+ * 	          frame%04d.ppm (numbered from 0 or 1)
+ * 	[port]    Teensy serial port running examples/SerialStream, or the stand-in from povrecv
+ * 	-s LOG    Log (base 2) of number of segments (default 9)
+ * 	-b BITS   Color bits: 1, 2, 4 or 8 (default 8)
+ * 	-l LEDS   Number of LEDs (default 48)
+ * 	-t TDC    Top Dead Center segment (default 0)
+ * 	-i RADIUS Radius of the innermost LED, in LED spacings (default 1)
+ * 	-p FILE   Palette, one RRGGBB hex value per line (default: see povDefaultPalette())
+ * 	-r FPS    Frame rate, frames arriving late are dropped. 0 = as fast as possible (default 30)
+ * 	-j JOBS   Resampling threads (default: number of cores)
+ * 	-o FILE   Also write the raw frames sent, not those dropped as late (povsend -f format)
+ * 	-F        Send every frame in full instead of only the changed segments
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "PovHost.h"
+
+static const int ackTimeoutMs = 1000;
+static const uint32_t framesPerJob = 2;			// Decoded frames queued per resampling thread
+
+struct Image {
+	uint32_t sequence;
+	uint32_t width, height;
+	std::vector<uint8_t> rgb;
+};
+
+struct PolarFrame {
+	uint32_t sequence;
+	std::vector<uint32_t> words;
+};
+
+template<class T>
+class BoundedQueue {
+	// Blocking FIFO between pipeline stages. pop() returns false once closed and empty.
+	std::mutex lock;
+	std::condition_variable notEmpty, notFull;
+	std::deque<T> items;
+	size_t capacity;
+	bool closed = false;
+
+public:
+	explicit BoundedQueue(size_t c) :
+			capacity(c) {
+	}
+	void push(T item) {
+		std::unique_lock<std::mutex> guard(lock);
+		notFull.wait(guard, [this] {return items.size() < capacity;});
+		items.push_back(std::move(item));
+		notEmpty.notify_one();
+	}
+	bool pop(T &item) {
+		std::unique_lock<std::mutex> guard(lock);
+		notEmpty.wait(guard, [this] {return closed || !items.empty();});
+		if (items.empty()) {
+			return false;
+		}
+		item = std::move(items.front());
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+	void close() {
+		std::lock_guard<std::mutex> guard(lock);
+		closed = true;
+		notEmpty.notify_all();
+	}
+};
+
+class ReorderBuffer {
+	// Hands resampled frames to the sender in sequence. Workers wait if they get too far ahead.
+	std::mutex lock;
+	std::condition_variable changed;
+	std::map<uint32_t, PolarFrame> frames;
+	uint32_t next = 0, window;
+	uint32_t producers;
+
+public:
+	ReorderBuffer(uint32_t w, uint32_t p) :
+			window(w), producers(p) {
+	}
+	void put(PolarFrame frame) {
+		std::unique_lock<std::mutex> guard(lock);
+		changed.wait(guard,
+				[this, &frame] {return frame.sequence < next + window;});
+		frames[frame.sequence] = std::move(frame);
+		changed.notify_all();
+	}
+	void producerDone() {
+		std::lock_guard<std::mutex> guard(lock);
+		producers--;
+		changed.notify_all();
+	}
+	bool take(PolarFrame &frame) {
+		std::unique_lock<std::mutex> guard(lock);
+		changed.wait(guard,
+				[this] {return frames.count(next) || (producers == 0 && frames.empty());});
+		if (frames.empty()) {
+			return false;
+		}
+		frame = std::move(frames[next]);
+		frames.erase(next++);
+		changed.notify_all();
+		return true;
+	}
+};
+
+// ---------------------------------------------------------------------------------------------
+// Decode
+
+class PpmSource {
+	// Binary PPM (P6, maxval 255) frames from a stream, or from a numbered file sequence
+	FILE *file = nullptr;
+	bool isPipe = false;
+	std::string pattern;
+	uint32_t fileNumber = 0;
+
+	static bool readToken(FILE *f, uint32_t *value) {
+		int c;
+
+		do {
+			c = fgetc(f);
+			if (c == '#') {
+				while (c != '\n' && c != EOF) {
+					c = fgetc(f);
+				}
+			}
+		} while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		*value = 0;
+		while (c >= '0' && c <= '9') {
+			*value = *value * 10 + (c - '0');
+			c = fgetc(f);
+		}
+		return true;			// Consumes the single whitespace after the token
+	}
+
+	static bool readImage(FILE *f, Image &image) {
+		uint32_t maxval;
+
+		if (fgetc(f) != 'P' || fgetc(f) != '6') {
+			return false;
+		}
+		if (!readToken(f, &image.width) || !readToken(f, &image.height)
+				|| !readToken(f, &maxval) || maxval != 255 || image.width == 0
+				|| image.height == 0) {
+			fprintf(stderr, "unsupported PPM header\n");
+			return false;
+		}
+		image.rgb.resize(image.width * image.height * 3);
+		return fread(image.rgb.data(), 1, image.rgb.size(), f) == image.rgb.size();
+	}
+
+public:
+	bool open(const char *path) {
+		std::string name(path);
+		std::string ext = name.substr(name.find_last_of('.') + 1);
+		std::string command;
+		char first[1024];
+		FILE *f;
+
+		if (name == "-") {
+			file = stdin;
+		} else if (name.find('%') != std::string::npos) {
+			pattern = name;
+			snprintf(first, sizeof(first), pattern.c_str(), 0);
+			if (!(f = fopen(first, "rb"))) {
+				fileNumber = 1;
+			} else {
+				fclose(f);
+			}
+			return true;
+		} else if (ext == "ppm" || ext == "pnm") {
+			file = fopen(path, "rb");
+		} else {
+			command = "ffmpeg -loglevel error -nostdin -i '" + name
+					+ "' -f image2pipe -vcodec ppm -";
+			file = popen(command.c_str(), "r");
+			isPipe = true;
+		}
+		return file != nullptr;
+	}
+
+	bool read(Image &image) {
+		char name[1024];
+		bool ok;
+		FILE *f;
+
+		if (pattern.empty()) {
+			return readImage(file, image);
+		}
+		snprintf(name, sizeof(name), pattern.c_str(), fileNumber++);
+		if (!(f = fopen(name, "rb"))) {
+			return false;
+		}
+		ok = readImage(f, image);
+		fclose(f);
+		return ok;
+	}
+
+	void close() {
+		if (file && isPipe) {
+			pclose(file);
+		} else if (file && file != stdin) {
+			fclose(file);
+		}
+		file = nullptr;
+	}
+};
+
+// ---------------------------------------------------------------------------------------------
+// Polar resample and quantize
+
+class PolarSampler {
+	// For each (segment, LED), four source pixels and bilinear weights (8-bit fixed point),
+	// computed once for the input size. Quantizing uses a 15-bit RGB to palette index table.
+	struct Tap {
+		uint32_t offset[4];
+		uint16_t weight[4];
+	};
+	std::vector<Tap> taps;
+	std::vector<uint8_t> inverse;
+	uint32_t width = 0, height = 0;
+	PovConfig cfg;
+	float innerRadius;
+
+public:
+	PolarSampler(const PovConfig &c, float inner, const uint32_t *colors,
+			uint32_t numColors) :
+			cfg(c), innerRadius(inner) {
+		uint32_t rgb, i, best, dist, bestDist;
+		int32_t r, g, b, dr, dg, db;
+
+		inverse.resize(1 << 15);
+		for (rgb = 0; rgb < (1 << 15); rgb++) {
+			r = ((rgb >> 10) & 31) * 255 / 31;
+			g = ((rgb >> 5) & 31) * 255 / 31;
+			b = (rgb & 31) * 255 / 31;
+			best = 0;
+			bestDist = UINT32_MAX;
+			for (i = 0; i < numColors; i++) {
+				dr = r - (int32_t) ((colors[i] >> 16) & 0xFF);
+				dg = g - (int32_t) ((colors[i] >> 8) & 0xFF);
+				db = b - (int32_t) (colors[i] & 0xFF);
+				dist = 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = i;
+				}
+			}
+			inverse[rgb] = best;
+		}
+	}
+
+	void setSize(uint32_t w, uint32_t h) {
+		// Segment s is (s - TDC) segments clockwise from the top, as in TeensyPOV::setPixel()
+		uint32_t numSegments = cfg.numSegments(), segment, led, k;
+		float centerX = (w - 1) / 2.0f, centerY = (h - 1) / 2.0f;
+		float scale = (w < h ? w : h) / 2.0f / (innerRadius + cfg.numLeds);
+		float angle, radius, x, y, fx, fy;
+		int32_t x0, y0, x1, y1;
+		Tap *tap;
+
+		if (w == width && h == height) {
+			return;
+		}
+		width = w;
+		height = h;
+		taps.resize(numSegments * cfg.numLeds);
+		for (segment = 0; segment < numSegments; segment++) {
+			angle = 2.0f * (float) M_PI
+					* (float) ((segment - cfg.tdcSegment) & (numSegments - 1))
+					/ numSegments;
+			for (led = 0; led < cfg.numLeds; led++) {
+				radius = (innerRadius + led + 0.5f) * scale;
+				x = centerX + radius * sinf(angle);
+				y = centerY - radius * cosf(angle);
+				x0 = (int32_t) floorf(x);
+				y0 = (int32_t) floorf(y);
+				fx = x - x0;
+				fy = y - y0;
+				x1 = x0 + 1;
+				y1 = y0 + 1;
+				x0 = (x0 < 0) ? 0 : ((x0 >= (int32_t) w) ? w - 1 : x0);
+				x1 = (x1 < 0) ? 0 : ((x1 >= (int32_t) w) ? w - 1 : x1);
+				y0 = (y0 < 0) ? 0 : ((y0 >= (int32_t) h) ? h - 1 : y0);
+				y1 = (y1 < 0) ? 0 : ((y1 >= (int32_t) h) ? h - 1 : y1);
+				tap = &taps[segment * cfg.numLeds + led];
+				tap->offset[0] = (y0 * w + x0) * 3;
+				tap->offset[1] = (y0 * w + x1) * 3;
+				tap->offset[2] = (y1 * w + x0) * 3;
+				tap->offset[3] = (y1 * w + x1) * 3;
+				tap->weight[0] = (uint16_t) lrintf((1 - fx) * (1 - fy) * 256);
+				tap->weight[1] = (uint16_t) lrintf(fx * (1 - fy) * 256);
+				tap->weight[2] = (uint16_t) lrintf((1 - fx) * fy * 256);
+				tap->weight[3] = 256 - tap->weight[0] - tap->weight[1]
+						- tap->weight[2];
+				for (k = 0; k < 4; k++) {
+					if (tap->weight[k] > 256) {		// Rounding underflow
+						tap->weight[k] = 0;
+					}
+				}
+			}
+		}
+	}
+
+	void sample(const Image &image, std::vector<uint32_t> &words) const {
+		uint32_t numSegments = cfg.numSegments(), columns = cfg.columns();
+		uint32_t ppw = cfg.pixelsPerWord(), bits = cfg.numColorBits;
+		uint32_t segment, led, k, r, g, b, word, shift;
+		const uint8_t *rgb = image.rgb.data(), *p;
+		const Tap *tap = taps.data();
+
+		words.assign(numSegments * columns, 0);
+		for (segment = 0; segment < numSegments; segment++) {
+			word = segment * columns;
+			shift = 0;
+			for (led = 0; led < cfg.numLeds; led++, tap++) {
+				r = g = b = 128;
+				for (k = 0; k < 4; k++) {
+					p = rgb + tap->offset[k];
+					r += p[0] * tap->weight[k];
+					g += p[1] * tap->weight[k];
+					b += p[2] * tap->weight[k];
+				}
+				r = (r >> 8) > 255 ? 255 : (r >> 8);
+				g = (g >> 8) > 255 ? 255 : (g >> 8);
+				b = (b >> 8) > 255 ? 255 : (b >> 8);
+				words[word] |= (uint32_t) inverse[((r >> 3) << 10) | ((g >> 3) << 5)
+						| (b >> 3)] << shift;
+				shift += bits;
+				if (led % ppw == ppw - 1) {
+					word++;
+					shift = 0;
+				}
+			}
+		}
+	}
+};
+
+// ---------------------------------------------------------------------------------------------
+// Send
+
+static bool waitAck(PovAckReader &acks, uint8_t lastCommand) {
+	// Every ACK up to and including the last command's is consumed, even after a rejection, so the
+	// next frame doesn't take this one's for its own
+	uint8_t command, status;
+	bool ok = true;
+
+	while (acks.wait(&command, &status, ackTimeoutMs)) {
+		if (status != POV_STATUS_OK) {
+			fprintf(stderr, "command 0x%02X rejected, status %u\n", command,
+					status);
+			ok = false;
+		}
+		if (command == lastCommand) {
+			return ok;
+		}
+	}
+	fprintf(stderr, "timeout waiting for ACK\n");
+	while (acks.wait(&command, &status, ackTimeoutMs)) {
+		// Resync: drop ACKs still on their way
+	}
+	return false;
+}
+
+static double seconds(const struct timespec &t) {
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+	PovConfig cfg = { 9, 8, 0, 48 };
+	const char *paletteFile = nullptr, *rawFile = nullptr, *portName = nullptr;
+	uint32_t palette[256], numColors, fps = 30, jobs, i;
+	uint32_t sent = 0, dropped = 0, segmentsSent = 0, bytesSent = 0;
+	float innerRadius = 1.0f;
+	bool fullFrames = false, haveFrame = false;
+	struct timespec start, now, deadline;
+	FILE *raw = nullptr;
+	PpmSource source;
+	int opt, fd = -1;
+
+	jobs = std::thread::hardware_concurrency();
+	jobs = (jobs > 0) ? jobs : 2;
+	while ((opt = getopt(argc, argv, "s:b:l:t:i:p:r:j:o:F")) != -1) {
+		switch (opt) {
+		case 's': cfg.logNumSegments = atoi(optarg); break;
+		case 'b': cfg.numColorBits = atoi(optarg); break;
+		case 'l': cfg.numLeds = atoi(optarg); break;
+		case 't': cfg.tdcSegment = atoi(optarg); break;
+		case 'i': innerRadius = atof(optarg); break;
+		case 'p': paletteFile = optarg; break;
+		case 'r': fps = atoi(optarg); break;
+		case 'j': jobs = atoi(optarg); break;
+		case 'o': rawFile = optarg; break;
+		case 'F': fullFrames = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-s log] [-b bits] [-l leds] [-t tdc] "
+					"[-i radius] [-p palette] [-r fps] [-j jobs] [-o raw] [-F] "
+					"input [port]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc || cfg.logNumSegments < 1 || cfg.logNumSegments > povMaxLogNumSegments
+			|| (cfg.numColorBits != 1 && cfg.numColorBits != 2
+					&& cfg.numColorBits != 4 && cfg.numColorBits != 8)
+			|| cfg.numLeds == 0 || cfg.columns() > povMaxColumns
+			|| cfg.tdcSegment >= cfg.numSegments() || jobs == 0) {
+		fprintf(stderr, "bad arguments\n");
+		return 1;
+	}
+	portName = (optind + 1 < argc) ? argv[optind + 1] : nullptr;
+	if (!portName && !rawFile) {
+		fprintf(stderr, "nothing to do: give a port and / or -o\n");
+		return 1;
+	}
+
+	if (paletteFile) {
+		if (!povReadPalette(paletteFile, palette, &numColors)) {
+			fprintf(stderr, "can't read palette %s\n", paletteFile);
+			return 1;
+		}
+	} else {
+		numColors = povDefaultPalette(cfg.numColorBits, palette);
+	}
+	if (numColors > (1UL << cfg.numColorBits)) {
+		numColors = 1UL << cfg.numColorBits;
+	}
+	if (!source.open(argv[optind])) {
+		perror(argv[optind]);
+		return 1;
+	}
+	if (rawFile && !(raw = fopen(rawFile, "wb"))) {
+		perror(rawFile);
+		return 1;
+	}
+	if (portName && (fd = povOpenPort(portName)) < 0) {
+		perror(portName);
+		return 1;
+	}
+
+	PolarSampler sampler(cfg, innerRadius, palette, numColors);
+	BoundedQueue<std::shared_ptr<Image>> decoded(jobs * framesPerJob);
+	ReorderBuffer resampled(jobs * framesPerJob, jobs);
+	std::vector<std::thread> workers;
+
+	// Decode thread
+	std::thread decoder([&] {
+		uint32_t sequence = 0;
+		for (;;) {
+			std::shared_ptr<Image> image = std::make_shared<Image>();
+			if (!source.read(*image)) {
+				break;
+			}
+			image->sequence = sequence++;
+			decoded.push(image);
+		}
+		decoded.close();
+	});
+
+	// Resample / quantize threads
+	for (i = 0; i < jobs; i++) {
+		workers.emplace_back([&] {
+			PolarSampler local(sampler);
+			std::shared_ptr<Image> image;
+			PolarFrame frame;
+			while (decoded.pop(image)) {
+				local.setSize(image->width, image->height);	// Only rebuilt if the size changes
+				frame.sequence = image->sequence;
+				local.sample(*image, frame.words);
+				resampled.put(std::move(frame));
+			}
+			resampled.producerDone();
+		});
+	}
+
+	// Delta encode and send on this thread
+	PovAckReader acks(fd);
+	std::vector<uint8_t> out;
+	std::vector<uint32_t> previous;
+	PolarFrame frame;
+	bool linkOk = true;
+
+	if (fd >= 0) {
+		povEncodeConfig(out, cfg);
+		povEncodePalette(out, 0, palette, numColors);
+		povEncodeSwap(out);
+		linkOk = povWriteAll(fd, out.data(), out.size())
+				&& waitAck(acks, POV_CMD_SWAP);
+		out.clear();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	deadline = start;
+	while (linkOk && resampled.take(frame)) {
+		if (fps > 0) {
+			deadline.tv_nsec += 1000000000L / fps;
+			while (deadline.tv_nsec >= 1000000000L) {
+				deadline.tv_nsec -= 1000000000L;
+				deadline.tv_sec++;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			if (seconds(now) > seconds(deadline)) {
+				dropped++;		// Late, keep the rate steady
+				continue;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+		}
+		if (raw) {
+			fwrite(frame.words.data(), 4, frame.words.size(), raw);
+		}
+		if (fd < 0) {
+			sent++;
+			continue;
+		}
+
+		if (fullFrames || !haveFrame) {
+			povEncodeSegments(out, cfg, frame.words.data(), 0, cfg.numSegments());
+			segmentsSent += cfg.numSegments();
+		} else {
+			segmentsSent += povEncodeDelta(out, cfg, frame.words.data(),
+					previous.data());
+		}
+		povEncodeSwap(out);
+		bytesSent += out.size();
+		if (!povWriteAll(fd, out.data(), out.size())) {
+			perror(portName);
+			linkOk = false;
+		} else if (!waitAck(acks, POV_CMD_SWAP)) {
+			haveFrame = false;			// Device may hold a partial frame, resend in full
+		} else {
+			previous.swap(frame.words);
+			haveFrame = true;
+			sent++;
+		}
+		out.clear();
+	}
+
+	if (!linkOk) {
+		// Unblock the pipeline so the threads can finish
+		while (resampled.take(frame)) {
+		}
+	}
+	decoder.join();
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	source.close();
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	printf("%u frames sent, %u dropped, %.1f fps, %u segments, %u bytes\n", sent,
+			dropped, sent / (seconds(now) - seconds(start)), segmentsSent,
+			bytesSent);
+	if (raw) {
+		fclose(raw);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	return linkOk ? 0 : 1;
+}
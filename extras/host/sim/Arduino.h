@@ -0,0 +1,271 @@
+/*
+ * Arduino.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Host stand-in for the parts of the Teensy 3.x core the library uses, so it can be built and run by
+ * povsim. The PIT registers are live: they count down with PovSim's simulated bus clock and raise their
+ * interrupts (see PovSim.cpp). The other peripherals (FTM0, SPI0, PDB0, ADC0) are plain storage, enough
+ * to build every configuration but not to run it.
+ */
+
+#ifndef POVSIM_ARDUINO_H_
+#define POVSIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Teensy 3.2 at 96 MHz
+#define KINETISK
+#define __MK20DX256__
+#ifndef F_CPU
+#define F_CPU 96000000
+#endif
+#ifndef F_BUS
+#define F_BUS 48000000
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEC 10
+#define HEX 16
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Periodic Interrupt Timers
+uint32_t povSimPitRead(uint8_t, uint8_t);
+void povSimPitWrite(uint8_t, uint8_t, uint32_t);
+
+struct PovSimPitRegister {
+	uint8_t channel;
+	uint8_t reg;			// 0 LDVAL, 1 CVAL, 2 TCTRL, 3 TFLG
+
+	operator uint32_t() const {
+		return povSimPitRead(channel, reg);
+	}
+	PovSimPitRegister &operator=(uint32_t value) {
+		povSimPitWrite(channel, reg, value);
+		return *this;
+	}
+	PovSimPitRegister &operator<<=(uint32_t n) {
+		return *this = (uint32_t) *this << n;
+	}
+	PovSimPitRegister &operator>>=(uint32_t n) {
+		return *this = (uint32_t) *this >> n;
+	}
+	PovSimPitRegister &operator|=(uint32_t value) {
+		return *this = (uint32_t) *this | value;
+	}
+	PovSimPitRegister &operator&=(uint32_t value) {
+		return *this = (uint32_t) *this & value;
+	}
+};
+
+typedef struct {
+	PovSimPitRegister LDVAL;
+	PovSimPitRegister CVAL;
+	PovSimPitRegister TCTRL;
+	PovSimPitRegister TFLG;
+} KINETISK_PIT_CHANNEL_t;
+
+extern KINETISK_PIT_CHANNEL_t KINETISK_PIT_CHANNELS[4];
+#define PIT_TFLG0 (KINETISK_PIT_CHANNELS[0].TFLG)
+#define PIT_TFLG1 (KINETISK_PIT_CHANNELS[1].TFLG)
+#define PIT_TFLG2 (KINETISK_PIT_CHANNELS[2].TFLG)
+#define PIT_TFLG3 (KINETISK_PIT_CHANNELS[3].TFLG)
+extern volatile uint32_t PIT_MCR;
+
+void pit0_isr(void);
+void pit1_isr(void);
+void pit2_isr(void);
+void pit3_isr(void);
+
+// NVIC. Priorities only order pending interrupts: handlers run to completion, see PovSim.cpp.
+#define IRQ_ADC0 39
+#define IRQ_FTM0 62
+#define IRQ_PIT_CH0 68
+#define IRQ_PORTA 87
+#define IRQ_SOFTWARE 94
+#define NVIC_NUM_INTERRUPTS 95
+void NVIC_SET_PRIORITY(int, int);
+void NVIC_ENABLE_IRQ(int);
+void NVIC_DISABLE_IRQ(int);
+void NVIC_SET_PENDING(int);
+void attachInterruptVector(int, void (*)(void));
+
+// Interrupts are only taken while simulated time advances (delay(), povSimRun()), so these are no-ops
+#define noInterrupts() do {} while (0)
+#define interrupts() do {} while (0)
+#define __disable_irq() do {} while (0)
+#define __enable_irq() do {} while (0)
+
+// Cycle counter, follows the simulated clock
+uint32_t povSimCycles(void);
+extern volatile uint32_t ARM_DEMCR, ARM_DWT_CTRL;
+#define ARM_DWT_CYCCNT (povSimCycles())
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL_CYCCNTENA 1
+
+// Clock gating and pin muxing
+extern volatile uint32_t SIM_SCGC3, SIM_SCGC4, SIM_SCGC6;
+#define SIM_SCGC6_SPI0 (1 << 12)
+#define SIM_SCGC6_PDB (1 << 22)
+#define SIM_SCGC6_PIT (1 << 23)
+#define SIM_SCGC6_FTM0 (1 << 24)
+#define SIM_SCGC6_ADC0 (1 << 27)
+volatile uint32_t *povSimPortConfig(uint8_t);
+#define CORE_PIN5_CONFIG (*povSimPortConfig(5))
+#define CORE_PIN6_CONFIG (*povSimPortConfig(6))
+#define CORE_PIN9_CONFIG (*povSimPortConfig(9))
+#define CORE_PIN10_CONFIG (*povSimPortConfig(10))
+#define CORE_PIN11_CONFIG (*povSimPortConfig(11))
+#define CORE_PIN13_CONFIG (*povSimPortConfig(13))
+#define CORE_PIN20_CONFIG (*povSimPortConfig(20))
+#define CORE_PIN21_CONFIG (*povSimPortConfig(21))
+#define CORE_PIN22_CONFIG (*povSimPortConfig(22))
+#define CORE_PIN23_CONFIG (*povSimPortConfig(23))
+#define PORT_PCR_PS 0x01
+#define PORT_PCR_PE 0x02
+#define PORT_PCR_DSE 0x40
+#define PORT_PCR_MUX(n) (((n) & 7) << 8)
+
+// FTM0 (input capture)
+extern volatile uint32_t FTM0_SC, FTM0_CNT, FTM0_MOD, FTM0_CNTIN, FTM0_STATUS, FTM0_MODE, FTM0_FILTER;
+extern volatile uint32_t FTM0_C0SC, FTM0_C0V, FTM0_C1SC, FTM0_C1V, FTM0_C2SC, FTM0_C2V, FTM0_C3SC, FTM0_C3V;
+extern volatile uint32_t FTM0_C4SC, FTM0_C4V, FTM0_C5SC, FTM0_C5V, FTM0_C6SC, FTM0_C6V, FTM0_C7SC, FTM0_C7V;
+#define FTM_SC_PS(n) ((n) & 7)
+#define FTM_SC_CLKS(n) (((n) & 3) << 3)
+#define FTM_CSC_ELSA 0x04
+#define FTM_CSC_ELSB 0x08
+#define FTM_CSC_CHIE 0x40
+#define FTM_CSC_CHF 0x80
+#define FTM_MODE_FTMEN 0x01
+#define FTM_MODE_WPDIS 0x04
+void ftm0_isr(void);
+
+// SPI0 (POV_APA102_HDR), not simulated: the FIFO always reads empty and writes are dropped
+extern volatile uint32_t SPI0_MCR, SPI0_SR, SPI0_PUSHR, SPI0_CTAR0;
+#define SPI_MCR_HALT 0x01
+#define SPI_MCR_CLR_RXF (1 << 10)
+#define SPI_MCR_CLR_TXF (1 << 11)
+#define SPI_MCR_PCSIS(n) (((n) & 0x3F) << 16)
+#define SPI_MCR_MSTR (1UL << 31)
+#define SPI_CTAR_BR(n) ((n) & 15)
+#define SPI_CTAR_PBR(n) (((n) & 3) << 16)
+#define SPI_CTAR_FMSZ(n) (((n) & 15) << 27)
+#define SPI_CTAR_DBR (1UL << 31)
+
+// PDB0 / ADC0 (TeensyPovAudio), not simulated
+extern volatile uint32_t PDB0_SC, PDB0_MOD, PDB0_IDLY, PDB0_CH0C1, ADC0_SC1A, ADC0_SC2, ADC0_RA;
+#define PDB_SC_LDOK 0x01
+#define PDB_SC_CONT 0x02
+#define PDB_SC_PDBEN 0x80
+#define PDB_SC_TRGSEL(n) (((n) & 15) << 8)
+#define PDB_SC_SWTRIG 0x10000
+#define PDB_CH0C1_EN(n) ((n) & 255)
+#define PDB_CH0C1_TOS(n) (((n) & 255) << 8)
+#define ADC_SC1_AIEN 0x40
+#define ADC_SC2_ADTRG 0x40
+
+// Pins. The Hall sensor is the pin with a FALLING interrupt attached; it reads high between edges.
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+#define FALLING 2
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define A8 22
+#define A9 23
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+void attachInterrupt(uint8_t, void (*)(void), int);
+int analogRead(uint8_t);
+void analogReadResolution(unsigned int);
+
+// Simulated time
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t);
+void delayMicroseconds(uint32_t);
+
+// Serial output goes to stderr, input is always empty
+class Print {
+public:
+	virtual ~Print() {
+	}
+	virtual size_t write(uint8_t) = 0;
+	size_t write(const uint8_t *, size_t);
+	size_t print(const char *);
+	size_t print(char);
+	size_t print(int, int = DEC);
+	size_t print(unsigned int, int = DEC);
+	size_t print(long, int = DEC);
+	size_t print(unsigned long, int = DEC);
+	size_t print(long long, int = DEC);
+	size_t print(unsigned long long, int = DEC);
+	size_t print(unsigned char, int = DEC);
+	size_t print(double, int = 2);
+	template<class T> size_t println(T value) {
+		size_t n = print(value);
+		return n + println();
+	}
+	template<class T> size_t println(T value, int format) {
+		size_t n = print(value, format);
+		return n + println();
+	}
+	size_t println(void);
+};
+
+class Stream: public Print {
+public:
+	virtual int available(void) = 0;
+	virtual int read(void) = 0;
+	virtual int peek(void) = 0;
+	size_t readBytes(char *, size_t);
+	size_t readBytes(uint8_t *buffer, size_t length) {
+		return readBytes((char *) buffer, length);
+	}
+};
+
+class PovSimSerial: public Stream {
+public:
+	void begin(uint32_t) {
+	}
+	operator bool() {
+		return true;
+	}
+	int available(void) {
+		return 0;
+	}
+	int read(void) {
+		return -1;
+	}
+	int peek(void) {
+		return -1;
+	}
+	size_t write(uint8_t);
+	using Print::write;
+};
+
+extern PovSimSerial Serial;
+
+#endif /* POVSIM_ARDUINO_H_ */
@@ -0,0 +1,103 @@
+/*
+ * FastLED.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Host stand-in for the parts of FastLED the library and a simple sketch use. show() hands the LEDs to
+ * PovSim, which takes the time an APA102 strip needs to clock them in off the simulated clock and
+ * records them with the rotor position (see povSimShow()).
+ */
+
+#ifndef POVSIM_FASTLED_H_
+#define POVSIM_FASTLED_H_
+
+#include <stdint.h>
+
+struct CRGB {
+	union {
+		struct {
+			uint8_t r, g, b;
+		};
+		uint8_t raw[3];
+	};
+
+	enum HTMLColorCode {
+		Black = 0x000000,
+		Blue = 0x0000FF,
+		Cyan = 0x00FFFF,
+		DarkBlue = 0x00008B,
+		DarkGreen = 0x006400,
+		DarkRed = 0x8B0000,
+		Gray = 0x808080,
+		Green = 0x008000,
+		Lime = 0x00FF00,
+		Magenta = 0xFF00FF,
+		Orange = 0xFFA500,
+		Purple = 0x800080,
+		Red = 0xFF0000,
+		White = 0xFFFFFF,
+		Yellow = 0xFFFF00
+	};
+
+	CRGB() {
+	}
+	CRGB(uint8_t red, uint8_t green, uint8_t blue) :
+			r(red), g(green), b(blue) {
+	}
+	CRGB(uint32_t color) :
+			r(color >> 16), g(color >> 8), b(color) {
+	}
+	CRGB(HTMLColorCode color) :
+			CRGB((uint32_t) color) {
+	}
+	CRGB &operator=(uint32_t color) {
+		r = color >> 16;
+		g = color >> 8;
+		b = color;
+		return *this;
+	}
+	bool operator==(const CRGB &other) const {
+		return r == other.r && g == other.g && b == other.b;
+	}
+	bool operator!=(const CRGB &other) const {
+		return !(*this == other);
+	}
+};
+
+enum ESPIChipsets {
+	APA102, SK9822, DOTSTAR = APA102
+};
+
+enum EOrder {
+	RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210
+};
+
+#define DATA_RATE_MHZ(X) ((X) * 1000000UL)
+
+void povSimAddLeds(CRGB *, int, uint32_t);
+void povSimShow(uint8_t);
+
+class CFastLED {
+	uint8_t brightness = 255;
+public:
+	// Color order only matters to the hardware; the simulator records CRGB values
+	template<ESPIChipsets CHIPSET, uint8_t DATA_PIN, uint8_t CLOCK_PIN, EOrder RGB_ORDER = RGB,
+			uint32_t SPI_DATA_RATE = DATA_RATE_MHZ(12)>
+	void addLeds(CRGB *data, int numLeds) {
+		povSimAddLeds(data, numLeds, SPI_DATA_RATE);
+	}
+	void setBrightness(uint8_t scale) {
+		brightness = scale;
+	}
+	uint8_t getBrightness(void) {
+		return brightness;
+	}
+	void show(void) {
+		povSimShow(brightness);
+	}
+};
+
+extern CFastLED FastLED;
+
+#endif /* POVSIM_FASTLED_H_ */
@@ -0,0 +1,578 @@
+/*
+ * PovSim.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Event driven: time only moves when the program calls delay() or povSimRun(), which steps from one
+ * due PIT reload or Hall edge to the next and runs the interrupts they raise, highest priority (lowest
+ * number) first. Handlers take no simulated time except for FastLED.show(), which takes as long as
+ * clocking the LEDs out would; anything falling due meanwhile is taken when the handler returns, as if
+ * nothing preempted it. The result is deterministic, so traces can be compared bit for bit.
+ */
+
+#include <stdio.h>
+#include "PovSim.h"
+#include "SD.h"
+
+void ftm0_isr(void) __attribute__((weak));
+
+// Register storage
+KINETISK_PIT_CHANNEL_t KINETISK_PIT_CHANNELS[4] = {
+		{ { 0, 0 }, { 0, 1 }, { 0, 2 }, { 0, 3 } },
+		{ { 1, 0 }, { 1, 1 }, { 1, 2 }, { 1, 3 } },
+		{ { 2, 0 }, { 2, 1 }, { 2, 2 }, { 2, 3 } },
+		{ { 3, 0 }, { 3, 1 }, { 3, 2 }, { 3, 3 } } };
+volatile uint32_t PIT_MCR;
+volatile uint32_t ARM_DEMCR, ARM_DWT_CTRL;
+volatile uint32_t SIM_SCGC3, SIM_SCGC4, SIM_SCGC6;
+volatile uint32_t FTM0_SC, FTM0_CNT, FTM0_MOD, FTM0_CNTIN, FTM0_STATUS, FTM0_MODE, FTM0_FILTER;
+volatile uint32_t FTM0_C0SC, FTM0_C0V, FTM0_C1SC, FTM0_C1V, FTM0_C2SC, FTM0_C2V, FTM0_C3SC, FTM0_C3V;
+volatile uint32_t FTM0_C4SC, FTM0_C4V, FTM0_C5SC, FTM0_C5V, FTM0_C6SC, FTM0_C6V, FTM0_C7SC, FTM0_C7V;
+volatile uint32_t SPI0_MCR, SPI0_SR, SPI0_PUSHR, SPI0_CTAR0;
+volatile uint32_t PDB0_SC, PDB0_MOD, PDB0_IDLY, PDB0_CH0C1, ADC0_SC1A, ADC0_SC2, ADC0_RA;
+
+PovSimSerial Serial;
+CFastLED FastLED;
+SDClass SD;
+
+static const uint8_t pitLdval = 0;
+static const uint8_t pitCval = 1;
+static const uint8_t pitTctrl = 2;
+static const uint8_t pitTflg = 3;
+static const uint8_t defaultPriority = 128;
+static const uint8_t maxShowLeds = 255;
+
+struct Pit {
+	uint32_t ldval;
+	uint32_t load;			// Value the counter was last loaded with
+	uint64_t loadTick;		// ... and when
+	uint32_t tctrl;
+	bool flag;
+};
+
+static uint64_t now = 0;
+static Pit pits[4];
+static uint8_t priorities[NVIC_NUM_INTERRUPTS];
+static bool enabled[NVIC_NUM_INTERRUPTS];
+static bool pending[NVIC_NUM_INTERRUPTS];
+static void (*vectors[NVIC_NUM_INTERRUPTS])(void);
+static bool vectorsSet = false;
+static bool inHandler = false;
+
+// Rotor: position = base + rps * t + acceleration * t^2 / 2 from baseTick, in revolutions
+static double rotorBase = 0, rotorRps = 0, rotorAcceleration = 0;
+static uint64_t rotorBaseTick = 0;
+static uint64_t hallEdges = 0;
+static uint64_t hallJitterTicks = 0;
+static void (*hallHandler)(void) = nullptr;
+
+static CRGB *ledData = nullptr;
+static uint16_t numLedData = 0;
+static uint32_t ledClock = DATA_RATE_MHZ(12);
+static void (*showHook)(uint64_t, uint64_t, const CRGB *, uint16_t) = nullptr;
+static uint32_t sdRate = 0;
+
+static void hallIsr(void) {
+	if (hallHandler) {
+		hallHandler();
+	}
+}
+
+static void setVectors(void) {
+	// Power on state: everything at the default priority, the PIT and Hall (port) interrupts wired up
+	if (vectorsSet) {
+		return;
+	}
+	for (int irq = 0; irq < NVIC_NUM_INTERRUPTS; irq++) {
+		priorities[irq] = defaultPriority;
+	}
+	vectors[IRQ_PIT_CH0] = pit0_isr;
+	vectors[IRQ_PIT_CH0 + 1] = pit1_isr;
+	vectors[IRQ_PIT_CH0 + 2] = pit2_isr;
+	vectors[IRQ_PIT_CH0 + 3] = pit3_isr;
+	vectors[IRQ_FTM0] = ftm0_isr;
+	vectors[IRQ_PORTA] = hallIsr;
+	enabled[IRQ_PORTA] = true;
+	vectorsSet = true;
+}
+
+static void dispatch(void) {
+	// Run pending interrupts, highest priority first. Ones pended by a handler wait for it to return.
+	int irq, best;
+
+	if (inHandler) {
+		return;
+	}
+	setVectors();
+	inHandler = true;
+	for (;;) {
+		best = -1;
+		for (irq = 0; irq < NVIC_NUM_INTERRUPTS; irq++) {
+			if (pending[irq] && enabled[irq]
+					&& (best < 0 || priorities[irq] < priorities[best])) {
+				best = irq;
+			}
+		}
+		if (best < 0) {
+			break;
+		}
+		pending[best] = false;
+		if (vectors[best]) {
+			vectors[best]();
+		}
+	}
+	inHandler = false;
+}
+
+void NVIC_SET_PRIORITY(int irq, int priority) {
+	setVectors();
+	priorities[irq] = priority;
+}
+
+void NVIC_ENABLE_IRQ(int irq) {
+	setVectors();
+	enabled[irq] = true;
+	dispatch();
+}
+
+void NVIC_DISABLE_IRQ(int irq) {
+	enabled[irq] = false;
+}
+
+void NVIC_SET_PENDING(int irq) {
+	pending[irq] = true;
+	dispatch();
+}
+
+void attachInterruptVector(int irq, void (*function)(void)) {
+	setVectors();
+	vectors[irq] = function;
+}
+
+static uint64_t pitExpiry(const Pit &pit) {
+	// Tick of the next reload, when the flag sets
+	return pit.loadTick + pit.load + 1;
+}
+
+uint32_t povSimPitRead(uint8_t channel, uint8_t reg) {
+	Pit &pit = pits[channel];
+	uint64_t elapsed;
+
+	switch (reg) {
+	case pitLdval:
+		return pit.ldval;
+	case pitCval:
+		if (!(pit.tctrl & 1)) {
+			return pit.load;
+		}
+		elapsed = now - pit.loadTick;
+		if (elapsed <= pit.load) {
+			return pit.load - elapsed;
+		}
+		// Reloaded while a handler held up the simulation
+		elapsed -= (uint64_t) pit.load + 1;
+		return pit.ldval - (uint32_t) (elapsed % ((uint64_t) pit.ldval + 1));
+	case pitTctrl:
+		return pit.tctrl;
+	default:
+		return pit.flag;
+	}
+}
+
+void povSimPitWrite(uint8_t channel, uint8_t reg, uint32_t value) {
+	Pit &pit = pits[channel];
+
+	switch (reg) {
+	case pitLdval:
+		pit.ldval = value;		// Takes effect at the next reload, or when the timer is enabled
+		break;
+	case pitTctrl:
+		if ((value & 1) && !(pit.tctrl & 1)) {
+			pit.load = pit.ldval;
+			pit.loadTick = now;
+		}
+		pit.tctrl = value & 3;
+		break;
+	case pitTflg:
+		if (value & 1) {
+			pit.flag = false;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static double rotorPositionAt(uint64_t tick) {
+	double t = (double) (tick - rotorBaseTick) / F_BUS;
+
+	if (rotorAcceleration < 0 && rotorRps + rotorAcceleration * t < 0) {
+		t = -rotorRps / rotorAcceleration;		// Stopped
+	}
+	return rotorBase + rotorRps * t + 0.5 * rotorAcceleration * t * t;
+}
+
+static uint64_t nextHallTick(void) {
+	// Solve for the time the rotor reaches the next whole revolution
+	double remaining = (double) (hallEdges + 1) - rotorBase;
+	double root = rotorRps * rotorRps + 2 * rotorAcceleration * remaining;
+	double denominator;
+
+	if (remaining <= 0) {
+		return rotorBaseTick;
+	}
+	if (root < 0) {
+		return UINT64_MAX;		// Stops short of it
+	}
+	denominator = rotorRps + sqrt(root);
+	if (denominator <= 0) {
+		return UINT64_MAX;
+	}
+	return rotorBaseTick + (uint64_t) ceil(2 * remaining / denominator * F_BUS);
+}
+
+static uint64_t hallInterruptTick(void) {
+	// The edge, plus a delay that is pseudo random but the same for each edge every run (splitmix64)
+	uint64_t tick = nextHallTick(), z;
+
+	if (tick == UINT64_MAX || hallJitterTicks == 0) {
+		return tick;
+	}
+	z = (hallEdges + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z ^= z >> 31;
+	return tick + z % (hallJitterTicks + 1);
+}
+
+void povSimSetRotor(double rps, double acceleration) {
+	rotorBase = rotorPositionAt(now);
+	rotorBaseTick = now;
+	rotorRps = (rps > 0) ? rps : 0;
+	rotorAcceleration = acceleration;
+}
+
+void povSimSetHallJitter(double seconds) {
+	hallJitterTicks = (seconds > 0) ? (uint64_t) (seconds * F_BUS + 0.5) : 0;
+}
+
+double povSimGetRps(void) {
+	double t = (double) (now - rotorBaseTick) / F_BUS;
+	double rps = rotorRps + rotorAcceleration * t;
+
+	return (rps > 0) ? rps : 0;
+}
+
+void povSimRunTicks(uint64_t ticks) {
+	uint64_t until = now + ticks, next, tick;
+	int channel;
+
+	if (inHandler) {
+		now = until;			// Busy waiting in a handler
+		return;
+	}
+	setVectors();
+	for (;;) {
+		next = hallInterruptTick();
+		for (channel = 0; channel < 4; channel++) {
+			if ((pits[channel].tctrl & 1) && pitExpiry(pits[channel]) < next) {
+				next = pitExpiry(pits[channel]);
+			}
+		}
+		if (next > until) {
+			break;
+		}
+		if (next > now) {
+			now = next;
+		}
+
+		// Everything due by now, then the interrupts it raised
+		for (channel = 0; channel < 4; channel++) {
+			Pit &pit = pits[channel];
+			while ((pit.tctrl & 1) && (tick = pitExpiry(pit)) <= now) {
+				pit.loadTick = tick;
+				pit.load = pit.ldval;
+				pit.flag = true;
+				if (pit.tctrl & 2) {
+					pending[IRQ_PIT_CH0 + channel] = true;
+				}
+			}
+		}
+		while (hallInterruptTick() <= now) {
+			hallEdges++;
+			pending[IRQ_PORTA] = true;
+		}
+		dispatch();
+	}
+	if (now < until) {
+		now = until;
+	}
+}
+
+void povSimRun(double seconds) {
+	povSimRunTicks((uint64_t) (seconds * F_BUS + 0.5));
+}
+
+uint64_t povSimTicks(void) {
+	return now;
+}
+
+uint64_t povSimPosition(void) {
+	return (uint64_t) (rotorPositionAt(now) * povSimPositionScale);
+}
+
+uint64_t povSimHallEdges(void) {
+	return hallEdges;
+}
+
+uint32_t povSimCycles(void) {
+	return (uint32_t) (now * (F_CPU / F_BUS));
+}
+
+void povSimSetLedClock(uint32_t hz) {
+	ledClock = hz;
+}
+
+void povSimSetShowHook(void (*hook)(uint64_t, uint64_t, const CRGB *, uint16_t)) {
+	showHook = hook;
+}
+
+void povSimAddLeds(CRGB *data, int numLeds, uint32_t rate) {
+	ledData = data;
+	numLedData = (numLeds > maxShowLeds) ? maxShowLeds : numLeds;
+	ledClock = rate;
+}
+
+void povSimShow(uint8_t brightness) {
+	// APA102: 32 bit start frame, 32 bits per LED, then at least half a bit per LED to push the data through
+	static CRGB scaled[maxShowLeds];
+	uint32_t bits, index;
+
+	if (!ledData) {
+		return;
+	}
+	bits = 32 + 32 * numLedData + 8 * ((numLedData + 15) / 16);
+	now += ((uint64_t) bits * F_BUS + ledClock - 1) / ledClock;
+	if (showHook) {
+		for (index = 0; index < numLedData; index++) {
+			scaled[index].r = (ledData[index].r * (brightness + 1)) >> 8;
+			scaled[index].g = (ledData[index].g * (brightness + 1)) >> 8;
+			scaled[index].b = (ledData[index].b * (brightness + 1)) >> 8;
+		}
+		showHook(now, povSimPosition(), scaled, numLedData);
+	}
+}
+
+void povSimSetSdRate(uint32_t bytesPerSecond) {
+	sdRate = bytesPerSecond;
+}
+
+// SD card
+int File::read(void *buffer, size_t length) {
+	size_t n;
+
+	if (!handle) {
+		return -1;
+	}
+	n = fread(buffer, 1, length, handle);
+	if (sdRate > 0) {
+		povSimRunTicks(((uint64_t) n * F_BUS + sdRate - 1) / sdRate);
+	}
+	return n;
+}
+
+int File::read() {
+	uint8_t c;
+
+	return (read(&c, 1) == 1) ? c : -1;
+}
+
+int File::available() {
+	return size() - position();
+}
+
+bool File::seek(uint32_t position) {
+	return handle && fseek(handle, position, SEEK_SET) == 0;
+}
+
+uint32_t File::position() {
+	return handle ? ftell(handle) : 0;
+}
+
+uint32_t File::size() {
+	long here, end;
+
+	if (!handle) {
+		return 0;
+	}
+	here = ftell(handle);
+	fseek(handle, 0, SEEK_END);
+	end = ftell(handle);
+	fseek(handle, here, SEEK_SET);
+	return end;
+}
+
+void File::close() {
+	if (handle) {
+		fclose(handle);
+		handle = nullptr;
+	}
+}
+
+bool SDClass::begin(uint8_t) {
+	return true;
+}
+
+File SDClass::open(const char *path, uint8_t) {
+	return File(fopen(path, "rb"));
+}
+
+bool SDClass::exists(const char *path) {
+	FILE *f = fopen(path, "rb");
+
+	if (f) {
+		fclose(f);
+	}
+	return f != nullptr;
+}
+
+// Pins
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t, uint8_t) {
+}
+
+int digitalRead(uint8_t) {
+	return HIGH;
+}
+
+void attachInterrupt(uint8_t, void (*function)(void), int mode) {
+	if (mode == FALLING) {
+		hallHandler = function;
+	}
+}
+
+int analogRead(uint8_t) {
+	return 0;
+}
+
+void analogReadResolution(unsigned int) {
+}
+
+volatile uint32_t *povSimPortConfig(uint8_t pin) {
+	static volatile uint32_t config[64];
+
+	return &config[pin & 63];
+}
+
+// Time
+uint32_t millis(void) {
+	return (uint32_t) (now / (F_BUS / 1000));
+}
+
+uint32_t micros(void) {
+	return (uint32_t) (now / (F_BUS / 1000000));
+}
+
+void delay(uint32_t ms) {
+	povSimRunTicks((uint64_t) ms * (F_BUS / 1000));
+}
+
+void delayMicroseconds(uint32_t us) {
+	povSimRunTicks((uint64_t) us * (F_BUS / 1000000));
+}
+
+// Serial
+static size_t printNumber(Print *out, unsigned long long value, int base, bool negative) {
+	char text[72];
+	int length = sizeof(text);
+
+	if (base < 2 || base > 16) {
+		base = DEC;
+	}
+	text[--length] = 0;
+	do {
+		text[--length] = "0123456789ABCDEF"[value % base];
+		value /= base;
+	} while (value);
+	if (negative) {
+		text[--length] = '-';
+	}
+	return out->print(text + length);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+	size_t n = 0;
+
+	while (size--) {
+		n += write(*buffer++);
+	}
+	return n;
+}
+
+size_t Print::print(const char *text) {
+	return write((const uint8_t *) text, strlen(text));
+}
+
+size_t Print::print(char c) {
+	return write((uint8_t) c);
+}
+
+size_t Print::print(int value, int base) {
+	return print((long long) value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+	return printNumber(this, value, base, false);
+}
+
+size_t Print::print(long value, int base) {
+	return print((long long) value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+	return printNumber(this, value, base, false);
+}
+
+size_t Print::print(long long value, int base) {
+	if (base == DEC && value < 0) {
+		return printNumber(this, -(unsigned long long) value, base, true);
+	}
+	return printNumber(this, value, base, false);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+	return printNumber(this, value, base, false);
+}
+
+size_t Print::print(unsigned char value, int base) {
+	return printNumber(this, value, base, false);
+}
+
+size_t Print::print(double value, int digits) {
+	char text[64];
+
+	snprintf(text, sizeof(text), "%.*f", digits, value);
+	return print(text);
+}
+
+size_t Print::println(void) {
+	return print("\r\n");
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+	size_t n = 0;
+	int c;
+
+	while (n < length && (c = read()) >= 0) {
+		buffer[n++] = c;
+	}
+	return n;
+}
+
+size_t PovSimSerial::write(uint8_t c) {
+	fputc(c, stderr);
+	return 1;
+}
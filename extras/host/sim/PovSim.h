@@ -0,0 +1,48 @@
+/*
+ * PovSim.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * Host simulation of a Teensy 3.x spinning the LEDs: a bus clock, the four PITs and the NVIC, a rotor
+ * whose Hall sensor edges drive the library's TDC interrupt, and a hook that receives every FastLED.show()
+ * with the time and rotor position it happened at (see povsim.cpp and PovTrace.h).
+ */
+
+#ifndef POVSIM_H_
+#define POVSIM_H_
+
+#include "Arduino.h"
+#include "FastLED.h"
+
+// Rotor positions are in 1/2^32 revolution since the simulation started. Hall edges are at whole revolutions.
+static const double povSimPositionScale = 4294967296.0;
+
+// Rotor speed in revolutions per second, changing by acceleration revolutions per second per second
+// (the speed stops at 0). Takes effect from the current time.
+void povSimSetRotor(double rps, double acceleration = 0);
+double povSimGetRps(void);
+
+// Hall interrupts come up to this long after the edge (sensor switching and interrupt latency),
+// pseudo randomly but the same each run. Default 0.
+void povSimSetHallJitter(double seconds);
+
+// Advance simulated time, taking interrupts as they fall due
+void povSimRun(double seconds);
+void povSimRunTicks(uint64_t ticks);
+
+uint64_t povSimTicks(void);					// Bus clock ticks since start
+uint64_t povSimPosition(void);				// Rotor position now
+uint64_t povSimHallEdges(void);
+
+// LED data clock; addLeds() sets it from its data rate
+void povSimSetLedClock(uint32_t hz);
+
+// Called at the end of each FastLED.show(), when the LEDs latch, with the LEDs scaled by the brightness
+void povSimSetShowHook(void (*hook)(uint64_t ticks, uint64_t position, const CRGB *leds, uint16_t numLeds));
+
+// SD card read rate in bytes per second: File::read() takes that long, with interrupts running meanwhile
+// as they would while a sketch waits on the card. Default 0, reads take no time.
+void povSimSetSdRate(uint32_t bytesPerSecond);
+
+#endif /* POVSIM_H_ */
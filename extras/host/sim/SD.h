@@ -0,0 +1,46 @@
+/*
+ * SD.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: GFV
+ *
+ * The Teensy SD library's File and SD objects over regular host files, for TeensyPovContent. Paths are
+ * relative to the working directory. Reads take simulated time at the rate set by povSimSetSdRate().
+ */
+
+#ifndef SD_H_
+#define SD_H_
+
+#include <stdio.h>
+#include "Arduino.h"
+
+#define FILE_READ 0
+#define BUILTIN_SDCARD 254
+
+class File {
+private:
+	FILE *handle = nullptr;
+
+public:
+	File() {}
+	File(FILE *f) : handle(f) {}
+	operator bool() const { return handle != nullptr; }
+	int read(void *buffer, size_t length);
+	int read(void);
+	int available(void);
+	bool seek(uint32_t position);
+	uint32_t position(void);
+	uint32_t size(void);
+	void close(void);
+};
+
+class SDClass {
+public:
+	bool begin(uint8_t csPin = BUILTIN_SDCARD);
+	File open(const char *path, uint8_t mode = FILE_READ);
+	bool exists(const char *path);
+};
+
+extern SDClass SD;
+
+#endif /* SD_H_ */
@@ -16,6 +16,7 @@ struct pov_char {
 
 class textCharacters {
 	friend class TeensyPOV;
+	friend class TeensyPovMarquee;
 private:
 	static const pov_char font_numbers[];
 	static const pov_char font_uppercase[];